@@ -4,6 +4,9 @@
 #include "websocket_server.h"
 #include "udp_multicast_server.h"
 #include "zeromq_server.h"
+#include "track_store.h"
+#include "response_cache.h"
+#include "udp_feed.h"
 #include <memory>
 #include <string>
 #include <thread>
@@ -31,23 +34,48 @@ struct Coordinates {
           timestamp(std::chrono::system_clock::now().time_since_epoch().count()) {}
 };
 
+// 新连接的初始快照配置
+// 客户端连接后先收到所有活跃航迹（分块发送），随后切换为增量更新，按更新序号去重，不丢失也不重复
+struct SnapshotOptions {
+    bool enabled = true;
+    size_t chunk_tracks = 500;                          // 每块包含的航迹数
+    std::chrono::milliseconds chunk_interval{0};        // 块之间的最小间隔，0 表示上一块写出后立即发送下一块
+    std::chrono::milliseconds cache_max_age{1000};      // 序列化快照的复用时间，其间的更新由追赶步骤补发
+    std::chrono::milliseconds track_ttl{10000};         // 只包含该时间内更新过的航迹（与前端 entityTimeout 一致），0 表示全部
+};
+
 // 服务器配置结构
 struct ServerConfig {
     // HTTP服务器配置
     std::string http_address;
     unsigned short http_port;
     int http_threads;
+    KeepAliveOptions http_keep_alive;
+    uint64_t http_body_limit;
+    CompressionOptions http_compression;
+    std::string static_root;        // 前端构建输出目录（例如 ../dist），为空时不提供静态文件
     
     // WebSocket服务器配置
     std::string ws_address;
     unsigned short ws_port;
     int ws_threads;
+    WriteBatchOptions ws_write_batch;
+    BackpressureOptions ws_backpressure;
+    PermessageDeflateOptions ws_deflate;
+    SnapshotOptions ws_snapshot;
+
+    // HTTP 和 WebSocket 服务器的 I/O 线程模型
+    IoModelOptions io_model;
     
     // UDP组播服务器配置
     std::string udp_multicast_address;
     unsigned short udp_port;
     std::string udp_listen_address;
     size_t udp_buffer_size;
+    std::vector<UdpGroupJoin> udp_groups;       // 同时订阅的其他组播组（共用接收线程），端口为 0 时用 udp_port，接口为空时用 udp_listen_address
+    UdpReceiveOptions udp_receive;
+    UdpFeedOptions udp_feed;
+    UdpSendOptions udp_send;
     
     // ZeroMQ服务器配置
     std::string zmq_address;
@@ -63,6 +91,7 @@ struct ServerConfig {
     // 默认构造函数
     ServerConfig() 
         : http_address("127.0.0.1"), http_port(3000), http_threads(2),
+          http_body_limit(kDefaultBodyLimit),
           ws_address("127.0.0.1"), ws_port(3001), ws_threads(2),
           udp_multicast_address("239.255.0.1"), udp_port(5000),
           udp_listen_address("127.0.0.1"), udp_buffer_size(8192),
@@ -98,22 +127,50 @@ public:
     // 获取当前连接的客户端数量
     int getClientCount() const { return client_count_.load(); }
     
-    // 获取最新坐标
+    // 获取最新坐标（默认实体）
     Coordinates getLatestCoordinates() const;
     
-    // 更新坐标
+    // 更新坐标（默认实体）
     void updateCoordinates(const Coordinates& coords);
 
+    // 更新航迹并广播
+    void updateTrack(const Track& track, const char* source = nullptr);
+
+    // 批量更新航迹，并以一次合并广播发送给WebSocket客户端
+    void updateTracks(const std::vector<Track>& tracks, const char* source = nullptr);
+
+    // 获取指定实体的航迹
+    bool getTrack(const std::string& id, Track& track) const { return track_store_.get(id, track); }
+
+    // 获取航迹数量
+    size_t getTrackCount() const { return track_store_.size(); }
+
 private:
     // HTTP 请求处理器
     http::response<http::string_body> handleHttpRequest(
         const http::request<http::string_body>& req, 
         const std::string& path);
 
+    // 生成服务器状态响应体（GET /）
+    std::string buildStatusBody();
+
     // 处理坐标请求
     http::response<http::string_body> handleCoordinatesRequest(
         const http::request<http::string_body>& req);
 
+    // 处理航迹列表请求（GET /tracks）
+    http::response<http::string_body> handleTracksRequest(
+        const http::request<http::string_body>& req);
+
+    // 处理批量航迹写入请求（POST /tracks/batch）
+    http::response<http::string_body> handleTracksBatchRequest(
+        const http::request<http::string_body>& req);
+
+    // 处理单个航迹请求（GET /tracks/{id}）
+    http::response<http::string_body> handleTrackRequest(
+        const http::request<http::string_body>& req,
+        const std::string& id);
+
     // WebSocket 消息处理器
     void handleWebSocketMessage(
         const std::string& message,
@@ -123,11 +180,33 @@ private:
     void handleWebSocketConnection(
         const std::shared_ptr<WebSocketSession>& session,
         bool connected);
+
+    // 序列化的航迹快照（多个连接共享）
+    struct TrackSnapshot {
+        uint64_t base_seq = 0;                          // 遍历存储前读取的更新序号
+        size_t count = 0;                               // 航迹数
+        bool has_binary = false;                        // 是否包含二进制编码
+        std::vector<SharedMessage> json_chunks;
+        std::vector<SharedMessage> binary_chunks;
+        std::chrono::steady_clock::time_point built_at;
+    };
+
+    // 获取航迹快照：缓存未过期时复用，need_binary 时确保包含二进制编码
+    std::shared_ptr<const TrackSnapshot> getTrackSnapshot(bool need_binary);
+
+    // 向新连接发送快照并切换到增量更新
+    void sendTrackSnapshot(const std::shared_ptr<WebSocketSession>& session);
         
     // UDP 消息处理器
     void handleUdpMessage(
         const std::string& message,
         const udp::endpoint& sender);
+
+    // UDP 批量消息处理器
+    void handleUdpBatch(const UdpDatagram* datagrams, size_t count);
+
+    // UDP 周期处理器：交付等待超时的乱序帧
+    void expireUdpFeeds();
         
     // ZeroMQ 消息处理器
     void handleZmqMessage(
@@ -155,9 +234,24 @@ private:
     // ZeroMQ服务器
     std::unique_ptr<ZeroMQServer> zmq_server_;
 
-    // 最新坐标
-    Coordinates latest_coordinates_;
-    std::mutex coordinates_mutex_;
+    // 航迹存储（按实体ID分片）
+    TrackStore track_store_;
+
+    // 二进制 UDP 帧的按源序号处理（丢包、乱序、重复），每个组播数据源一个
+    std::vector<std::unique_ptr<UdpFeedDecoder>> udp_feeds_;
+
+    // 读接口的响应缓存：航迹版本号不变时直接返回上次序列化的响应体
+    ResponseCache coordinates_cache_;
+    ResponseCache tracks_cache_;
+    // 服务器状态包含队列统计等运行时数据，最多缓存 1 秒
+    ResponseCache status_cache_{std::chrono::seconds(1)};
+
+    // WebSocket 连接和断开的累计次数（服务器状态响应的版本号之一）
+    std::atomic<uint64_t> connection_events_{0};
+
+    // 新连接的航迹快照缓存（互斥锁同时保证并发连接时只构建一次）
+    std::shared_ptr<const TrackSnapshot> track_snapshot_;
+    std::mutex track_snapshot_mutex_;
 
     // 模拟数据线程
     std::thread simulation_thread_;
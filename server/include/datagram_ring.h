@@ -0,0 +1,70 @@
+#pragma once
+
+#include <boost/asio/ip/udp.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace cesium_server {
+
+// 有界多生产者/单消费者数据报环形队列
+//
+// 槽位和数据缓冲区在构造时一次分配，入队只复制字节，不分配内存，不加锁。
+// 每个槽位带一个序号（Vyukov 有界队列）：生产者用 CAS 抢占写位置，写完后发布序号；
+// 消费者按顺序认领已发布的槽位，处理完后再释放，因此处理期间可以直接引用槽位中的字节。
+// 队列满时 tryPush 返回 false，由调用方计数丢弃。
+class DatagramRing {
+public:
+    // capacity 向上取 2 的幂，slot_size 为单个数据报的最大字节数
+    DatagramRing(size_t capacity, size_t slot_size);
+
+    DatagramRing(const DatagramRing&) = delete;
+    DatagramRing& operator=(const DatagramRing&) = delete;
+
+    // 复制一个数据报入队（多个生产者可并发调用），队列满或数据报过大时返回 false；feed 随数据报原样取回
+    bool tryPush(const char* data, size_t size, const boost::asio::ip::udp::endpoint& sender, size_t feed = 0);
+
+    // 认领最多 max 个连续的已入队数据报（仅消费者线程调用），返回认领数
+    size_t claim(size_t max);
+
+    // 第 i 个已认领数据报的内容（release 之前有效）
+    const char* data(size_t i) const { return cells_[(head_ + i) & mask_].data; }
+    size_t size(size_t i) const { return cells_[(head_ + i) & mask_].size; }
+    const boost::asio::ip::udp::endpoint& sender(size_t i) const { return cells_[(head_ + i) & mask_].sender; }
+    size_t feed(size_t i) const { return cells_[(head_ + i) & mask_].feed; }
+
+    // 释放已认领的数据报，槽位重新可写
+    void release(size_t count);
+
+    // 队列是否为空（消费者视角）
+    bool empty() const;
+
+    // 当前排队数（近似值）
+    size_t size() const;
+
+    size_t capacity() const { return mask_ + 1; }
+    size_t slotSize() const { return slot_size_; }
+
+private:
+    // 独占缓存行，避免相邻槽位的生产者和消费者互相失效
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence{0};
+        size_t size = 0;
+        size_t feed = 0;
+        boost::asio::ip::udp::endpoint sender;
+        char* data = nullptr;
+    };
+
+    size_t mask_;
+    size_t slot_size_;
+    std::unique_ptr<Cell[]> cells_;
+    std::vector<char> buffer_;
+
+    alignas(64) std::atomic<size_t> tail_;     // 生产者的下一个写位置
+    alignas(64) size_t head_;                  // 消费者的下一个读位置（仅消费者访问）
+    std::atomic<size_t> head_published_;       // 已释放的位置，供 size() 读取
+};
+
+} // namespace cesium_server
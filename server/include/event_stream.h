@@ -0,0 +1,77 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "shared_message.h"
+
+namespace cesium_server {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+class EventStreamSubscriber;
+
+// 事件流（Server-Sent Events）配置
+struct EventStreamOptions {
+    size_t max_queue_messages = 1024;           // 每个订阅者最多积压的事件数，超出时丢弃最旧的事件
+    size_t max_batch_messages = 256;            // 一次写操作最多合并的事件数
+    std::chrono::seconds heartbeat{15};         // 没有事件时发送注释行的间隔，防止代理断开空闲连接
+    std::chrono::seconds write_timeout{30};     // 单次写操作超时，超时的订阅者被断开
+};
+
+// 事件流统计
+struct EventStreamStats {
+    size_t subscribers = 0;     // 当前订阅者数量
+    uint64_t published = 0;     // 已发布的事件数
+    uint64_t dropped = 0;       // 因订阅者积压被丢弃的事件数
+};
+
+// 事件流中心：接管 HTTP 连接并以 text/event-stream 推送事件
+// HTTP/1.1 连接使用分块传输编码，HTTP/1.0 连接直接写出事件并在结束时关闭连接。
+// 发布的事件是共享缓冲区，各订阅者的队列只持有引用；每次写操作把积压的多个事件合并为一个分块。
+class EventStreamHub : public std::enable_shared_from_this<EventStreamHub> {
+public:
+    explicit EventStreamHub(const EventStreamOptions& options = EventStreamOptions());
+    ~EventStreamHub();
+
+    // 接管连接并开始推送，version 为订阅请求的 HTTP 版本
+    void subscribe(beast::tcp_stream&& stream, unsigned version);
+
+    // 发布事件（data 为单行文本，例如 JSON）
+    void publish(const SharedMessage& data);
+
+    // 关闭所有订阅者
+    void closeAll();
+
+    // 获取订阅者数量
+    size_t size() const { return subscriber_count_.load(std::memory_order_relaxed); }
+
+    // 获取统计
+    EventStreamStats getStats() const;
+
+private:
+    friend class EventStreamSubscriber;
+
+    // 订阅者断开时移除
+    void remove(uint64_t id);
+
+    EventStreamOptions options_;
+
+    std::unordered_map<uint64_t, std::shared_ptr<EventStreamSubscriber>> subscribers_;
+    mutable std::mutex mutex_;
+    std::atomic<size_t> subscriber_count_{0};
+    std::atomic<uint64_t> next_id_{1};
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace cesium_server
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cesium_server {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+// HTTP 响应压缩配置
+struct CompressionOptions {
+    bool enabled = true;
+    size_t min_size = 1024;     // 小于该字节数的响应体不压缩（压缩收益抵不过 CPU 开销）
+    int level = 6;              // 压缩级别 1-9
+};
+
+// 内容编码
+enum class ContentCoding {
+    Identity,
+    Gzip,
+    Deflate     // zlib 格式（RFC 1950），即 HTTP 的 "deflate"
+};
+
+// 客户端是否接受指定的内容编码（q=0 表示明确拒绝）
+bool acceptsEncoding(beast::string_view accept_encoding, beast::string_view coding);
+
+// 按 Accept-Encoding 选择编码，gzip 优先
+ContentCoding negotiateCoding(beast::string_view accept_encoding);
+
+// 内容类型是否值得压缩（文本、JSON、JavaScript、XML、SVG）
+bool isCompressibleType(beast::string_view content_type);
+
+// 压缩数据到 out（覆盖原内容），使用线程局部的压缩上下文，重复调用不重新分配内部缓冲区
+void compress(ContentCoding coding, int level, const char* data, size_t size, std::string& out);
+
+// 按请求的 Accept-Encoding 压缩响应体，返回 true 表示已压缩
+// 已有 Content-Encoding、状态码不带响应体、类型不可压缩或小于阈值时不压缩
+bool compressResponse(const http::request<http::string_body>& req,
+                      http::response<http::string_body>& res,
+                      const CompressionOptions& options);
+
+// CRC-32（gzip 尾部）
+uint32_t crc32(uint32_t crc, const unsigned char* data, size_t size);
+
+// Adler-32（zlib 尾部）
+uint32_t adler32(uint32_t adler, const unsigned char* data, size_t size);
+
+} // namespace cesium_server
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <boost/beast/http.hpp>
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cesium_server {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+// 路径参数（指向请求路径和路由模式的视图，匹配过程不分配内存）
+class RouteParams {
+public:
+    static constexpr size_t kMaxParams = 8;
+
+    // 获取参数值，不存在时返回空
+    std::string_view get(std::string_view name) const {
+        for (size_t i = 0; i < count_; ++i) {
+            if (items_[i].first == name) {
+                return items_[i].second;
+            }
+        }
+        return std::string_view();
+    }
+
+    // 获取去掉查询串后的请求路径
+    std::string_view path() const { return path_; }
+
+    // 获取参数数量
+    size_t size() const { return count_; }
+
+private:
+    friend class HttpRouter;
+
+    std::array<std::pair<std::string_view, std::string_view>, kMaxParams> items_;
+    size_t count_ = 0;
+    std::string_view path_;
+};
+
+// 路由处理器类型
+using RouteHandler = std::function<http::response<http::string_body>(
+    const http::request<http::string_body>&,
+    const RouteParams&)>;
+
+// 基数树路由器
+// 路由模式由静态片段、参数 {name}（匹配一个路径段）和通配符 *、{name*}（匹配剩余路径，只能位于末尾）组成，
+// 例如 "/tracks/{id}"、"/static/*"。每个节点按 HTTP 方法保存处理器。
+// 匹配优先级：静态片段 > 参数 > 通配符。路由须在服务器启动前注册，匹配过程只读、无锁。
+class HttpRouter {
+public:
+    HttpRouter();
+    ~HttpRouter();
+
+    // 注册路由；method 为 http::verb::unknown 时匹配任意方法
+    // 模式非法或参数名冲突时抛出 std::invalid_argument
+    void add(http::verb method, std::string_view pattern, RouteHandler handler);
+
+    // 匹配路由
+    // 返回处理器指针；路径存在但方法不匹配时返回 nullptr 并把 allow 指向允许的方法列表
+    const RouteHandler* match(http::verb method, std::string_view path,
+                              RouteParams& params, const std::string** allow) const;
+
+    // 获取已注册的路由数量
+    size_t size() const { return route_count_; }
+
+private:
+    struct Node;
+
+    static const RouteHandler* acceptNode(const Node* node, size_t slot, const Node** path_match);
+    static const RouteHandler* matchNode(const Node* node, std::string_view path, size_t slot,
+                                         RouteParams& params, const Node** path_match);
+
+    std::unique_ptr<Node> root_;
+    size_t route_count_ = 0;
+};
+
+} // namespace cesium_server
@@ -5,14 +5,21 @@
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
 #include <boost/config.hpp>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <memory>
-#include <map>
 #include <string>
 #include <thread>
+#include <variant>
 #include <vector>
 #include "thread_pool.h"
+#include "http_router.h"
+#include "event_stream.h"
+#include "static_files.h"
+#include "http_compression.h"
+#include "io_context_pool.h"
 
 namespace cesium_server {
 
@@ -26,10 +33,25 @@ using HttpRequestHandler = std::function<http::response<http::string_body>(
     const http::request<http::string_body>&, 
     const std::string&)>;
 
+// 会话写出的响应：路由处理器生成的响应或静态文件响应
+using SessionResponse = std::variant<http::response<http::string_body>, FileResponse>;
+
+// 持久连接配置
+struct KeepAliveOptions {
+    std::chrono::seconds idle_timeout{60};  // 两个请求之间的最长空闲时间（从上一个响应写完开始计算）
+    std::chrono::seconds write_timeout{30}; // 写出一个响应的最长时间（静态文件为每一段）
+    size_t max_requests = 1000;             // 单个连接处理的最大请求数（0 表示不限）
+    size_t pipeline_limit = 8;              // 已处理未写出的最大响应数，达到后暂停读取
+};
+
+// 默认请求体上限（批量写入接口一次可能提交数千条航迹）
+constexpr uint64_t kDefaultBodyLimit = 16 * 1024 * 1024;
+
 // HTTP 服务器类
 class HttpServer {
 public:
-    HttpServer(const std::string& address, unsigned short port, int threads = 1);
+    HttpServer(const std::string& address, unsigned short port, int threads = 1,
+               const IoModelOptions& io_model = IoModelOptions());
     ~HttpServer();
 
     // 启动服务器
@@ -38,18 +60,50 @@ public:
     // 停止服务器
     void stop();
 
-    // 注册路由处理器
+    // 注册路由处理器（精确匹配路径，接受任意方法）
     void registerHandler(const std::string& path, HttpRequestHandler handler);
 
+    // 按方法注册路由，pattern 支持 {name} 参数和末尾通配符（见 HttpRouter）
+    void addRoute(http::verb method, const std::string& pattern, RouteHandler handler);
+
+    // 设置持久连接配置（对之后建立的连接生效）
+    void setKeepAliveOptions(const KeepAliveOptions& options) { keep_alive_ = options; }
+
+    // 设置请求体大小上限，超出时返回 413（对之后建立的连接生效）
+    void setBodyLimit(uint64_t limit) { body_limit_ = limit; }
+
+    // 设置响应压缩配置：按 Accept-Encoding 对路由返回的文本/JSON 响应做 gzip/deflate 压缩
+    void setCompressionOptions(const CompressionOptions& options) { compression_ = options; }
+
+    // 注册事件流路径：GET 该路径的连接保持打开，以 text/event-stream 接收 publishEvent 发布的事件
+    // 须在服务器启动前调用
+    void addEventStream(const std::string& path, const EventStreamOptions& options = EventStreamOptions());
+
+    // 向所有事件流订阅者发布事件（共享缓冲区，不复制）
+    void publishEvent(const SharedMessage& data);
+
+    // 获取事件流订阅者数量
+    size_t getEventStreamCount() const { return event_hub_ ? event_hub_->size() : 0; }
+
+    // 获取事件流统计
+    EventStreamStats getEventStreamStats() const;
+
+    // 启用静态文件服务：未匹配路由的 GET/HEAD 请求从 options.root 目录提供文件
+    // 浏览器访问根路径（Accept 含 text/html）时返回目录中的 index 文件
+    void setStaticFiles(const StaticFileOptions& options);
+
 private:
-    // 接受新连接
-    void doAccept();
+    // 接受新连接；pinned_context 非空时连接固定在该 io_context 上
+    void doAccept(tcp::acceptor& acceptor, net::io_context* pinned_context);
+
+    // 选择新连接所在的执行器
+    net::any_io_executor sessionExecutor(net::io_context* pinned_context);
 
     // 处理请求
     void handleRequest(tcp::socket socket);
 
-    // 查找路由处理器
-    HttpRequestHandler findHandler(const std::string& path);
+    // 按路由分发请求，未匹配的 GET/HEAD 请求交给静态文件处理器
+    SessionResponse dispatch(const http::request<http::string_body>& req);
 
     // 服务器地址和端口
     std::string address_;
@@ -61,8 +115,29 @@ private:
     tcp::acceptor acceptor_;
     std::unique_ptr<ThreadPool> thread_pool_;
 
+    // 每线程一个 io_context 的模型
+    IoModelOptions io_model_;
+    std::unique_ptr<IoContextPool> io_pool_;
+    std::vector<std::unique_ptr<tcp::acceptor>> reuse_port_acceptors_;
+
+    // 持久连接配置
+    KeepAliveOptions keep_alive_;
+
+    // 请求体大小上限
+    uint64_t body_limit_ = kDefaultBodyLimit;
+
+    // 响应压缩配置
+    CompressionOptions compression_;
+
+    // 事件流
+    std::shared_ptr<EventStreamHub> event_hub_;
+    std::string event_stream_path_;
+
+    // 静态文件
+    std::unique_ptr<StaticFileHandler> static_files_;
+
     // 路由表
-    std::map<std::string, HttpRequestHandler> handlers_;
+    HttpRouter router_;
 
     // 服务器状态
     bool running_;
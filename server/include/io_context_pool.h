@@ -0,0 +1,68 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "thread_pool.h"
+
+namespace cesium_server {
+
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+// I/O 线程模型
+enum class IoModel {
+    Shared,         // 所有线程共同运行一个 io_context，会话通过 strand 串行化
+    PerThread       // 每个线程运行自己的 io_context，会话固定在一个线程上
+};
+
+// PerThread 模式下新连接的分配方式
+enum class AcceptMode {
+    RoundRobin,     // 单个接收器，按轮询把连接分配给各 io_context
+    ReusePort       // 每个 io_context 一个 SO_REUSEPORT 接收器，由内核分发连接
+};
+
+// I/O 模型配置
+struct IoModelOptions {
+    IoModel model = IoModel::Shared;
+    AcceptMode accept_mode = AcceptMode::RoundRobin;
+};
+
+// io_context 池：每个 io_context 由一个线程运行
+class IoContextPool {
+public:
+    explicit IoContextPool(size_t pool_size);
+    ~IoContextPool();
+
+    // 启动所有 io_context
+    void run();
+
+    // 停止所有 io_context 并等待线程退出
+    void stop();
+
+    // 按轮询获取下一个 io_context
+    net::io_context& getNextIoContext();
+
+    // 获取指定的 io_context
+    net::io_context& getIoContext(size_t index);
+
+    // 获取 io_context 数量
+    size_t size() const { return contexts_.size(); }
+
+private:
+    using WorkGuard = net::executor_work_guard<net::io_context::executor_type>;
+
+    std::vector<std::unique_ptr<net::io_context>> contexts_;
+    std::vector<WorkGuard> work_guards_;
+    std::atomic<size_t> next_context_{0};
+    std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+// 当前平台是否支持 SO_REUSEPORT 分发连接
+bool isReusePortSupported();
+
+// 打开、绑定并监听接收器，失败时输出错误并返回 false
+bool openAcceptor(tcp::acceptor& acceptor, const tcp::endpoint& endpoint, bool reuse_port);
+
+} // namespace cesium_server
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <boost/beast/core/string.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace cesium_server {
+
+// 缓存的响应体
+struct CachedBody {
+    uint64_t version = 0;
+    std::string body;
+    std::string etag;       // 强校验 ETag（含引号）
+    std::chrono::steady_clock::time_point built_at;
+};
+
+// 按版本缓存的响应体
+// 数据版本号（例如 TrackStore::generation()）不变时直接返回上次序列化的结果；
+// max_age 非零时，即使版本未变，缓存超过该时长也会重新生成（用于包含运行时统计的响应）。
+class ResponseCache {
+public:
+    explicit ResponseCache(std::chrono::milliseconds max_age = std::chrono::milliseconds(0))
+        : max_age_(max_age) {}
+
+    // 获取 version 对应的响应体，缓存失效时调用 build() 生成新的响应体
+    // build 在锁外执行，并发未命中时可能重复生成，以较新的版本为准
+    template <typename Build>
+    std::shared_ptr<const CachedBody> get(uint64_t version, Build&& build) {
+        auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (entry_ && entry_->version == version &&
+                (max_age_.count() == 0 || now - entry_->built_at < max_age_)) {
+                return entry_;
+            }
+        }
+
+        auto entry = std::make_shared<CachedBody>();
+        entry->version = version;
+        entry->body = build();
+        entry->etag = makeETag(version, now);
+        entry->built_at = now;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!entry_ || entry_->version <= version) {
+            entry_ = entry;
+        }
+        return entry;
+    }
+
+    // 清空缓存
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entry_.reset();
+    }
+
+private:
+    // 生成 ETag：进程启动标识 + 版本号（+ 生成时间，用于 max_age 缓存）
+    std::string makeETag(uint64_t version, std::chrono::steady_clock::time_point now) const;
+
+    std::chrono::milliseconds max_age_;
+    std::shared_ptr<const CachedBody> entry_;
+    std::mutex mutex_;
+};
+
+// If-None-Match 是否与 ETag 匹配（支持逗号分隔的列表、弱校验前缀 W/ 和 *）
+bool etagMatches(boost::beast::string_view if_none_match, const std::string& etag);
+
+} // namespace cesium_server
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace cesium_server {
+
+// 共享的只读消息缓冲区：广播时只序列化一次，所有会话的写队列引用同一份数据
+// WebSocket 广播和 HTTP 事件流推送使用同一份缓冲区
+using SharedMessage = std::shared_ptr<const std::string>;
+
+} // namespace cesium_server
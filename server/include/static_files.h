@@ -0,0 +1,85 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace cesium_server {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+
+// 静态文件服务配置
+struct StaticFileOptions {
+    std::string root;                                   // 根目录（例如前端构建输出的 dist/）
+    std::string index = "index.html";                   // 目录默认文件
+    bool spa_fallback = true;                           // 不存在且不带扩展名的路径返回 index（前端路由）
+    std::chrono::milliseconds metadata_ttl{2000};       // 文件元数据缓存有效期，0 表示不过期
+    size_t max_cached_entries = 8192;                   // 元数据缓存的最大条目数
+    std::string immutable_prefix = "/assets/";          // 带哈希文件名的构建产物，允许客户端长期缓存
+};
+
+// 静态文件响应：头部与文件区间分开保存，文件内容由 sendFileResponse 直接从文件写到套接字
+struct FileResponse {
+    http::response<http::empty_body> header;    // 状态行和头部，Content-Length 为发送的字节数
+    std::string path;                           // 要发送的文件，为空表示只发送头部（HEAD、304、416）
+    uint64_t offset = 0;                        // 文件内偏移
+    uint64_t length = 0;                        // 发送的字节数
+};
+
+// 静态文件处理器
+// 支持 ETag/If-None-Match、单区间 Range 请求（206/416）、预压缩的 .br/.gz 文件（按 Accept-Encoding 选择）。
+// 文件元数据（大小、修改时间、预压缩版本）缓存在内存中，过期后重新 stat。
+class StaticFileHandler {
+public:
+    explicit StaticFileHandler(const StaticFileOptions& options);
+
+    // 处理 GET/HEAD 请求，找到文件时填充 res 并返回 true
+    bool serve(const http::request<http::string_body>& req, FileResponse& res);
+
+    // 获取根目录
+    const std::string& root() const { return options_.root; }
+
+private:
+    // 一个文件（及其预压缩版本）的元数据
+    struct FileInfo {
+        bool exists = false;
+        uint64_t size = 0;
+        std::string etag;
+        const char* content_type = "application/octet-stream";
+        int64_t br_size = -1;       // .br 文件大小，-1 表示不存在
+        int64_t gz_size = -1;       // .gz 文件大小，-1 表示不存在
+        std::string br_etag;
+        std::string gz_etag;
+        std::chrono::steady_clock::time_point checked_at;
+    };
+
+    // 获取文件元数据（带缓存）
+    std::shared_ptr<const FileInfo> lookup(const std::string& relative_path);
+
+    // 读取文件元数据
+    std::shared_ptr<FileInfo> stat(const std::string& relative_path) const;
+
+    StaticFileOptions options_;
+
+    // 相对路径 -> 元数据
+    std::unordered_map<std::string, std::shared_ptr<const FileInfo>> cache_;
+    std::mutex cache_mutex_;
+};
+
+// 写出静态文件响应（头部后跟文件区间），完成后调用 handler
+// Linux 上使用 sendfile 把文件内容直接从页缓存发送到套接字，其他平台分块读取后写出
+// 头部和每一段的写出各有 timeout 的期限，超时关闭连接并以 beast::error::timeout 完成
+void sendFileResponse(beast::tcp_stream& stream, FileResponse& res,
+                      std::chrono::steady_clock::duration timeout,
+                      std::function<void(beast::error_code)> handler);
+
+} // namespace cesium_server
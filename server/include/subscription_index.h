@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace cesium_server {
+
+// 经纬度范围（单位：度）
+// west > east 表示范围跨越 180° 经线
+struct GeoBounds {
+    double west = -180.0;
+    double south = -90.0;
+    double east = 180.0;
+    double north = 90.0;
+
+    // 判断点是否在范围内
+    bool contains(double longitude, double latitude) const {
+        if (latitude < south || latitude > north) {
+            return false;
+        }
+        if (west <= east) {
+            return longitude >= west && longitude <= east;
+        }
+        return longitude >= west || longitude <= east;
+    }
+};
+
+// 视域订阅空间索引
+// 将地球按固定大小的经纬网格划分，每个网格记录视域与之相交的会话，
+// 查询时只需检查点所在网格中的少量候选会话。
+class SubscriptionIndex {
+public:
+    explicit SubscriptionIndex(double cell_size_degrees = 10.0);
+
+    // 设置（或替换）会话的订阅范围
+    void subscribe(uint64_t session_id, const GeoBounds& bounds);
+
+    // 取消会话的订阅
+    void unsubscribe(uint64_t session_id);
+
+    // 查询视域包含该点的会话，结果追加到 out
+    void query(double longitude, double latitude, std::vector<uint64_t>& out) const;
+
+    // 获取订阅数量
+    size_t size() const;
+
+private:
+    // 计算经纬度所在的网格行列
+    int columnOf(double longitude) const;
+    int rowOf(double latitude) const;
+
+    // 遍历范围覆盖的网格（调用方持有写锁）
+    template <typename Fn>
+    void forEachCell(const GeoBounds& bounds, Fn&& fn);
+
+    // 从网格中移除会话（调用方持有写锁）
+    void removeFromCells(uint64_t session_id, const GeoBounds& bounds);
+
+    double cell_size_;
+    int columns_;
+    int rows_;
+
+    // 网格 -> 会话ID列表
+    std::vector<std::vector<uint64_t>> cells_;
+
+    // 会话ID -> 订阅范围
+    std::unordered_map<uint64_t, GeoBounds> bounds_;
+
+    mutable std::shared_mutex mutex_;
+};
+
+} // namespace cesium_server
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <vector>
-#include <queue>
+#include <deque>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -10,120 +10,282 @@
 #include <memory>
 #include <atomic>
 #include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <new>
+#include <tuple>
+#include <type_traits>
 
 namespace cesium_server {
 
+// 只可移动的任务包装
+// 小对象直接存放在内部缓冲区中，避免 std::function 的堆分配和可复制要求
+class PoolTask {
+public:
+    PoolTask() noexcept = default;
+
+    template<class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, PoolTask>>>
+    PoolTask(F&& f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (sizeof(Fn) <= kInlineSize &&
+                      alignof(Fn) <= alignof(std::max_align_t) &&
+                      std::is_nothrow_move_constructible_v<Fn>) {
+            new (&storage_) Fn(std::forward<F>(f));
+            ops_ = &inlineOps<Fn>;
+        } else {
+            *reinterpret_cast<Fn**>(&storage_) = new Fn(std::forward<F>(f));
+            ops_ = &heapOps<Fn>;
+        }
+    }
+
+    PoolTask(PoolTask&& other) noexcept {
+        moveFrom(other);
+    }
+
+    PoolTask& operator=(PoolTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    PoolTask(const PoolTask&) = delete;
+    PoolTask& operator=(const PoolTask&) = delete;
+
+    ~PoolTask() {
+        reset();
+    }
+
+    explicit operator bool() const noexcept {
+        return ops_ != nullptr;
+    }
+
+    void operator()() {
+        ops_->invoke(&storage_);
+    }
+
+private:
+    static constexpr size_t kInlineSize = 56;
+
+    struct Ops {
+        void (*invoke)(void*);
+        void (*relocate)(void* src, void* dst) noexcept;   // 移动到 dst 并析构 src
+        void (*destroy)(void*) noexcept;
+    };
+
+    template<class Fn>
+    static constexpr Ops inlineOps = {
+        [](void* p) { (*static_cast<Fn*>(p))(); },
+        [](void* src, void* dst) noexcept {
+            new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* p) noexcept { static_cast<Fn*>(p)->~Fn(); }
+    };
+
+    template<class Fn>
+    static constexpr Ops heapOps = {
+        [](void* p) { (**static_cast<Fn**>(p))(); },
+        [](void* src, void* dst) noexcept {
+            *static_cast<Fn**>(dst) = *static_cast<Fn**>(src);
+        },
+        [](void* p) noexcept { delete *static_cast<Fn**>(p); }
+    };
+
+    void moveFrom(PoolTask& other) noexcept {
+        ops_ = other.ops_;
+        if (ops_) {
+            ops_->relocate(&other.storage_, &storage_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    void reset() noexcept {
+        if (ops_) {
+            ops_->destroy(&storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    const Ops* ops_ = nullptr;
+};
+
+// 自适应线程数配置
+// 控制线程按 interval 统计任务在队列中的平均等待时间：
+// 超过 high_watermark 时按当前线程数的一半扩容；连续 shrink_after_intervals 个周期
+// 低于 low_watermark 且有空闲线程时减少一个线程。
+struct AdaptivePoolOptions {
+    bool enabled = false;
+    size_t min_threads = 1;
+    size_t max_threads = 0;                                 // 0 表示线程池容量上限
+    std::chrono::microseconds low_watermark{1000};
+    std::chrono::microseconds high_watermark{10000};
+    std::chrono::milliseconds interval{500};
+    size_t shrink_after_intervals = 6;
+};
+
+// 线程池状态快照
+struct ThreadPoolStats {
+    size_t threads = 0;                 // 工作线程数
+    size_t target_threads = 0;          // 目标线程数（缩容时工作线程在任务间隙退出）
+    size_t idle_threads = 0;            // 空闲等待中的线程数
+    size_t active_tasks = 0;            // 正在执行的任务数
+    size_t queued_tasks = 0;            // 等待中的任务数
+    uint64_t completed_tasks = 0;       // 已开始执行的任务总数
+    double avg_queue_wait_ms = 0.0;     // 全部任务的平均排队时间
+    double recent_queue_wait_ms = 0.0;  // 最近一个统计周期的平均排队时间（自适应模式）
+    uint64_t grow_events = 0;           // 自适应控制的扩容次数
+    uint64_t shrink_events = 0;         // 自适应控制的缩容次数
+};
+
+// 工作窃取线程池
+// 每个工作线程有自己的双端队列：工作线程内部提交的任务压入自己队列的尾部并按 LIFO 执行，
+// 外部线程提交的任务进入全局队列；本地队列为空时先取全局队列，再从其他线程队列的头部窃取。
+// 线程数可以增加也可以减少：缩容时多余的工作线程在两个任务之间退出，
+// 其本地队列中剩余的任务转移到全局队列。
 class ThreadPool {
 public:
-    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency())
-        : stop_(false), active_tasks_(0) {
-        for(size_t i = 0; i < threads; ++i) {
-            workers_.emplace_back([this] {
-                while(true) {
-                    std::function<void()> task;
-                    {
-                        std::unique_lock<std::mutex> lock(queue_mutex_);
-                        condition_.wait(lock, [this] {
-                            return stop_ || !tasks_.empty();
-                        });
-
-                        if(stop_ && tasks_.empty()) {
-                            return;
-                        }
-
-                        task = std::move(tasks_.front());
-                        tasks_.pop();
-                    }
-
-                    ++active_tasks_;
-                    task();
-                    --active_tasks_;
-                }
-            });
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency(), size_t max_threads = 0)
+        : stop_(false), task_counts_(0), idle_workers_(0), live_threads_(0), target_threads_(0),
+          slot_limit_(0), completed_tasks_(0), total_wait_ns_(0), recent_wait_ns_(0),
+          grow_events_(0), shrink_events_(0) {
+        threads = std::max<size_t>(threads, 1);
+        // 未指定上限时为 resize 预留余量；本地队列预先分配，窃取时无需加锁访问队列数组
+        if (max_threads == 0) {
+            max_threads = std::max<size_t>(threads, std::thread::hardware_concurrency()) * 4;
         }
+        capacity_ = std::max(threads, max_threads);
+        queues_ = std::make_unique<WorkerQueue[]>(capacity_);
+        workers_.resize(capacity_);
+
+        resize(threads);
     }
 
+    // 提交任务并返回 future
     template<class F, class... Args>
-    auto enqueue(F&& f, Args&&... args) 
+    auto enqueue(F&& f, Args&&... args)
         -> std::future<typename std::invoke_result<F, Args...>::type> {
         using return_type = typename std::invoke_result<F, Args...>::type;
 
-        auto task = std::make_shared<std::packaged_task<return_type()>>(
+        std::packaged_task<return_type()> task(
             [f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
-                return std::apply(std::forward<F>(f), std::move(args));
+                return std::apply(std::move(f), std::move(args));
             }
         );
 
-        std::future<return_type> res = task->get_future();
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            if(stop_) {
-                throw std::runtime_error("enqueue on stopped ThreadPool");
-            }
-
-            tasks_.emplace([task]() { (*task)(); });
-        }
-        condition_.notify_one();
+        std::future<return_type> res = task.get_future();
+        push(PoolTask(std::move(task)));
         return res;
     }
 
+    // 提交无需返回值的任务（不创建 future）
+    template<class F>
+    void post(F&& f) {
+        push(PoolTask(std::forward<F>(f)));
+    }
+
     // 获取当前活跃任务数
     size_t getActiveTaskCount() const {
-        return active_tasks_.load();
+        return static_cast<size_t>(task_counts_.load() >> kActiveShift);
     }
 
     // 获取等待队列中的任务数
     size_t getQueuedTaskCount() const {
-        //std::unique_lock<std::mutex> lock(queue_mutex_);
-        return tasks_.size();
+        return static_cast<size_t>(task_counts_.load() & kQueuedMask);
+    }
+
+    // 获取工作线程数
+    size_t getThreadCount() const {
+        return live_threads_.load();
     }
 
-    // 调整线程池大小
+    // 获取状态快照（排队数与活跃数来自同一次原子读取，任务不会被重复计数或漏计）
+    ThreadPoolStats getStats() const {
+        ThreadPoolStats stats;
+        uint64_t counts = task_counts_.load();
+        stats.active_tasks = static_cast<size_t>(counts >> kActiveShift);
+        stats.queued_tasks = static_cast<size_t>(counts & kQueuedMask);
+        stats.threads = live_threads_.load();
+        stats.target_threads = target_threads_.load();
+        stats.idle_threads = idle_workers_.load();
+        stats.completed_tasks = completed_tasks_.load();
+        if (stats.completed_tasks > 0) {
+            stats.avg_queue_wait_ms = total_wait_ns_.load() / 1e6 / stats.completed_tasks;
+        }
+        stats.recent_queue_wait_ms = recent_wait_ns_.load() / 1e6;
+        stats.grow_events = grow_events_.load();
+        stats.shrink_events = shrink_events_.load();
+        return stats;
+    }
+
+    // 调整线程池大小（可增可减）
+    // 缩容时正在执行任务的线程在任务结束后退出；长期阻塞的任务（如 io_context::run）不会被打断
     void resize(size_t threads) {
         if (threads == 0) return;
 
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        size_t current_size = workers_.size();
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        if (stop_) return;
+        if (threads > capacity_) {
+            std::cerr << "ThreadPool resize to " << threads << " exceeds capacity "
+                      << capacity_ << ", clamped" << std::endl;
+            threads = capacity_;
+        }
 
-        if (threads > current_size) {
+        target_threads_.store(threads);
+        size_t live = live_threads_.load();
+        if (threads > live) {
             // 增加线程
-            workers_.reserve(threads);
-            for (size_t i = current_size; i < threads; ++i) {
-                workers_.emplace_back([this] {
-                    while(true) {
-                        std::function<void()> task;
-                        {
-                            std::unique_lock<std::mutex> lock(queue_mutex_);
-                            condition_.wait(lock, [this] {
-                                return stop_ || !tasks_.empty();
-                            });
-
-                            if(stop_ && tasks_.empty()) {
-                                return;
-                            }
-
-                            task = std::move(tasks_.front());
-                            tasks_.pop();
-                        }
-
-                        ++active_tasks_;
-                        task();
-                        --active_tasks_;
-                    }
-                });
+            for (size_t i = live; i < threads; ++i) {
+                startWorker();
             }
+        } else if (threads < live) {
+            // 唤醒空闲线程，让多余的线程退出
+            wakeAll();
+        }
+    }
+
+    // 设置自适应线程数（enabled 为 false 时停止调整，保持当前线程数）
+    void setAdaptive(const AdaptivePoolOptions& options) {
+        stopController();
+
+        AdaptivePoolOptions adjusted = options;
+        if (adjusted.max_threads == 0 || adjusted.max_threads > capacity_) {
+            adjusted.max_threads = capacity_;
+        }
+        adjusted.min_threads = std::clamp<size_t>(adjusted.min_threads, 1, adjusted.max_threads);
+        adaptive_options_ = adjusted;
+
+        if (adjusted.enabled) {
+            size_t target = std::clamp(target_threads_.load(), adjusted.min_threads, adjusted.max_threads);
+            resize(target);
+
+            std::lock_guard<std::mutex> lock(controller_mutex_);
+            controller_stop_ = false;
+            controller_ = std::thread([this] { controllerLoop(); });
         }
-        // 注意：目前不支持减少线程数，因为这需要更复杂的线程管理机制
     }
 
     ~ThreadPool() {
+        stopController();
+
         {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
+            std::lock_guard<std::mutex> lock(global_queue_.mutex);
             stop_ = true;
         }
+        wakeAll();
 
-        condition_.notify_all();
-        for(std::thread &worker: workers_) {
+        // 在锁外等待线程退出，退出中的线程可能需要获取 workers_mutex_
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(workers_mutex_);
+            workers.swap(workers_);
+        }
+        for(std::thread &worker: workers) {
             if(worker.joinable()) {
                 worker.join();
             }
@@ -131,12 +293,284 @@ public:
     }
 
 private:
-    std::vector<std::thread> workers_;              // 工作线程容器
-    std::queue<std::function<void()>> tasks_;       // 任务队列
-    std::mutex queue_mutex_;                        // 队列互斥锁
-    std::condition_variable condition_;             // 条件变量
+    using Clock = std::chrono::steady_clock;
+
+    // task_counts_ 低 32 位为排队数，高 32 位为活跃数
+    static constexpr unsigned kActiveShift = 32;
+    static constexpr uint64_t kQueuedMask = (uint64_t(1) << kActiveShift) - 1;
+    static constexpr uint64_t kOneActive = uint64_t(1) << kActiveShift;
+
+    // 排队中的任务及入队时间
+    struct QueuedTask {
+        PoolTask task;
+        Clock::time_point enqueued;
+    };
+
+    // 任务队列（按缓存行对齐，避免相邻队列的伪共享）
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<QueuedTask> tasks;
+        std::atomic<bool> in_use{false};
+    };
+
+    // 在空闲槽位上启动一个工作线程（调用方持有 workers_mutex_）
+    void startWorker() {
+        for (size_t slot = 0; slot < capacity_; ++slot) {
+            if (queues_[slot].in_use.load()) {
+                continue;
+            }
+            // 回收该槽位上已退出的线程
+            if (workers_[slot].joinable()) {
+                workers_[slot].join();
+            }
+            queues_[slot].in_use.store(true);
+            if (slot >= slot_limit_.load()) {
+                slot_limit_.store(slot + 1);
+            }
+            ++live_threads_;
+            workers_[slot] = std::thread([this, slot] { workerLoop(slot); });
+            return;
+        }
+    }
+
+    // 唤醒所有空闲线程
+    void wakeAll() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        sleep_condition_.notify_all();
+    }
+
+    // 提交任务：工作线程提交到自己的队列，其他线程提交到全局队列
+    void push(PoolTask task) {
+        QueuedTask item{std::move(task), Clock::now()};
+        if (current_pool_ == this) {
+            WorkerQueue& queue = queues_[current_index_];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(item));
+            task_counts_.fetch_add(1);
+        } else {
+            std::lock_guard<std::mutex> lock(global_queue_.mutex);
+            if(stop_) {
+                throw std::runtime_error("enqueue on stopped ThreadPool");
+            }
+            global_queue_.tasks.push_back(std::move(item));
+            task_counts_.fetch_add(1);
+        }
+
+        // 有空闲线程时唤醒一个
+        if (idle_workers_.load() > 0) {
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+            }
+            sleep_condition_.notify_one();
+        }
+    }
+
+    // 从队列取出任务：from_back 为 true 时取尾部（本地 LIFO），否则取头部
+    // 取出的同时把任务从排队计数转为活跃计数
+    bool tryTake(WorkerQueue& queue, QueuedTask& item, bool from_back) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        if (from_back) {
+            item = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            item = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        task_counts_.fetch_add(kOneActive - 1);
+        return true;
+    }
+
+    // 按本地队列、全局队列、窃取的顺序获取任务
+    bool tryPop(size_t index, QueuedTask& item) {
+        if (tryTake(queues_[index], item, true)) {
+            return true;
+        }
+        if (tryTake(global_queue_, item, false)) {
+            return true;
+        }
+
+        size_t count = slot_limit_.load();
+        for (size_t i = 1; i < count; ++i) {
+            WorkerQueue& victim = queues_[(index + i) % count];
+            if (victim.in_use.load() && tryTake(victim, item, false)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 是否需要减少线程
+    bool shouldRetire() const {
+        return !stop_ && live_threads_.load() > target_threads_.load();
+    }
+
+    // 退出当前工作线程，本地队列中剩余的任务转移到全局队列
+    bool tryRetire(size_t index) {
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        if (!shouldRetire()) {
+            return false;
+        }
+        --live_threads_;
+
+        WorkerQueue& queue = queues_[index];
+        bool moved = false;
+        {
+            std::lock_guard<std::mutex> queue_lock(queue.mutex);
+            std::lock_guard<std::mutex> global_lock(global_queue_.mutex);
+            while (!queue.tasks.empty()) {
+                global_queue_.tasks.push_back(std::move(queue.tasks.front()));
+                queue.tasks.pop_front();
+                moved = true;
+            }
+        }
+        queue.in_use.store(false);
+
+        if (moved) {
+            wakeAll();
+        }
+        return true;
+    }
+
+    // 执行任务并记录排队时间
+    void runTask(QueuedTask& item) {
+        auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - item.enqueued);
+        total_wait_ns_.fetch_add(static_cast<uint64_t>(wait.count()), std::memory_order_relaxed);
+        completed_tasks_.fetch_add(1, std::memory_order_relaxed);
+
+        try {
+            item.task();
+        } catch (const std::exception& e) {
+            std::cerr << "ThreadPool task error: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "ThreadPool task error: unknown exception" << std::endl;
+        }
+        item.task = PoolTask();
+        task_counts_.fetch_sub(kOneActive);
+    }
+
+    // 工作线程主循环
+    void workerLoop(size_t index) {
+        current_pool_ = this;
+        current_index_ = index;
+
+        while(true) {
+            if (shouldRetire() && tryRetire(index)) {
+                break;
+            }
+
+            QueuedTask item;
+            if (tryPop(index, item)) {
+                runTask(item);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            ++idle_workers_;
+            sleep_condition_.wait(lock, [this] {
+                return stop_ || getQueuedTaskCount() > 0 || shouldRetire();
+            });
+            --idle_workers_;
+
+            if(stop_ && getQueuedTaskCount() == 0) {
+                break;
+            }
+        }
+
+        current_pool_ = nullptr;
+    }
+
+    // 停止自适应控制线程
+    void stopController() {
+        {
+            std::lock_guard<std::mutex> lock(controller_mutex_);
+            controller_stop_ = true;
+        }
+        controller_condition_.notify_all();
+        if (controller_.joinable()) {
+            controller_.join();
+        }
+    }
+
+    // 自适应控制线程：按排队时间调整线程数
+    void controllerLoop() {
+        const AdaptivePoolOptions options = adaptive_options_;
+        uint64_t last_completed = completed_tasks_.load();
+        uint64_t last_wait_ns = total_wait_ns_.load();
+        size_t low_intervals = 0;
+
+        std::unique_lock<std::mutex> lock(controller_mutex_);
+        while (!controller_condition_.wait_for(lock, options.interval, [this] { return controller_stop_; })) {
+            uint64_t completed = completed_tasks_.load();
+            uint64_t wait_ns = total_wait_ns_.load();
+            uint64_t window_tasks = completed - last_completed;
+            uint64_t window_wait_ns = wait_ns - last_wait_ns;
+            last_completed = completed;
+            last_wait_ns = wait_ns;
+
+            uint64_t avg_wait_ns = window_tasks > 0 ? window_wait_ns / window_tasks : 0;
+            recent_wait_ns_.store(avg_wait_ns);
+
+            // 整个周期没有任务出队但仍有排队，说明线程全部被占用
+            bool starved = window_tasks == 0 && getQueuedTaskCount() > 0;
+            auto high_ns = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(options.high_watermark).count());
+            auto low_ns = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(options.low_watermark).count());
+
+            size_t target = target_threads_.load();
+            if (starved || avg_wait_ns > high_ns) {
+                low_intervals = 0;
+                if (target < options.max_threads) {
+                    size_t grown = std::min(options.max_threads, target + std::max<size_t>(1, target / 2));
+                    resize(grown);
+                    grow_events_.fetch_add(1);
+                }
+            } else if (avg_wait_ns < low_ns && idle_workers_.load() > 0) {
+                if (++low_intervals >= options.shrink_after_intervals && target > options.min_threads) {
+                    low_intervals = 0;
+                    resize(target - 1);
+                    shrink_events_.fetch_add(1);
+                }
+            } else {
+                low_intervals = 0;
+            }
+        }
+    }
+
+    // 当前线程所属的线程池及其队列下标
+    inline static thread_local ThreadPool* current_pool_ = nullptr;
+    inline static thread_local size_t current_index_ = 0;
+
+    std::vector<std::thread> workers_;              // 工作线程（按槽位）
+    std::mutex workers_mutex_;                      // 线程增减互斥锁
+    std::unique_ptr<WorkerQueue[]> queues_;         // 各槽位的本地队列
+    size_t capacity_;                               // 槽位数量（线程数上限）
+    WorkerQueue global_queue_;                      // 外部提交的任务队列
+    std::mutex sleep_mutex_;                        // 空闲等待互斥锁
+    std::condition_variable sleep_condition_;       // 空闲等待条件变量
     std::atomic<bool> stop_;                        // 停止标志
-    std::atomic<size_t> active_tasks_;             // 当前活跃任务数
+    std::atomic<uint64_t> task_counts_;             // 排队数与活跃数（见 kActiveShift）
+    std::atomic<size_t> idle_workers_;              // 空闲等待中的线程数
+    std::atomic<size_t> live_threads_;              // 运行中的工作线程数
+    std::atomic<size_t> target_threads_;            // 目标线程数
+    std::atomic<size_t> slot_limit_;                // 使用过的最大槽位 + 1
+    std::atomic<uint64_t> completed_tasks_;         // 已出队执行的任务数
+    std::atomic<uint64_t> total_wait_ns_;           // 累计排队时间
+    std::atomic<uint64_t> recent_wait_ns_;          // 最近周期的平均排队时间
+    std::atomic<uint64_t> grow_events_;             // 自适应扩容次数
+    std::atomic<uint64_t> shrink_events_;           // 自适应缩容次数
+
+    // 自适应控制
+    AdaptivePoolOptions adaptive_options_;
+    std::thread controller_;
+    std::mutex controller_mutex_;
+    std::condition_variable controller_condition_;
+    bool controller_stop_ = false;
 };
 
-} // namespace cesium_server
\ No newline at end of file
+} // namespace cesium_server
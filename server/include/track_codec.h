@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "track_store.h"
+
+namespace cesium_server {
+
+// 紧凑二进制航迹编码
+//
+// 一条二进制 WebSocket 消息由一个或多个帧顺序拼接而成，每帧格式（小端序）：
+//   帧头 8 字节：magic 'C' 'T' | version u8 | flags u8 | record_count u16 | reserved u16
+//   记录：
+//     record_flags u8（bit0: 带静态属性）
+//     id_len u8 | id 字节
+//     longitude i32（1e-7 度）| latitude i32（1e-7 度）
+//     altitude f32（米）| heading u16（0.01 度）| timestamp i64
+//     [静态属性] shipName/shipNumber/country/shipType 各为 len u8 + 字节 | attr i8
+// 只含位置的记录约 24 字节加ID长度，对应的 JSON 消息约 150 字节。
+namespace track_codec {
+
+constexpr uint8_t kMagic0 = 'C';
+constexpr uint8_t kMagic1 = 'T';
+constexpr uint8_t kVersion = 1;
+constexpr size_t kFrameHeaderSize = 8;
+constexpr size_t kMaxRecordsPerFrame = 0xFFFF;
+
+// 记录标志
+constexpr uint8_t kRecordHasAttributes = 0x01;
+
+// 追加帧头，返回记录数字段的偏移量
+size_t beginFrame(std::string& out);
+
+// 回填帧头中的记录数
+void endFrame(std::string& out, size_t header_offset, uint16_t record_count);
+
+// 追加一条记录
+void appendRecord(std::string& out, const Track& track);
+
+// 编码单条航迹为一帧
+std::string encode(const Track& track);
+
+// 编码多条航迹（超过单帧上限时自动分帧）
+std::string encode(const std::vector<Track>& tracks);
+
+// 读取一条记录并前移 p，格式错误时返回 false
+bool readRecord(const unsigned char*& p, const unsigned char* end, Track& track);
+
+// 解码一条消息中的所有帧，格式错误时返回 false
+bool decode(const char* data, size_t size, std::vector<Track>& out);
+
+} // namespace track_codec
+
+} // namespace cesium_server
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cesium_server {
+
+// 航迹数据结构（对应前端 EntityData）
+struct Track {
+    std::string id;            // 实体唯一标识
+    double longitude = 0.0;    // 经度
+    double latitude = 0.0;     // 纬度
+    double altitude = 0.0;     // 高度
+    double heading = 0.0;      // 航向
+    int64_t timestamp = 0;     // 最后更新时间戳
+
+    // 静态属性（更新频率低，单独存放）
+    std::string ship_name;     // 船舶名称
+    std::string ship_number;   // 船舶编号
+    std::string country;       // 国家
+    std::string ship_type;     // 类型
+    int attr = -1;             // 敌我属性，-1 表示未设置
+
+    uint64_t seq = 0;          // 更新序号（由 TrackStore 在写入时分配，读取时返回最后一次更新的序号）
+};
+
+// 分片航迹存储
+// 按实体ID哈希分片，每个分片一把锁；分片内部采用结构数组(SoA)布局，
+// 经纬度/高度/航向/时间戳各自连续存放，批量遍历时缓存友好。
+class TrackStore {
+public:
+    explicit TrackStore(size_t shard_count = 64);
+
+    TrackStore(const TrackStore&) = delete;
+    TrackStore& operator=(const TrackStore&) = delete;
+
+    // 插入或更新航迹，返回 true 表示新插入
+    // seq 非空时返回本次更新分配的序号；stored 非空时返回写入后的完整行（含保留的静态属性）
+    bool upsert(const Track& track, uint64_t* seq = nullptr, Track* stored = nullptr);
+
+    // 批量插入或更新航迹：按分片分组，每个分片只加锁一次；同一ID出现多次时后者生效
+    // 返回新插入的数量；seqs 非空时返回每条更新分配的序号，stored 非空时返回每条写入后的完整行（均与 tracks 下标对应）
+    size_t upsertBatch(const std::vector<Track>& tracks, std::vector<uint64_t>* seqs = nullptr,
+                       std::vector<Track>* stored = nullptr);
+
+    // 按ID读取航迹
+    bool get(const std::string& id, Track& out) const;
+
+    // 删除航迹
+    bool remove(const std::string& id);
+
+    // 遍历所有航迹（逐分片加锁）
+    void forEach(const std::function<void(const Track&)>& fn) const;
+
+    // 获取所有航迹的快照
+    std::vector<Track> snapshot() const;
+
+    // 获取最近 max_age 内更新过的航迹的快照
+    std::vector<Track> snapshot(std::chrono::milliseconds max_age) const;
+
+    // 获取更新序号大于 seq 的航迹（当前状态）
+    std::vector<Track> changedSince(uint64_t seq) const;
+
+    // 获取最后分配的更新序号
+    // 序号在分片锁内分配：读取到 N 后再遍历存储，一定能看到序号不大于 N 的所有更新
+    uint64_t sequence() const { return sequence_.load(); }
+
+    // 获取航迹数量
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    // 获取数据版本号：任一航迹插入、更新或删除后递增，可用于缓存失效
+    uint64_t generation() const;
+
+    // 获取分片数量
+    size_t shardCount() const { return shards_.size(); }
+
+private:
+    // 分片：对齐到缓存行，避免不同分片的锁之间伪共享
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+
+        // 分片版本号（在锁内递增，无锁读取）
+        std::atomic<uint64_t> generation{0};
+
+        // 实体ID -> 行号
+        std::unordered_map<std::string, uint32_t> index;
+
+        // 热数据列
+        std::vector<double> longitude;
+        std::vector<double> latitude;
+        std::vector<double> altitude;
+        std::vector<double> heading;
+        std::vector<int64_t> timestamp;
+        std::vector<uint64_t> seq;          // 最后一次更新的序号
+        std::vector<int64_t> updated_at;    // 最后一次更新的时间（steady_clock 毫秒）
+
+        // 冷数据列
+        std::vector<std::string> id;
+        std::vector<std::string> ship_name;
+        std::vector<std::string> ship_number;
+        std::vector<std::string> country;
+        std::vector<std::string> ship_type;
+        std::vector<int32_t> attr;
+
+        // 读取一行
+        void read(uint32_t row, Track& out) const;
+
+        // 写入一行
+        void write(uint32_t row, const Track& track, uint64_t update_seq, int64_t now);
+
+        // 追加一行
+        uint32_t append(const Track& track, uint64_t update_seq, int64_t now);
+
+        // 删除一行（与最后一行交换后弹出）
+        void erase(uint32_t row);
+
+        // 分片内容变化后递增版本号（调用方持有 mutex）
+        void bump() { generation.store(generation.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+    };
+
+    // 当前时间（steady_clock 毫秒）
+    static int64_t nowMillis();
+
+    // 根据实体ID定位分片
+    Shard& shardFor(const std::string& id) const;
+
+    // 根据实体ID计算分片下标
+    size_t shardIndex(const std::string& id) const;
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t shard_mask_;
+    std::atomic<size_t> size_;
+    std::atomic<uint64_t> sequence_{0};
+};
+
+} // namespace cesium_server
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "track_store.h"
+
+namespace cesium_server {
+
+// 二进制 UDP 组播帧
+//
+// 每个数据报一帧（小端序）：
+//   帧头 16 字节：magic 'C' 'U' | version u8 | flags u8 | record_count u16 | reserved u16
+//                 source_id u32 | sequence u32
+//   记录：与 track_codec 的记录格式相同
+// sequence 由发送方按 source_id 逐帧递增（32 位回绕），接收方据此检测丢包、乱序和重复。
+namespace udp_frame {
+
+constexpr uint8_t kMagic0 = 'C';
+constexpr uint8_t kMagic1 = 'U';
+constexpr uint8_t kVersion = 1;
+constexpr size_t kHeaderSize = 16;
+
+// 帧头
+struct FrameHeader {
+    uint32_t source_id = 0;
+    uint32_t sequence = 0;
+    uint16_t record_count = 0;
+};
+
+// 追加帧头，返回帧头偏移量
+size_t beginFrame(std::string& out, uint32_t source_id, uint32_t sequence);
+
+// 回填帧头中的记录数
+void endFrame(std::string& out, size_t header_offset, uint16_t record_count);
+
+// 编码一帧
+std::string encode(uint32_t source_id, uint32_t sequence, const std::vector<Track>& tracks);
+
+// 数据报是否为二进制 UDP 帧（只检查 magic 和版本）
+bool isFrame(const char* data, size_t size);
+
+// 解码一帧，记录追加到 out，格式错误时返回 false（out 不变）
+bool decode(const char* data, size_t size, FrameHeader& header, std::vector<Track>& out);
+
+} // namespace udp_frame
+
+// 乱序/丢包处理配置
+struct UdpFeedOptions {
+    uint32_t reorder_window = 32;                           // 重排窗口（按序号距离，最大 1024）：超前期望序号不足该距离的帧被缓冲，0 表示不等待缺失的帧
+    std::chrono::milliseconds reorder_timeout{50};          // 缺失的帧最多等待多久，超时后计为丢失并交付后续帧
+};
+
+// 按数据源统计
+struct UdpFeedStats {
+    uint64_t frames = 0;            // 收到的有效帧
+    uint64_t records = 0;           // 交付的航迹记录
+    uint64_t invalid = 0;           // 格式错误的帧
+    uint64_t duplicates = 0;        // 重复帧（已交付过的序号）
+    uint64_t lost = 0;              // 判定丢失的帧（缺失序号数）
+    uint64_t reordered = 0;         // 乱序到达、经缓冲后按序交付的帧
+    uint64_t late = 0;              // 判定丢失后才到达的帧（丢弃）
+    uint64_t restarts = 0;          // 序号大幅回退，视为数据源重启
+    size_t sources = 0;             // 数据源数
+    size_t pending = 0;             // 当前缓冲中的乱序帧
+};
+
+// 二进制 UDP 帧解码器
+// 按 source_id 维护期望序号：按序帧立即交付；超前的帧在重排窗口内缓冲，缺失的帧补齐后一起交付，
+// 等待超时或超出窗口时跳过缺失序号；最近 64 个已交付序号记录在位图中，用于区分重复帧和迟到帧。
+class UdpFeedDecoder {
+public:
+    explicit UdpFeedDecoder(const UdpFeedOptions& options = UdpFeedOptions());
+
+    UdpFeedDecoder(const UdpFeedDecoder&) = delete;
+    UdpFeedDecoder& operator=(const UdpFeedDecoder&) = delete;
+
+    // 设置配置（在处理数据之前调用）
+    void setOptions(const UdpFeedOptions& options);
+
+    // 处理一个数据报：可交付的记录（含因此补齐的缓冲帧）按序号顺序追加到 out，格式错误时返回 false
+    bool process(const char* data, size_t size, std::vector<Track>& out,
+                 std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    // 交付等待超时的缓冲帧，缺失的序号计为丢失
+    // process 只在数据到达时检查超时，数据源暂停发送时需要由定时器周期调用，缓冲的帧才不会滞留
+    // 只处理最近一次由调用线程 process 的数据源：多个线程共用解码器时，每个线程在自己的批处理之间调用，
+    // 交付的记录才不会与该数据源在其他线程上正在交付的批次交错
+    void expire(std::vector<Track>& out,
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    // 获取统计
+    UdpFeedStats getStats() const;
+
+private:
+    // 重排窗口中的一个槽位
+    struct Slot {
+        bool filled = false;
+        uint32_t sequence = 0;
+        std::vector<Track> tracks;
+    };
+
+    // 单个数据源的序号状态
+    struct Source {
+        uint32_t expected = 0;          // 下一个期望交付的序号
+        uint64_t history = 0;           // bit i：序号 expected-1-i 是否已交付
+        size_t pending = 0;             // 缓冲中的帧数
+        std::chrono::steady_clock::time_point gap_since;    // 当前缺口出现的时间
+        std::thread::id owner;          // 最近一次处理该数据源的线程
+        std::vector<Slot> window;       // 按 sequence % window 索引
+    };
+
+    // 交付一帧并前移期望序号
+    void deliver(Source& source, std::vector<Track>& tracks, std::vector<Track>& out);
+
+    // 跳过 count 个缺失序号
+    void skip(Source& source, uint32_t count);
+
+    // 交付从期望序号开始连续的缓冲帧
+    void drain(Source& source, std::vector<Track>& out);
+
+    // 跳到最早的缓冲帧（缺失序号计为丢失）并交付
+    void skipToPending(Source& source, std::vector<Track>& out);
+
+    // 清空缓冲
+    void clearWindow(Source& source);
+
+    UdpFeedOptions options_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<uint32_t, Source> sources_;
+    UdpFeedStats stats_;
+};
+
+} // namespace cesium_server
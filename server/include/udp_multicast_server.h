@@ -12,6 +12,14 @@
 #include <chrono>
 #include <queue>
 #include "thread_pool.h"
+#include "udp_feed.h"
+#include "datagram_ring.h"
+#include <condition_variable>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
 
 using namespace cesium_server;
 namespace net = boost::asio;
@@ -20,6 +28,68 @@ using udp = boost::asio::ip::udp;
 // UDP组播消息处理器类型
 using UdpMessageHandler = std::function<void(const std::string&, const boost::asio::ip::udp::endpoint&)>;
 
+// 接收到的数据报（data 指向接收缓冲区，仅在处理器调用期间有效）
+struct UdpDatagram {
+	const char* data;
+	size_t size;
+	udp::endpoint sender;
+	size_t feed = 0;			// 数据源编号：按目的组播组和端口区分，0 为构造时的组（见 addGroup）
+};
+
+// 组播订阅：组地址、端口和加入组播组使用的本地接口地址（0.0.0.0 表示默认接口）
+struct UdpGroupJoin {
+	std::string group;
+	unsigned short port = 0;
+	std::string interface_address = "0.0.0.0";
+};
+
+// UDP组播批量消息处理器类型：一次系统调用收到的所有数据报
+using UdpBatchHandler = std::function<void(const UdpDatagram* datagrams, size_t count)>;
+
+// UDP组播周期处理器类型：在调用批量处理器的线程上周期调用，没有新数据时也调用
+using UdpTickHandler = std::function<void()>;
+
+// 接收配置
+struct UdpReceiveOptions {
+	size_t batch_size = 64;		// 每次 recvmmsg 最多接收的数据报数（仅 Linux），0 或 1 表示逐个接收
+	size_t sockets = 1;			// 接收线程数（仅 Linux），大于 1 时每个线程在每个端口上一个 SO_REUSEPORT 套接字，按发送者分流
+	size_t workers = 1;			// 解码线程数，0 表示在接收线程上直接调用处理器
+	size_t queue_slots = 2048;	// 每个解码线程的环形队列槽位数（每个槽位占一个接收缓冲区大小，最多 64KB）
+	size_t socket_buffer_size = 4 * 1024 * 1024;	// 每个套接字的内核接收缓冲区 SO_RCVBUF，0 表示系统默认值
+};
+
+// 接收统计（速率每秒采样一次）
+struct UdpReceiveStats {
+	size_t sockets = 0;
+	size_t datagram_buffer_size = 0;	// 单个数据报的接收缓冲区
+	size_t socket_buffer_size = 0;		// 内核接收缓冲区的有效大小（每个套接字）
+	size_t queued_bytes = 0;			// 内核接收队列当前占用（所有套接字，含内核记账开销，仅 Linux）
+	size_t queued_bytes_peak = 0;		// 采样到的最大内核接收队列占用
+	uint64_t packets = 0;				// 接收的数据报
+	uint64_t bytes = 0;					// 接收的字节数
+	uint64_t truncated = 0;				// 超过数据报缓冲区被截断丢弃
+	uint64_t kernel_drops = 0;			// 内核接收缓冲区满时丢弃（仅 Linux）
+	uint64_t queue_drops = 0;			// 解码队列满时丢弃
+	double packets_per_second = 0;
+	double bytes_per_second = 0;
+	double drops_per_second = 0;		// 截断、内核和解码队列丢弃之和
+};
+
+// 接收线程到解码线程的分发统计
+struct UdpDispatchStats {
+	size_t workers = 0;
+	size_t queued = 0;			// 当前排队的数据报
+	uint64_t enqueued = 0;		// 入队的数据报
+	uint64_t dropped = 0;		// 队列满时丢弃的数据报
+	uint64_t processed = 0;		// 解码线程处理完的数据报
+};
+
+// 发送配置
+struct UdpSendOptions {
+	size_t max_datagram_size = 1472;	// 航迹帧的最大数据报长度（以太网 MTU 1500 减去 IP/UDP 头）
+	uint32_t source_id = 1;				// 二进制帧中的数据源标识
+};
+
 // UDP组播服务器类
 class UdpMulticastServer {
 public:
@@ -34,12 +104,53 @@ public:
 	// 停止服务器
 	void stop();
 
-	// 发送组播消息
+	// 发送组播消息（一条消息一个数据报，空消息忽略）
 	void sendMessage(const std::string& message);
 
-	// 设置消息处理器
+	// 发送航迹更新：记录追加到当前二进制帧，帧长达到 max_datagram_size 时换新帧，
+	// 发送线程取走队列前的多次调用合并到同一批数据报中
+	void sendTracks(const std::vector<Track>& tracks);
+
+	// 设置发送配置（在 run() 之前调用）
+	void setSendOptions(const UdpSendOptions& options) { send_options_ = options; }
+
+	// 获取已发送的数据报数和发送失败数
+	uint64_t getSentCount() const { return sent_count_; }
+	uint64_t getSendErrorCount() const { return send_error_count_; }
+
+	// 设置消息处理器（在 run() 之前调用；多套接字模式下会被多个接收线程并发调用）
 	void setMessageHandler(UdpMessageHandler handler);
 
+	// 设置批量消息处理器（设置后优先于逐条消息处理器；调用约束同上）
+	void setBatchHandler(UdpBatchHandler handler);
+
+	// 设置周期处理器（在 run() 之前调用）：有解码线程时在每个解码线程上、否则在每个接收线程上每 interval 调用一次，
+	// 与该线程上的处理器调用串行，用于没有新数据到达时也要推进的工作（如乱序帧的超时交付）
+	void setTickHandler(UdpTickHandler handler, std::chrono::milliseconds interval);
+
+	// 增加订阅的组播组（在 run() 之前调用），返回数据源编号。
+	// 同一组和端口在多个接口上加入时返回同一编号；所有组共用接收线程，每个端口每个接收线程一个套接字
+	size_t addGroup(const UdpGroupJoin& join);
+
+	// 获取数据源数和数据源的组播地址、端口
+	size_t getFeedCount() const { return feeds_.size(); }
+	udp::endpoint getFeedEndpoint(size_t feed) const { return feeds_.at(feed); }
+
+	// 设置接收配置（在 run() 之前调用）
+	void setReceiveOptions(const UdpReceiveOptions& options) { receive_options_ = options; }
+
+	// 是否使用 recvmmsg 批量接收
+	bool isBatchReceive() const;
+
+	// 获取因超过接收缓冲区而被截断丢弃的数据报数
+	uint64_t getTruncatedCount() const { return truncated_count_; }
+
+	// 获取分发统计
+	UdpDispatchStats getDispatchStats() const;
+
+	// 获取接收统计和每秒速率
+	UdpReceiveStats getReceiveStats() const;
+
 	// 获取服务器状态
 	bool isRunning() const { return running_; }
 
@@ -49,21 +160,155 @@ public:
 	// 获取端口
 	unsigned short getPort() const;
 
-	// 获取接收缓冲区大小
-	size_t getBufferSize() const { return recv_buffer_.size(); }
+	// 获取数据报接收缓冲区大小
+	size_t getBufferSize() const { return buffer_size_; }
+
+	// 获取接收套接字数
+	size_t getReceiveSocketCount() const { return receivers_.size(); }
 
-	// 发送测试数据
+	// 发送测试数据（position/status/alert 为 JSON 消息，tracks 为经 sendTracks 发送的二进制航迹帧）
 	void sendTestData(const std::string& test_data_type = "default");
 
 private:
+	// 接收套接字及其接收状态，只由该套接字的 IO 线程访问
+	struct Receiver {
+		size_t index = 0;									// 在 receivers_ 中的位置
+		size_t shard = 0;									// 接收线程编号（SO_REUSEPORT 分流编号）
+		unsigned short port = 0;
+		net::io_context* io_context = nullptr;				// 0 号线程为 io_context_，其余为 shard_contexts_ 中的一个
+		udp::socket* socket = nullptr;						// 0 号指向 socket_，其余指向 owned_socket
+		std::unique_ptr<udp::socket> owned_socket;
+
+		// 该端口上各组播组（主机序地址）对应的数据源编号，多于一个时按 IP_PKTINFO 中的目的地址分派
+		std::vector<std::pair<uint32_t, size_t>> feeds;
+		udp::endpoint sender_endpoint;
+		std::vector<char> recv_buffer;
+
+		// 批量接收缓冲区：batch_size 个数据报槽位连续分配，每个槽位大小与 recv_buffer 相同，启动时分配一次后复用
+		std::vector<char> batch_buffer;
+#if defined(__linux__)
+		// recvmmsg 参数：每个槽位一个消息头、iovec 和发送者地址
+		std::vector<mmsghdr> batch_headers;
+		std::vector<iovec> batch_iovecs;
+		std::vector<sockaddr_in> batch_addresses;
+		std::vector<char> batch_control;					// IP_PKTINFO 控制消息
+#endif
+		// 交给处理器的数据报视图
+		std::vector<UdpDatagram> batch_datagrams;
+
+		// 逐条处理器的消息缓冲区（批量接收且只设置了逐条处理器时复用）
+		std::string batch_message;
+
+		// 错误计数器和上次错误时间
+		int error_count = 0;
+		std::chrono::steady_clock::time_point last_error_time;
+
+		// 每秒采样内核接收队列，在该套接字的 IO 线程上运行
+		std::unique_ptr<net::steady_timer> stats_timer;
+
+		// 周期处理器定时器（没有解码线程时，每个接收线程只在第一个套接字上创建）
+		std::unique_ptr<net::steady_timer> tick_timer;
+		uint32_t socket_drops = 0;							// 上次采样时套接字的内核丢弃计数（套接字重新打开时清零）
+		std::atomic<uint64_t> packets{0};
+		std::atomic<uint64_t> bytes{0};
+		std::atomic<uint64_t> kernel_drops{0};				// 内核丢弃计数（含分流过滤器丢弃的数据报）
+		std::atomic<size_t> queued_bytes{0};
+		std::atomic<size_t> socket_buffer_size{0};
+	};
+
+	// 解码线程：从自己的环形队列批量取出数据报调用处理器
+	struct DispatchWorker {
+		std::unique_ptr<DatagramRing> ring;
+		std::atomic<bool> sleeping{false};			// 队列为空、线程等待中
+		std::mutex mutex;
+		std::condition_variable cv;
+		std::atomic<uint64_t> enqueued{0};
+		std::atomic<uint64_t> dropped{0};
+		std::atomic<uint64_t> processed{0};
+		std::string batch_message;					// 逐条处理器的消息缓冲区
+	};
+
 	// 接收消息
-	void doReceive();
+	void doReceive(Receiver& receiver);
+
+	// 批量接收消息：等待套接字可读后用 recvmmsg 一次读取多个数据报
+	void doReceiveBatch(Receiver& receiver);
+
+	// 分配批量接收缓冲区和 mmsghdr 数组
+	void prepareBatchBuffers(Receiver& receiver);
+
+	// 处理接收错误，错误频繁时重新加入组播组
+	void handleReceiveError(Receiver& receiver, const boost::system::error_code& ec);
 
 	// 处理接收到的消息
-	void handleMessage(const std::string& message, const boost::asio::ip::udp::endpoint& sender);
+	void handleMessage(Receiver& receiver, const std::string& message, const boost::asio::ip::udp::endpoint& sender);
+
+	// 处理一批接收到的消息：有解码线程时只复制入队，否则直接调用处理器
+	void handleBatch(Receiver& receiver, const UdpDatagram* datagrams, size_t count);
+
+	// 设置内核接收缓冲区大小，返回内核实际分配的大小
+	size_t applySocketBufferSize(udp::socket& socket);
+
+	// 每秒采样一次套接字的内核接收队列，0 号接收线程同时更新速率
+	void scheduleStatsSample(Receiver& receiver);
+	void sampleSocket(Receiver& receiver);
+	void updateRates();
+
+	// 内核因接收缓冲区满而丢弃的数据报数
+	uint64_t getKernelDropCount() const;
+
+	// 调用处理器
+	void invokeHandlers(std::string& message_buffer, const UdpDatagram* datagrams, size_t count);
+
+	// 在接收线程上周期调用周期处理器（没有解码线程时）
+	void scheduleTick(Receiver& receiver);
+
+	// 调用周期处理器
+	void invokeTick();
+
+	// 解码线程主循环
+	void dispatchLoop(DispatchWorker& worker);
+
+	// 创建接收套接字：count 个接收线程，每个线程在每个端口上一个套接字，必要时重建主套接字
+	void createReceivers(size_t count);
+
+	// 打开套接字并完成选项设置、绑定和加入该端口上的所有组播组（重新加入组播组和多套接字模式使用）
+	bool openSocket(udp::socket& socket, size_t shard, unsigned short port);
+
+	// 数据报的数据源编号（按目的地址）
+	size_t feedOf(const Receiver& receiver, uint32_t destination) const;
+
+	// 在多套接字模式下为套接字设置 SO_REUSEPORT 和按发送者分流的 BPF 过滤器
+	bool applyReusePort(udp::socket& socket, size_t shard, boost::system::error_code& ec);
+
+	// 重新连接组播组（index 为接收套接字在 receivers_ 中的位置）
+	bool rejoinMulticastGroup(size_t index = 0);
+
+	// 待发送的数据报：首尾相接存放在一个缓冲区中，交换后复用容量，发送路径不按数据报分配内存
+	struct SendBuffer {
+		std::string bytes;
+		std::vector<size_t> ends;						// 每个数据报的结束偏移
+		size_t open_frame = std::string::npos;			// 未封口的航迹帧起始偏移
+		uint16_t open_records = 0;
 
-	// 重新连接组播组
-	bool rejoinMulticastGroup();
+		bool empty() const { return ends.empty() && open_frame == std::string::npos; }
+		void clear() { bytes.clear(); ends.clear(); open_frame = std::string::npos; open_records = 0; }
+	};
+
+	// 封口当前航迹帧（调用方持有 mutex_）
+	void closeTrackFrame();
+
+	// 确保发送任务已调度（调用方持有 mutex_），返回 true 表示需要投递
+	bool scheduleSend();
+
+	// 在发送 strand 上取走队列并发送
+	void doSend();
+
+	// 从 next_datagram 开始发送 send_flushing_ 中的数据报
+	void sendFlushing();
+
+	// 发送失败处理：网络不可达时重新加入组播组
+	void handleSendError(const boost::system::error_code& ec);
 
 	// IO上下文
 	net::io_context io_context_;
@@ -71,7 +316,7 @@ private:
 	// 工作守卫
 	std::unique_ptr<net::executor_work_guard<net::io_context::executor_type>> work_guard_;
 
-	// 套接字
+	// 套接字（发送和 0 号接收套接字）
 	udp::socket socket_;
 
 	// 组播地址
@@ -80,35 +325,88 @@ private:
 	// 监听地址
 	std::string listen_address_;
 
-	// 发送者地址
-	udp::endpoint sender_endpoint_;
+	// 接收缓冲区大小
+	size_t buffer_size_;
+
+	// 订阅的组播组（0 号为构造时的组）和数据源（不同的组和端口）
+	std::vector<UdpGroupJoin> joins_;
+	std::vector<udp::endpoint> feeds_;
+
+	// 1 号及以后接收线程的 io_context（run() 时创建，stop() 时销毁）
+	std::vector<std::unique_ptr<net::io_context>> shard_contexts_;
+
+	// 接收套接字（run() 时创建，stop() 时销毁），按接收线程排列，每个线程每个端口一个
+	std::vector<std::unique_ptr<Receiver>> receivers_;
 
-	// 接收缓冲区
-	std::vector<char> recv_buffer_;
+	// 解码线程（run() 时创建，stop() 时销毁）
+	std::vector<std::unique_ptr<DispatchWorker>> workers_;
 
 	// 消息处理器
 	UdpMessageHandler message_handler_;
 
+	// 批量消息处理器
+	UdpBatchHandler batch_handler_;
+
+	// 周期处理器及其调用间隔
+	UdpTickHandler tick_handler_;
+	std::chrono::milliseconds tick_interval_{0};
+
+	// 接收配置
+	UdpReceiveOptions receive_options_;
+
 	// 线程池
 	std::unique_ptr<ThreadPool> thread_pool_;
 
 	// 运行标志
 	std::atomic<bool> running_;
 
-	// 互斥锁
+	// 互斥锁（保护发送队列和处理器设置）
 	std::mutex mutex_;
 
-	// 错误计数器
-	std::atomic<int> error_count_;
+	// 发送配置
+	UdpSendOptions send_options_;
+
+	// 生产者写入的发送队列（mutex_ 保护）
+	SendBuffer send_pending_;
 
-	// 上次错误时间
-	std::chrono::steady_clock::time_point last_error_time_;
+	// 发送 strand 正在发送的数据报
+	SendBuffer send_flushing_;
 
-	// 消息队列
-	std::queue<std::string> send_queue_;
+	// send_flushing_ 中下一个待发送的数据报
+	size_t next_datagram_;
 
-	// 发送中标志
+	// 下一个航迹帧的序号（mutex_ 保护，启动时随机，接收方据此区分发送方重启）
+	uint32_t next_sequence_;
+
+#if defined(__linux__)
+	// sendmmsg 参数
+	std::vector<mmsghdr> send_headers_;
+	std::vector<iovec> send_iovecs_;
+#endif
+
+	// 发送任务已调度（mutex_ 保护）
 	std::atomic<bool> sending_;
 
+	// 发送统计
+	std::atomic<uint64_t> sent_count_;
+	std::atomic<uint64_t> send_error_count_;
+
+	// 上次打印发送错误的时间（发送 strand 访问）
+	std::chrono::steady_clock::time_point last_send_error_time_;
+
+	// 被截断的数据报数
+	std::atomic<uint64_t> truncated_count_;
+
+	// 速率采样（stats_mutex_ 保护）
+	mutable std::mutex stats_mutex_;
+	std::chrono::steady_clock::time_point last_sample_time_;
+	uint64_t last_sample_packets_ = 0;
+	uint64_t last_sample_bytes_ = 0;
+	uint64_t last_sample_drops_ = 0;
+	size_t queued_bytes_peak_ = 0;
+	double packets_per_second_ = 0;
+	double bytes_per_second_ = 0;
+	double drops_per_second_ = 0;
+
 
 };
@@ -2,6 +2,7 @@
 
 #include <boost/asio.hpp>
 #include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
 #include <boost/beast/websocket.hpp>
 #include <functional>
 #include <iostream>
@@ -9,11 +10,15 @@
 #include <string>
 #include <thread>
 #include <vector>
-#include <set>
 #include <mutex>
-#include <queue>
+#include <deque>
 #include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include "shared_message.h"
+#include "subscription_index.h"
 #include "thread_pool.h"
+#include "io_context_pool.h"
 
 namespace cesium_server {
 
@@ -25,6 +30,96 @@ using tcp = boost::asio::ip::tcp;
 // 前置声明WebSocketSession类
 class WebSocketSession;
 
+// 会话消息格式，握手时通过 Sec-WebSocket-Protocol 协商
+enum class WireFormat {
+    Json,       // 文本帧，JSON 消息（默认）
+    Binary      // 位置更新使用二进制帧（见 track_codec.h），其它消息仍为 JSON 文本帧
+};
+
+// 子协议名称
+constexpr const char* kJsonSubprotocol = "cesium-track-json.v1";
+constexpr const char* kBinarySubprotocol = "cesium-track-bin.v1";
+
+// 写合并配置
+// 启用后，会话在一次写操作中发送队列里积压的所有消息（不超过 max_batch_bytes），
+// 多条 JSON 消息以分散/聚集写的方式拼成一个 JSON 数组帧（本身是数组的消息只并入其元素，帧内不嵌套数组），
+// 多条二进制消息直接首尾相接，消息内容本身不复制。
+struct WriteBatchOptions {
+    bool enabled = false;                       // 是否启用写合并
+    size_t max_batch_bytes = 64 * 1024;         // 单帧最大字节数
+    std::chrono::milliseconds max_delay{0};     // 首条消息入队后最多等待多久再发送
+};
+
+// 写队列溢出策略
+enum class OverflowPolicy {
+    DropOldest,         // 丢弃最旧的消息
+    ConflateByEntity    // 同一实体在队列中只保留最新的一条，仍超限时丢弃最旧的消息
+};
+
+// 慢消费者背压配置
+struct BackpressureOptions {
+    size_t max_queue_messages = 4096;                       // 队列最大消息数
+    size_t max_queue_bytes = 8 * 1024 * 1024;               // 队列最大字节数
+    OverflowPolicy policy = OverflowPolicy::ConflateByEntity;
+    std::chrono::seconds stall_timeout{10};                 // 队列持续溢出超过该时长则断开会话
+};
+
+// permessage-deflate 压缩配置（RFC 7692）
+// 客户端在握手时提供该扩展才会启用；每个会话各自持有压缩/解压上下文，
+// 内存开销约为 2^(window_bits+2) + 2^(mem_level+9) 字节（压缩）加 2^window_bits 字节（解压）。
+struct PermessageDeflateOptions {
+    bool enabled = false;
+    int server_max_window_bits = 15;        // 服务器发送方向的滑动窗口（9-15），越小内存越少、压缩率越低
+    int client_max_window_bits = 15;        // 客户端发送方向的滑动窗口（9-15）
+    bool server_no_context_takeover = false;    // 服务器每条消息重置压缩上下文（节省内存，降低压缩率）
+    bool client_no_context_takeover = false;    // 要求客户端每条消息重置压缩上下文
+    int level = 6;                          // 压缩级别 1-9
+    int mem_level = 4;                      // 内存级别 1-9
+    size_t min_size = 256;                  // 小于该字节数的帧不压缩（需要 Boost 1.81 及以上）
+};
+
+// 会话配置
+struct WebSocketSessionOptions {
+    WriteBatchOptions write_batch;
+    BackpressureOptions backpressure;
+    PermessageDeflateOptions deflate;
+    bool sync_on_connect = false;   // 会话从同步状态开始：startSync 发送完快照前，带序号的增量更新暂存在会话中
+};
+
+// 快照中的一块消息
+struct SyncChunk {
+    SharedMessage payload;
+    bool binary = false;
+};
+
+// 快照切换到增量更新时的去重条件
+// 序号不大于 watermark 的更新已包含在快照中；delivered 记录快照中序号大于 watermark 的实体及其序号，
+// 同一实体序号不大于该值的更新也不再发送
+struct SyncFilter {
+    uint64_t watermark = 0;
+    std::unordered_map<std::string, uint64_t> delivered;
+};
+
+// 会话写队列统计
+struct SessionQueueStats {
+    uint64_t session_id = 0;
+    std::string remote_endpoint;
+    size_t queue_depth = 0;         // 队列中的消息数
+    size_t queued_bytes = 0;        // 队列中的字节数
+    uint64_t dropped = 0;           // 因溢出丢弃的消息数
+    uint64_t conflated = 0;         // 被同实体新消息替换的消息数
+};
+
+// 批量广播中的一条位置更新
+struct BroadcastItem {
+    SharedMessage json_message;     // 该条更新的 JSON 消息（只发给设置了视域的会话）
+    SharedMessage binary_message;   // 该条更新的二进制消息（可为空）
+    double longitude = 0.0;
+    double latitude = 0.0;
+    std::string key;                // 实体ID
+    uint64_t seq = 0;               // 更新序号
+};
+
 // WebSocket 消息处理器类型
 using WebSocketMessageHandler = std::function<void(
     const std::string&, 
@@ -38,9 +133,12 @@ using WebSocketConnectionHandler = std::function<void(
 // WebSocket 会话类
 class WebSocketSession : public std::enable_shared_from_this<WebSocketSession> {
 public:
+    // syncing_sessions 非空时，会话进入和离开同步状态（包括同步中关闭）时增减该计数
     explicit WebSocketSession(tcp::socket&& socket, 
                              WebSocketMessageHandler message_handler,
-                             WebSocketConnectionHandler connection_handler);
+                             WebSocketConnectionHandler connection_handler,
+                             const WebSocketSessionOptions& options = WebSocketSessionOptions(),
+                             std::atomic<size_t>* syncing_sessions = nullptr);
     ~WebSocketSession();
 
     // 启动会话
@@ -48,26 +146,100 @@ public:
 
     // 发送消息
     void send(const std::string& message);
+
+    // 发送共享消息（不复制消息内容）
+    // key 为实体ID时，按背压策略可与队列中同一实体的旧消息合并；binary 表示以二进制帧发送
+    // seq 为增量更新的序号：同步期间暂存，同步完成后按 SyncFilter 去重；0 表示普通消息，直接入队
+    void send(SharedMessage message, std::string key = std::string(), bool binary = false, uint64_t seq = 0);
+
+    // 发送快照并切换到增量更新
+    // chunks 逐块发送：上一块写出后才发送下一块，块之间至少间隔 interval；
+    // 全部发送后，同步期间暂存的增量更新按序号排序、经 filter 去重后进入写队列
+    void startSync(std::vector<SyncChunk> chunks, SyncFilter filter,
+                   std::chrono::milliseconds interval = std::chrono::milliseconds(0));
+
+    // 是否正在同步快照
+    bool isSyncing() const { return syncing_; }
+
+    // 主动断开会话
+    void disconnect();
+
+    // 获取写队列统计
+    SessionQueueStats getQueueStats();
+
+    // 获取会话ID
+    uint64_t getId() const { return id_; }
+
+    // 获取协商的消息格式
+    WireFormat getWireFormat() const { return wire_format_; }
+
+    // 是否设置了视域订阅（设置后只接收视域内的位置更新）
+    bool hasViewport() const { return has_viewport_; }
+    void setHasViewport(bool value) { has_viewport_ = value; }
     
     // 获取WebSocket流的引用
     websocket::stream<beast::tcp_stream>& getStream() { return ws_; }
 
 private:
+    // 处理升级请求：协商子协议并完成握手
+    void onUpgradeRequest(beast::error_code ec);
+
     // 接收消息
     void doRead();
 
     // 处理关闭
     void onClose(beast::error_code ec);
+
+    // 通知连接已关闭（只通知一次）
+    void notifyClosed();
     
+    // 开始一轮写操作（必要时等待更多消息合并）
+    void startWrite();
+
     // 处理消息队列
     void doWrite();
 
+    // 消息入队（按背压策略合并、裁剪），返回 false 表示会话已无法跟上、即将断开（调用方持有 mutex_）
+    bool enqueue(SharedMessage message, std::string key, bool binary);
+
+    // 同步期间暂存增量更新（调用方持有 mutex_）
+    void holdForSync(SharedMessage message, std::string key, bool binary, uint64_t seq);
+
+    // 快照发送完毕：释放暂存的增量更新并切换为实时推送（调用方持有 mutex_）
+    void finishSync();
+
+    // 切换同步状态并更新同步会话计数（调用方持有 mutex_）
+    void setSyncing(bool syncing);
+
+    // 增量更新是否已包含在快照中（调用方持有 mutex_）
+    bool coveredBySync(const std::string& key, uint64_t seq);
+
+    // 弹出队首消息（调用方持有 mutex_）
+    SharedMessage popFront();
+
+    // 按背压配置裁剪队列，返回 true 表示会话已无法跟上（调用方持有 mutex_）
+    bool enforceLimits();
+
+    // 队列中的消息
+    struct QueuedMessage {
+        SharedMessage payload;
+        std::string key;
+        bool binary;
+    };
+
     // WebSocket 流
     websocket::stream<beast::tcp_stream> ws_;
 
     // 消息缓冲区
     beast::flat_buffer buffer_;
 
+    // WebSocket 升级请求
+    beast::http::request<beast::http::string_body> upgrade_request_;
+
+    // 协商的消息格式和子协议
+    WireFormat wire_format_ = WireFormat::Json;
+    std::string subprotocol_;
+
     // 消息处理器
     WebSocketMessageHandler message_handler_;
 
@@ -77,20 +249,88 @@ private:
     // 互斥锁，保护异步操作
     std::mutex mutex_;
     
+    // 会话ID和远端地址
+    uint64_t id_;
+    std::string remote_endpoint_;
+
     // 消息队列
-    std::queue<std::string> write_queue_;
+    std::deque<QueuedMessage> write_queue_;
+
+    // 队首消息的绝对序号
+    uint64_t queue_head_seq_ = 0;
+
+    // 实体ID -> 队列中该实体消息的绝对序号（用于合并）
+    std::unordered_map<std::string, uint64_t> pending_keys_;
+
+    // 队列中消息的总字节数
+    size_t queued_bytes_ = 0;
+
+    // 丢弃与合并计数
+    uint64_t dropped_count_ = 0;
+    uint64_t conflated_count_ = 0;
+
+    // 队列开始持续溢出的时间
+    std::chrono::steady_clock::time_point overflow_since_;
+
+    // 写合并配置
+    WriteBatchOptions batch_options_;
+
+    // 背压配置
+    BackpressureOptions backpressure_options_;
+
+    // permessage-deflate 压缩配置
+    PermessageDeflateOptions deflate_options_;
+
+    // 写合并等待定时器
+    net::steady_timer flush_timer_;
+
+    // 指示是否正在等待合并定时器
+    std::atomic<bool> waiting_flush_{false};
+
+    // 正在发送的消息及其缓冲区序列
+    std::vector<SharedMessage> in_flight_;
+    bool in_flight_binary_ = false;
+    std::vector<net::const_buffer> write_buffers_;
     
     // 指示是否有写操作正在进行
     std::atomic<bool> writing_{false};
     
     // 指示会话是否活跃
     std::atomic<bool> is_open_{true};
+
+    // 指示是否已通知连接关闭
+    std::atomic<bool> closed_notified_{false};
+
+    // 指示是否设置了视域订阅
+    std::atomic<bool> has_viewport_{false};
+
+    // 同步期间暂存的增量更新
+    struct HeldMessage {
+        SharedMessage payload;
+        bool binary = false;
+        uint64_t seq = 0;
+    };
+
+    // 快照同步状态
+    std::atomic<bool> syncing_{false};
+    std::atomic<size_t>* syncing_sessions_ = nullptr;       // 服务器的同步会话计数
+    bool sync_started_ = false;                             // 已调用 startSync
+    std::deque<SyncChunk> sync_chunks_;                     // 待发送的快照块
+    SyncFilter sync_filter_;
+    std::chrono::milliseconds sync_interval_{0};
+    std::chrono::steady_clock::time_point sync_next_chunk_at_;
+    net::steady_timer sync_timer_;
+
+    // 实体ID -> 该实体最新的暂存更新；不带实体ID的批量消息按到达顺序暂存
+    std::unordered_map<std::string, HeldMessage> held_updates_;
+    std::deque<HeldMessage> held_batches_;
 };
 
 // WebSocket 服务器类
 class WebSocketServer {
 public:
-    WebSocketServer(const std::string& address, unsigned short port, int threads = 1);
+    WebSocketServer(const std::string& address, unsigned short port, int threads = 1,
+                    const IoModelOptions& io_model = IoModelOptions());
     ~WebSocketServer();
 
     // 启动服务器
@@ -105,15 +345,71 @@ public:
     // 设置连接处理器
     void setConnectionHandler(WebSocketConnectionHandler handler);
 
+    // 设置写合并配置（对之后建立的会话生效）
+    void setWriteBatchOptions(const WriteBatchOptions& options) { session_options_.write_batch = options; }
+
+    // 设置背压配置（对之后建立的会话生效）
+    void setBackpressureOptions(const BackpressureOptions& options) { session_options_.backpressure = options; }
+
+    // 设置 permessage-deflate 压缩配置（对之后建立的会话生效）
+    void setDeflateOptions(const PermessageDeflateOptions& options) { session_options_.deflate = options; }
+
+    // 获取所有会话的写队列统计
+    std::vector<SessionQueueStats> getSessionQueueStats();
+
     // 广播消息给所有客户端
     void broadcast(const std::string& message);
+
+    // 广播消息给所有客户端（接管消息内容，避免复制）
+    void broadcast(std::string&& message);
+
+    // 广播共享消息给所有客户端，key 为消息对应的实体ID（可为空）
+    void broadcast(const SharedMessage& message, const std::string& key = std::string());
+
+    // 广播位置更新：只发送给未设置视域的会话和视域包含该位置的会话
+    void broadcastAt(const SharedMessage& message, double longitude, double latitude,
+                     const std::string& key = std::string());
+
+    // 广播位置更新的两种编码，每个会话按协商的格式选取（binary_message 可为空）
+    // seq 为该更新的序号，用于同步快照的会话去重
+    void broadcastAt(const SharedMessage& json_message, const SharedMessage& binary_message,
+                     double longitude, double latitude, const std::string& key = std::string(),
+                     uint64_t seq = 0);
+
+    // 批量广播位置更新
+    // 未设置视域的会话收到一条合并消息（json_batch 或 binary_batch），不再逐条入队；
+    // 设置了视域的会话和正在同步快照的会话收到各条更新的单条消息
+    // （items 中的消息可在没有这两类会话时留空，此时同步中的会话暂存合并消息，以 batch_seq 去重）
+    void broadcastBatch(const SharedMessage& json_batch, const SharedMessage& binary_batch,
+                        const std::vector<BroadcastItem>& items, uint64_t batch_seq = 0);
+
+    // 获取协商为二进制格式的会话数量
+    size_t getBinarySessionCount() const { return binary_sessions_.load(); }
+
+    // 获取设置了视域订阅的会话数量
+    size_t getViewportSessionCount() const { return subscriptions_.size(); }
+
+    // 获取正在同步快照的会话数量（包括握手尚未完成、从同步状态开始的会话）
+    size_t getSyncingSessionCount() const { return syncing_sessions_.load(); }
+
+    // 新会话是否从同步状态开始（对之后建立的会话生效，见 WebSocketSessionOptions::sync_on_connect）
+    void setSyncOnConnect(bool enabled) { session_options_.sync_on_connect = enabled; }
+
+    // 设置会话的视域订阅
+    void subscribeViewport(const std::shared_ptr<WebSocketSession>& session, const GeoBounds& bounds);
+
+    // 取消会话的视域订阅
+    void unsubscribeViewport(const std::shared_ptr<WebSocketSession>& session);
     
     // 向特定会话发送消息
     void sendTo(const std::shared_ptr<WebSocketSession>& session, const std::string& message);
 
 private:
-    // 接受新连接
-    void doAccept();
+    // 接受新连接；pinned_context 非空时连接固定在该 io_context 上
+    void doAccept(tcp::acceptor& acceptor, net::io_context* pinned_context);
+
+    // 选择新连接所在的执行器
+    net::any_io_executor sessionExecutor(net::io_context* pinned_context);
 
     // 服务器地址和端口
     std::string address_;
@@ -125,16 +421,33 @@ private:
     tcp::acceptor acceptor_;
     std::unique_ptr<ThreadPool> thread_pool_;
 
+    // 每线程一个 io_context 的模型
+    IoModelOptions io_model_;
+    std::unique_ptr<IoContextPool> io_pool_;
+    std::vector<std::unique_ptr<tcp::acceptor>> reuse_port_acceptors_;
+
     // 消息处理器
     WebSocketMessageHandler message_handler_;
 
     // 连接处理器
     WebSocketConnectionHandler connection_handler_;
 
-    // 活跃会话列表
-    std::set<std::shared_ptr<WebSocketSession>> sessions_;
+    // 会话配置
+    WebSocketSessionOptions session_options_;
+
+    // 活跃会话列表（会话ID -> 会话）
+    std::unordered_map<uint64_t, std::shared_ptr<WebSocketSession>> sessions_;
     std::mutex sessions_mutex_;
 
+    // 视域订阅索引
+    SubscriptionIndex subscriptions_;
+
+    // 二进制格式会话数量
+    std::atomic<size_t> binary_sessions_{0};
+
+    // 正在同步快照的会话数量（由会话在进入和离开同步状态时维护）
+    std::atomic<size_t> syncing_sessions_{0};
+
     // 服务器状态
     bool running_;
 };
@@ -1,5 +1,6 @@
 #include "cesium_server_app.h"
 #include "logger.h"
+#include "track_codec.h"
 #include <boost/json.hpp>
 #include <chrono>
 #include <cmath>
@@ -14,6 +15,148 @@ namespace cesium_server {
 
 namespace json = boost::json;
 
+namespace {
+
+// 未指定实体ID时使用的默认实体
+const char* const kDefaultTrackId = "default";
+
+// 获取当前时间戳
+int64_t currentTimestamp() {
+    return std::chrono::system_clock::now().time_since_epoch().count();
+}
+
+// 读取可选的数值字段
+bool readNumber(const json::object& obj, const char* key, double& out) {
+    auto it = obj.find(key);
+    if (it == obj.end() || !it->value().is_number()) {
+        return false;
+    }
+    out = it->value().to_number<double>();
+    return true;
+}
+
+// 读取可选的字符串字段
+void readString(const json::object& obj, const char* key, std::string& out) {
+    auto it = obj.find(key);
+    if (it != obj.end() && it->value().is_string()) {
+        out = it->value().as_string().c_str();
+    }
+}
+
+// 从JSON对象解析航迹，字段命名与前端 EntityData 保持一致
+bool parseTrack(const json::object& obj, Track& track) {
+    if (!readNumber(obj, "longitude", track.longitude) ||
+        !readNumber(obj, "latitude", track.latitude)) {
+        return false;
+    }
+
+    // 实体ID可以是字符串或数字，缺省时归入默认实体
+    track.id = kDefaultTrackId;
+    auto id_it = obj.find("id");
+    if (id_it != obj.end()) {
+        if (id_it->value().is_string()) {
+            track.id = id_it->value().as_string().c_str();
+        } else if (id_it->value().is_number()) {
+            track.id = std::to_string(id_it->value().to_number<int64_t>());
+        }
+    }
+
+    if (!readNumber(obj, "altitude", track.altitude)) {
+        readNumber(obj, "height", track.altitude);
+    }
+    readNumber(obj, "heading", track.heading);
+
+    double timestamp = 0.0;
+    track.timestamp = readNumber(obj, "timestamp", timestamp) ?
+        static_cast<int64_t>(timestamp) : currentTimestamp();
+
+    readString(obj, "shipName", track.ship_name);
+    readString(obj, "shipNumber", track.ship_number);
+    readString(obj, "country", track.country);
+    readString(obj, "shipType", track.ship_type);
+
+    double attr = 0.0;
+    if (readNumber(obj, "attr", attr)) {
+        track.attr = static_cast<int>(attr);
+    }
+    return true;
+}
+
+// 将航迹序列化为JSON对象
+json::object trackToJson(const Track& track, const char* type) {
+    json::object obj;
+    obj["type"] = type;
+    obj["id"] = track.id;
+    obj["longitude"] = track.longitude;
+    obj["latitude"] = track.latitude;
+    obj["altitude"] = track.altitude;
+    obj["heading"] = track.heading;
+    obj["timestamp"] = track.timestamp;
+    if (!track.ship_name.empty()) obj["shipName"] = track.ship_name;
+    if (!track.ship_number.empty()) obj["shipNumber"] = track.ship_number;
+    if (!track.country.empty()) obj["country"] = track.country;
+    if (!track.ship_type.empty()) obj["shipType"] = track.ship_type;
+    if (track.attr >= 0) obj["attr"] = track.attr;
+    if (track.seq != 0) obj["seq"] = track.seq;
+    return obj;
+}
+
+// 把航迹分块序列化：JSON 每块是一个数组（与批量广播的格式相同，前端无需区分；写合并时元素并入合并帧），
+// 二进制每块是一条多记录消息
+void serializeChunks(const std::vector<Track>& tracks, size_t chunk_tracks, bool binary,
+                     std::vector<SharedMessage>& out) {
+    chunk_tracks = std::max<size_t>(chunk_tracks, 1);
+    for (size_t begin = 0; begin < tracks.size(); begin += chunk_tracks) {
+        size_t end = std::min(tracks.size(), begin + chunk_tracks);
+        if (binary) {
+            std::vector<Track> slice(tracks.begin() + begin, tracks.begin() + end);
+            out.push_back(std::make_shared<const std::string>(track_codec::encode(slice)));
+        } else {
+            json::array chunk;
+            chunk.reserve(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                chunk.push_back(trackToJson(tracks[i], "snapshot"));
+            }
+            out.push_back(std::make_shared<const std::string>(json::serialize(chunk)));
+        }
+    }
+}
+
+// 用缓存的响应体填充响应，请求的 If-None-Match 与 ETag 匹配时返回 304
+void applyCachedBody(const http::request<http::string_body>& req,
+                     http::response<http::string_body>& res,
+                     const CachedBody& cached) {
+    res.set(http::field::etag, cached.etag);
+    res.set(http::field::cache_control, "no-cache");
+    res.set(http::field::access_control_expose_headers, "ETag");
+
+    if (etagMatches(req[http::field::if_none_match], cached.etag)) {
+        // 304 不带响应体，也不设置 Content-Length
+        res.result(http::status::not_modified);
+        res.erase(http::field::content_type);
+        res.body().clear();
+        return;
+    }
+
+    res.body() = cached.body;
+    res.prepare_payload();
+}
+
+// 解析 UDP 坐标消息，其它类型或格式错误时返回 false
+bool parseUdpTrack(json::string_view message, Track& track) {
+    try {
+        auto json_value = json::parse(message);
+        auto& obj = json_value.as_object();
+        std::string type = obj["type"].as_string().c_str();
+        return type == "coordinates" && parseTrack(obj, track);
+    } catch (const std::exception& e) {
+        std::cerr << "Error processing UDP message: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+} // namespace
+
 // 默认构造函数
 CesiumServerApp::CesiumServerApp()
     : CesiumServerApp(ServerConfig()) {
@@ -23,8 +166,7 @@ CesiumServerApp::CesiumServerApp()
 CesiumServerApp::CesiumServerApp(
     const std::string& http_address, unsigned short http_port,
     const std::string& ws_address, unsigned short ws_port)
-    : latest_coordinates_({0.0, 0.0}),
-      simulation_running_(false),
+    : simulation_running_(false),
       client_count_(0) {
     
     // 设置基本配置
@@ -40,7 +182,6 @@ CesiumServerApp::CesiumServerApp(
 // 完整配置构造函数
 CesiumServerApp::CesiumServerApp(const ServerConfig& config)
     : config_(config),
-      latest_coordinates_({0.0, 0.0}),
       simulation_running_(false),
       client_count_(0) {
     
@@ -58,7 +199,15 @@ void CesiumServerApp::initialize() {
 
         // 创建 HTTP 服务器
         http_server_ = std::make_unique<HttpServer>(
-            config_.http_address, config_.http_port, config_.http_threads);
+            config_.http_address, config_.http_port, config_.http_threads, config_.io_model);
+        http_server_->setKeepAliveOptions(config_.http_keep_alive);
+        http_server_->setBodyLimit(config_.http_body_limit);
+        http_server_->setCompressionOptions(config_.http_compression);
+        if (!config_.static_root.empty()) {
+            StaticFileOptions static_options;
+            static_options.root = config_.static_root;
+            http_server_->setStaticFiles(static_options);
+        }
         spdlog::info("HTTP server initialized, listening on: {}:{}", config_.http_address, config_.http_port);
 
         // 注册 HTTP 路由
@@ -71,10 +220,32 @@ void CesiumServerApp::initialize() {
             [this](const http::request<http::string_body>& req, const std::string& path) {
                 return handleHttpRequest(req, path);
             });
+
+        http_server_->addRoute(http::verb::get, "/tracks",
+            [this](const http::request<http::string_body>& req, const RouteParams& params) {
+                return handleTracksRequest(req);
+            });
+
+        // 只能使用 HTTP 的客户端通过事件流接收位置更新，与 WebSocket 广播共享同一份消息
+        http_server_->addEventStream("/tracks/stream");
+
+        http_server_->addRoute(http::verb::post, "/tracks/batch",
+            [this](const http::request<http::string_body>& req, const RouteParams& params) {
+                return handleTracksBatchRequest(req);
+            });
+
+        http_server_->addRoute(http::verb::get, "/tracks/{id}",
+            [this](const http::request<http::string_body>& req, const RouteParams& params) {
+                return handleTrackRequest(req, std::string(params.get("id")));
+            });
         
         // 创建 WebSocket 服务器
         ws_server_ = std::make_unique<WebSocketServer>(
-            config_.ws_address, config_.ws_port, config_.ws_threads);
+            config_.ws_address, config_.ws_port, config_.ws_threads, config_.io_model);
+        ws_server_->setWriteBatchOptions(config_.ws_write_batch);
+        ws_server_->setBackpressureOptions(config_.ws_backpressure);
+        ws_server_->setDeflateOptions(config_.ws_deflate);
+        ws_server_->setSyncOnConnect(config_.ws_snapshot.enabled);
         
         // 设置 WebSocket 消息处理器
         ws_server_->setMessageHandler(
@@ -96,10 +267,33 @@ void CesiumServerApp::initialize() {
             config_.udp_buffer_size);
         
         // 设置 UDP 消息处理器
+        udp_server_->setReceiveOptions(config_.udp_receive);
+        udp_server_->setSendOptions(config_.udp_send);
+        for (UdpGroupJoin join : config_.udp_groups) {
+            if (join.port == 0) {
+                join.port = config_.udp_port;
+            }
+            if (join.interface_address.empty()) {
+                join.interface_address = config_.udp_listen_address;
+            }
+            udp_server_->addGroup(join);
+        }
+        udp_feeds_.clear();
+        for (size_t i = 0; i < udp_server_->getFeedCount(); ++i) {
+            udp_feeds_.push_back(std::make_unique<UdpFeedDecoder>(config_.udp_feed));
+        }
         udp_server_->setMessageHandler(
             [this](const std::string& message, const udp::endpoint& sender) {
                 handleUdpMessage(message, sender);
             });
+        udp_server_->setBatchHandler(
+            [this](const UdpDatagram* datagrams, size_t count) {
+                handleUdpBatch(datagrams, count);
+            });
+        // 缺口后面已缓冲的帧按重排超时交付，数据源暂停发送时也不会滞留
+        if (config_.udp_feed.reorder_window > 0) {
+            udp_server_->setTickHandler([this]() { expireUdpFeeds(); }, config_.udp_feed.reorder_timeout);
+        }
         
         // 创建 ZeroMQ 服务器
         if (config_.enable_zmq) {
@@ -220,37 +414,143 @@ void CesiumServerApp::stop() {
     std::cout << "Cesium Server Application stopped" << std::endl;
 }
 
-// 获取最新坐标
+// 获取最新坐标（默认实体）
 Coordinates CesiumServerApp::getLatestCoordinates() const {
-    //std::lock_guard<std::mutex> lock(coordinates_mutex_);
-    return latest_coordinates_;
+    Coordinates coords;
+    Track track;
+    if (track_store_.get(kDefaultTrackId, track)) {
+        coords.longitude = track.longitude;
+        coords.latitude = track.latitude;
+        coords.altitude = track.altitude;
+        coords.timestamp = track.timestamp;
+    }
+    return coords;
 }
 
-// 更新坐标
+// 更新坐标（默认实体）
 void CesiumServerApp::updateCoordinates(const Coordinates& coords) {
-    {
-        std::lock_guard<std::mutex> lock(coordinates_mutex_);
-        latest_coordinates_ = coords;
+    Track track;
+    track.id = kDefaultTrackId;
+    track.longitude = coords.longitude;
+    track.latitude = coords.latitude;
+    track.altitude = coords.altitude;
+    track.timestamp = coords.timestamp;
+    updateTrack(track);
+}
+
+// 更新航迹并广播
+void CesiumServerApp::updateTrack(const Track& track, const char* source) {
+    bool has_ws_clients = ws_server_ && client_count_.load() > 0;
+    bool has_streams = http_server_ && http_server_->getEventStreamCount() > 0;
+
+    // 增量消息按写入后的完整行序列化：更新中省略的静态属性（名称/类型等）取存储中的值
+    uint64_t seq = 0;
+    Track stored;
+    track_store_.upsert(track, &seq, (has_ws_clients || has_streams) ? &stored : nullptr);
+    if (!has_ws_clients && !has_streams) {
+        return;
     }
     
     // 创建广播消息
-    json::object broadcast_obj;
-    broadcast_obj["type"] = "coordinates_update";
-    broadcast_obj["longitude"] = coords.longitude;
-    broadcast_obj["latitude"] = coords.latitude;
-    broadcast_obj["altitude"] = coords.altitude;
-    broadcast_obj["timestamp"] = coords.timestamp;
+    json::object broadcast_obj = trackToJson(stored, "coordinates_update");
+    broadcast_obj["seq"] = seq;
+    if (source) {
+        broadcast_obj["source"] = source;
+    }
     
-    // 广播给所有WebSocket客户端
+    // 广播给所有WebSocket客户端和事件流订阅者
     try {
-        if (ws_server_ && client_count_.load() > 0) {
-            ws_server_->broadcast(json::serialize(broadcast_obj));
+        // JSON 消息只序列化一次，WebSocket 和事件流共享
+        SharedMessage json_message = std::make_shared<const std::string>(json::serialize(broadcast_obj));
+        if (has_streams) {
+            http_server_->publishEvent(json_message);
+        }
+
+        if (has_ws_clients) {
+            // 只有存在二进制会话时才编码二进制消息
+            SharedMessage binary_message;
+            if (ws_server_->getBinarySessionCount() > 0) {
+                binary_message = std::make_shared<const std::string>(track_codec::encode(stored));
+            }
+
+            // 只发送给视域包含该位置的会话；以实体ID作为合并键，慢客户端队列中同一实体只保留最新位置
+            ws_server_->broadcastAt(json_message, binary_message, stored.longitude, stored.latitude, stored.id, seq);
         }
     } catch (const std::exception& e) {
         std::cerr << "Error broadcasting coordinates update: " << e.what() << std::endl;
     }
 }
 
+// 批量更新航迹并合并广播
+void CesiumServerApp::updateTracks(const std::vector<Track>& tracks, const char* source) {
+    if (tracks.empty()) {
+        return;
+    }
+
+    bool has_ws_clients = ws_server_ && client_count_.load() > 0;
+    bool has_streams = http_server_ && http_server_->getEventStreamCount() > 0;
+
+    // 每个分片只加锁一次；有订阅者时同时取回写入后的完整行用于序列化
+    std::vector<uint64_t> seqs;
+    std::vector<Track> stored;
+    track_store_.upsertBatch(tracks, &seqs, (has_ws_clients || has_streams) ? &stored : nullptr);
+    if (!has_ws_clients && !has_streams) {
+        return;
+    }
+
+    try {
+        bool need_binary = has_ws_clients && ws_server_->getBinarySessionCount() > 0;
+        // 设置了视域或正在同步快照的会话需要逐条的消息
+        bool need_items = has_ws_clients &&
+            (ws_server_->getViewportSessionCount() > 0 || ws_server_->getSyncingSessionCount() > 0);
+
+        // 未设置视域的会话收到整批一条消息：JSON 数组或多记录二进制帧
+        // （写合并时数组的元素直接并入合并帧，前端收到的始终是一层数组）
+        json::array batch;
+        batch.reserve(tracks.size());
+        std::vector<BroadcastItem> items(need_items ? tracks.size() : 0);
+        uint64_t batch_seq = 0;
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            json::object obj = trackToJson(stored[i], "coordinates_update");
+            obj["seq"] = seqs[i];
+            batch_seq = std::max(batch_seq, seqs[i]);
+            if (source) {
+                obj["source"] = source;
+            }
+
+            // 设置了视域的会话仍按位置逐条过滤
+            if (need_items) {
+                BroadcastItem& item = items[i];
+                item.json_message = std::make_shared<const std::string>(json::serialize(obj));
+                if (need_binary) {
+                    item.binary_message = std::make_shared<const std::string>(track_codec::encode(stored[i]));
+                }
+                item.longitude = stored[i].longitude;
+                item.latitude = stored[i].latitude;
+                item.key = stored[i].id;
+                item.seq = seqs[i];
+            }
+            batch.push_back(std::move(obj));
+        }
+
+        // 整批一条 JSON 数组消息，WebSocket 和事件流共享
+        SharedMessage json_batch = std::make_shared<const std::string>(json::serialize(batch));
+        if (has_streams) {
+            http_server_->publishEvent(json_batch);
+        }
+
+        if (has_ws_clients) {
+            SharedMessage binary_batch;
+            if (need_binary) {
+                binary_batch = std::make_shared<const std::string>(track_codec::encode(stored));
+            }
+            ws_server_->broadcastBatch(json_batch, binary_batch, items, batch_seq);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error broadcasting batch update: " << e.what() << std::endl;
+    }
+}
+
 // 处理 ZeroMQ 消息
 void CesiumServerApp::handleZmqMessage(const std::string& message, const std::string& topic) {
     try {
@@ -264,16 +564,14 @@ void CesiumServerApp::handleZmqMessage(const std::string& message, const std::st
                 std::string type = obj["type"].as_string().c_str();
                 
                 if (type == "get_coordinates") {
-                    // 获取坐标请求
-                    auto coords = getLatestCoordinates();
+                    // 获取坐标请求（可指定实体ID）
+                    Track track;
+                    track.id = kDefaultTrackId;
+                    readString(obj, "id", track.id);
+                    track_store_.get(track.id, track);
                     
                     // 创建响应
-                    json::object response;
-                    response["type"] = "coordinates";
-                    response["longitude"] = coords.longitude;
-                    response["latitude"] = coords.latitude;
-                    response["altitude"] = coords.altitude;
-                    response["timestamp"] = coords.timestamp;
+                    json::object response = trackToJson(track, "coordinates");
                     
                     // 发送响应
                     if (zmq_server_) {
@@ -282,14 +580,10 @@ void CesiumServerApp::handleZmqMessage(const std::string& message, const std::st
                 }
                 else if (type == "update_coordinates") {
                     // 更新坐标请求
-                    if (obj.contains("longitude") && obj.contains("latitude")) {
-                        double longitude = obj["longitude"].to_number<double>();
-                        double latitude = obj["latitude"].to_number<double>();
-                        double altitude = obj.contains("altitude") ? 
-                            obj["altitude"].to_number<double>() : 0.0;
-                        
-                        // 更新坐标
-                        updateCoordinates({longitude, latitude, altitude});
+                    Track track;
+                    if (parseTrack(obj, track)) {
+                        // 更新航迹
+                        updateTrack(track, "zmq");
                         
                         // 创建响应
                         json::object response;
@@ -333,22 +627,12 @@ http::response<http::string_body> CesiumServerApp::handleHttpRequest(
     
     // 处理根路径请求
     if (path == "/") {
-        json::object response;
-        response["status"] = "ok";
-        response["message"] = "Cesium Server is running";
-        response["timestamp"] = std::chrono::system_clock::now().time_since_epoch().count();
-        response["clients"] = client_count_.load();
-        
-        // 添加服务器配置信息
-        json::object config;
-        config["http_port"] = config_.http_port;
-        config["ws_port"] = config_.ws_port;
-        config["udp_port"] = config_.udp_port;
-        config["udp_multicast_address"] = config_.udp_multicast_address;
-        response["config"] = config;
-        
-        res.body() = json::serialize(response);
-        res.prepare_payload();
+        // 航迹或连接数变化时版本号递增（两个计数都单调递增，其和也单调递增）
+        uint64_t version = track_store_.generation() + connection_events_.load();
+        auto cached = status_cache_.get(version, [this] {
+            return buildStatusBody();
+        });
+        applyCachedBody(req, res, *cached);
         return res;
     }
     
@@ -362,6 +646,124 @@ http::response<http::string_body> CesiumServerApp::handleHttpRequest(
     return res;
 }
 
+// 生成服务器状态响应体
+std::string CesiumServerApp::buildStatusBody() {
+    json::object response;
+    response["status"] = "ok";
+    response["message"] = "Cesium Server is running";
+    response["timestamp"] = std::chrono::system_clock::now().time_since_epoch().count();
+    response["clients"] = client_count_.load();
+    
+    // 添加服务器配置信息
+    json::object config;
+    config["http_port"] = config_.http_port;
+    config["ws_port"] = config_.ws_port;
+    config["udp_port"] = config_.udp_port;
+    config["udp_multicast_address"] = config_.udp_multicast_address;
+    response["config"] = config;
+
+    // 各会话写队列状态
+    if (ws_server_) {
+        json::array sessions;
+        for (const auto& stats : ws_server_->getSessionQueueStats()) {
+            sessions.push_back(json::object{
+                {"id", stats.session_id},
+                {"remote", stats.remote_endpoint},
+                {"queue_depth", stats.queue_depth},
+                {"queued_bytes", stats.queued_bytes},
+                {"dropped", stats.dropped},
+                {"conflated", stats.conflated}
+            });
+        }
+        response["sessions"] = std::move(sessions);
+    }
+
+    // 事件流状态
+    if (http_server_) {
+        EventStreamStats stream_stats = http_server_->getEventStreamStats();
+        response["event_streams"] = json::object{
+            {"subscribers", stream_stats.subscribers},
+            {"published", stream_stats.published},
+            {"dropped", stream_stats.dropped}
+        };
+    }
+
+    // 二进制 UDP 帧的序号统计：udp_feed 为所有组播数据源的合计，udp_feeds 按数据源列出
+    auto feedStatsJson = [](const UdpFeedStats& stats) {
+        return json::object{
+            {"sources", stats.sources},
+            {"frames", stats.frames},
+            {"records", stats.records},
+            {"invalid", stats.invalid},
+            {"duplicates", stats.duplicates},
+            {"lost", stats.lost},
+            {"reordered", stats.reordered},
+            {"late", stats.late},
+            {"restarts", stats.restarts},
+            {"pending", stats.pending}
+        };
+    };
+    UdpFeedStats total_feed_stats;
+    json::array feeds;
+    for (size_t i = 0; i < udp_feeds_.size(); ++i) {
+        UdpFeedStats feed_stats = udp_feeds_[i]->getStats();
+        total_feed_stats.sources += feed_stats.sources;
+        total_feed_stats.frames += feed_stats.frames;
+        total_feed_stats.records += feed_stats.records;
+        total_feed_stats.invalid += feed_stats.invalid;
+        total_feed_stats.duplicates += feed_stats.duplicates;
+        total_feed_stats.lost += feed_stats.lost;
+        total_feed_stats.reordered += feed_stats.reordered;
+        total_feed_stats.late += feed_stats.late;
+        total_feed_stats.restarts += feed_stats.restarts;
+        total_feed_stats.pending += feed_stats.pending;
+
+        json::object feed = feedStatsJson(feed_stats);
+        if (udp_server_) {
+            udp::endpoint endpoint = udp_server_->getFeedEndpoint(i);
+            feed["group"] = endpoint.address().to_string();
+            feed["port"] = endpoint.port();
+        }
+        feeds.push_back(std::move(feed));
+    }
+    response["udp_feed"] = feedStatsJson(total_feed_stats);
+    response["udp_feeds"] = std::move(feeds);
+
+    // UDP 接收统计：内核缓冲区、丢弃计数和每秒速率
+    if (udp_server_) {
+        UdpReceiveStats receive_stats = udp_server_->getReceiveStats();
+        response["udp_receive"] = json::object{
+            {"sockets", receive_stats.sockets},
+            {"datagram_buffer_size", receive_stats.datagram_buffer_size},
+            {"socket_buffer_size", receive_stats.socket_buffer_size},
+            {"queued_bytes", receive_stats.queued_bytes},
+            {"queued_bytes_peak", receive_stats.queued_bytes_peak},
+            {"packets", receive_stats.packets},
+            {"bytes", receive_stats.bytes},
+            {"truncated", receive_stats.truncated},
+            {"kernel_drops", receive_stats.kernel_drops},
+            {"queue_drops", receive_stats.queue_drops},
+            {"packets_per_second", receive_stats.packets_per_second},
+            {"bytes_per_second", receive_stats.bytes_per_second},
+            {"drops_per_second", receive_stats.drops_per_second}
+        };
+    }
+
+    // UDP 接收线程到解码线程的分发统计
+    if (udp_server_) {
+        UdpDispatchStats dispatch_stats = udp_server_->getDispatchStats();
+        response["udp_dispatch"] = json::object{
+            {"workers", dispatch_stats.workers},
+            {"queued", dispatch_stats.queued},
+            {"enqueued", dispatch_stats.enqueued},
+            {"dropped", dispatch_stats.dropped},
+            {"processed", dispatch_stats.processed}
+        };
+    }
+    
+    return json::serialize(response);
+}
+
 // 处理坐标请求
 http::response<http::string_body> CesiumServerApp::handleCoordinatesRequest(
     const http::request<http::string_body>& req) {
@@ -389,23 +791,14 @@ http::response<http::string_body> CesiumServerApp::handleCoordinatesRequest(
             auto json_value = json::parse(req.body());
             auto obj = json_value.as_object();
             
-            // 提取坐标
-            double longitude = obj["longitude"].as_double();
-            double latitude = obj["latitude"].as_double();
-            double altitude = 0.0;
-            
-            // 尝试获取高度（可选）
-            if (obj.contains("altitude")) {
-                altitude = obj["altitude"].as_double();
+            // 提取航迹
+            Track track;
+            if (!parseTrack(obj, track)) {
+                throw std::invalid_argument("longitude and latitude are required");
             }
             
-            // 创建坐标对象
-            Coordinates coords(longitude, latitude, altitude);
-            
-            // 更新最新坐标并广播
-            updateCoordinates(coords);
-            
-            std::cout << "Received coordinates: " << longitude << ", " << latitude << ", " << altitude << std::endl;
+            // 更新航迹并广播
+            updateTrack(track, "http");
             
             // 返回成功响应
             res.body() = json::serialize(json::object{
@@ -428,16 +821,19 @@ http::response<http::string_body> CesiumServerApp::handleCoordinatesRequest(
     
     // 处理 GET 请求（获取坐标）
     if (req.method() == http::verb::get) {
-        Coordinates coords = getLatestCoordinates();
-        
-        json::object response;
-        response["longitude"] = coords.longitude;
-        response["latitude"] = coords.latitude;
-        response["altitude"] = coords.altitude;
-        response["timestamp"] = coords.timestamp;
-        
-        res.body() = json::serialize(response);
-        res.prepare_payload();
+        // 航迹未变化时直接使用缓存的响应体
+        auto cached = coordinates_cache_.get(track_store_.generation(), [this] {
+            Coordinates coords = getLatestCoordinates();
+
+            json::object response;
+            response["longitude"] = coords.longitude;
+            response["latitude"] = coords.latitude;
+            response["altitude"] = coords.altitude;
+            response["timestamp"] = coords.timestamp;
+            response["tracks"] = track_store_.size();
+            return json::serialize(response);
+        });
+        applyCachedBody(req, res, *cached);
         return res;
     }
     
@@ -450,6 +846,154 @@ http::response<http::string_body> CesiumServerApp::handleCoordinatesRequest(
     return res;
 }
 
+// 处理航迹列表请求
+http::response<http::string_body> CesiumServerApp::handleTracksRequest(
+    const http::request<http::string_body>& req) {
+    
+    http::response<http::string_body> res{http::status::ok, req.version()};
+    res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+    res.set(http::field::content_type, "application/json");
+    res.set(http::field::access_control_allow_origin, "*");
+    res.keep_alive(req.keep_alive());
+
+    // 航迹未变化时直接使用缓存的响应体
+    auto cached = tracks_cache_.get(track_store_.generation(), [this] {
+        json::array tracks;
+        tracks.reserve(track_store_.size());
+        track_store_.forEach([&tracks](const Track& track) {
+            tracks.push_back(trackToJson(track, "track"));
+        });
+
+        json::object response;
+        response["count"] = tracks.size();
+        response["tracks"] = std::move(tracks);
+        response["timestamp"] = currentTimestamp();
+        return json::serialize(response);
+    });
+    applyCachedBody(req, res, *cached);
+    return res;
+}
+
+// 处理批量航迹写入请求
+http::response<http::string_body> CesiumServerApp::handleTracksBatchRequest(
+    const http::request<http::string_body>& req) {
+    
+    http::response<http::string_body> res{http::status::ok, req.version()};
+    res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+    res.set(http::field::content_type, "application/json");
+    res.set(http::field::access_control_allow_origin, "*");
+    res.keep_alive(req.keep_alive());
+
+    const std::string& body = req.body();
+    size_t first = body.find_first_not_of(" \t\r\n");
+
+    // Content-Type 为 NDJSON，或请求体不以 '[' 开头时按每行一个 JSON 对象解析
+    auto content_type = req[http::field::content_type];
+    bool ndjson = content_type.find("ndjson") != beast::string_view::npos ||
+                  content_type.find("jsonl") != beast::string_view::npos ||
+                  (first != std::string::npos && body[first] != '[');
+
+    // 整个请求的解析结果都分配在单调内存池上，处理完一次性释放
+    json::monotonic_resource mr;
+    std::vector<Track> tracks;
+    size_t rejected = 0;
+
+    if (ndjson) {
+        json::parser parser;
+        size_t pos = 0;
+        while (pos < body.size()) {
+            size_t end = body.find('\n', pos);
+            if (end == std::string::npos) {
+                end = body.size();
+            }
+            json::string_view line(body.data() + pos, end - pos);
+            pos = end + 1;
+
+            // 跳过空行
+            if (line.find_first_not_of(" \t\r") == json::string_view::npos) {
+                continue;
+            }
+
+            json::error_code ec;
+            parser.reset(&mr);
+            parser.write(line, ec);
+            if (ec) {
+                ++rejected;
+                continue;
+            }
+            json::value item = parser.release();
+
+            Track track;
+            if (item.is_object() && parseTrack(item.get_object(), track)) {
+                tracks.push_back(std::move(track));
+            } else {
+                ++rejected;
+            }
+        }
+    } else {
+        json::error_code ec;
+        json::value root = json::parse(body, ec, &mr);
+        if (ec || !root.is_array()) {
+            res.result(http::status::bad_request);
+            res.body() = json::serialize(json::object{
+                {"error", "Invalid JSON"},
+                {"message", ec ? ec.message() : std::string("expected an array of tracks")}
+            });
+            res.prepare_payload();
+            return res;
+        }
+
+        const json::array& array = root.get_array();
+        tracks.reserve(array.size());
+        for (const auto& element : array) {
+            Track track;
+            if (element.is_object() && parseTrack(element.get_object(), track)) {
+                tracks.push_back(std::move(track));
+            } else {
+                ++rejected;
+            }
+        }
+    }
+
+    // 一次写入存储，一次合并广播
+    updateTracks(tracks, "http");
+
+    res.body() = json::serialize(json::object{
+        {"status", "ok"},
+        {"accepted", tracks.size()},
+        {"rejected", rejected}
+    });
+    res.prepare_payload();
+    return res;
+}
+
+// 处理单个航迹请求
+http::response<http::string_body> CesiumServerApp::handleTrackRequest(
+    const http::request<http::string_body>& req,
+    const std::string& id) {
+    
+    http::response<http::string_body> res{http::status::ok, req.version()};
+    res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+    res.set(http::field::content_type, "application/json");
+    res.set(http::field::access_control_allow_origin, "*");
+    res.keep_alive(req.keep_alive());
+
+    Track track;
+    if (!track_store_.get(id, track)) {
+        res.result(http::status::not_found);
+        res.body() = json::serialize(json::object{
+            {"error", "Track not found"},
+            {"id", id}
+        });
+        res.prepare_payload();
+        return res;
+    }
+
+    res.body() = json::serialize(trackToJson(track, "track"));
+    res.prepare_payload();
+    return res;
+}
+
 // WebSocket 消息处理器
 void CesiumServerApp::handleWebSocketMessage(
     const std::string& message,
@@ -476,15 +1020,14 @@ void CesiumServerApp::handleWebSocketMessage(
                 std::cerr << "Error sending pong response: " << e.what() << std::endl;
             }
         } else if (type == "get_coordinates") {
-            // 处理获取坐标请求
-            std::lock_guard<std::mutex> lock(coordinates_mutex_);
+            // 处理获取坐标请求（可指定实体ID）
+            Track track;
+            track.id = kDefaultTrackId;
+            readString(obj, "id", track.id);
+            track_store_.get(track.id, track);
             
-            json::object response;
-            response["type"] = "coordinates";
-            response["longitude"] = latest_coordinates_.longitude;
-            response["latitude"] = latest_coordinates_.latitude;
-            response["altitude"] = latest_coordinates_.altitude;
-            response["timestamp"] = std::chrono::system_clock::now().time_since_epoch().count();
+            json::object response = trackToJson(track, "coordinates");
+            response["timestamp"] = currentTimestamp();
             
             // 发送响应
             try {
@@ -492,6 +1035,39 @@ void CesiumServerApp::handleWebSocketMessage(
             } catch (const std::exception& e) {
                 std::cerr << "Error sending coordinates response: " << e.what() << std::endl;
             }
+        } else if (type == "update_coordinates") {
+            // 处理客户端上报的航迹
+            Track track;
+            if (parseTrack(obj, track)) {
+                updateTrack(track, "websocket");
+            }
+        } else if (type == "subscribe_viewport" || type == "subscribe_bbox") {
+            // 设置视域订阅，之后只接收视域内的位置更新
+            GeoBounds bounds;
+            if (!readNumber(obj, "west", bounds.west) || !readNumber(obj, "south", bounds.south) ||
+                !readNumber(obj, "east", bounds.east) || !readNumber(obj, "north", bounds.north)) {
+                throw std::invalid_argument("west, south, east and north are required");
+            }
+            bounds.south = std::clamp(bounds.south, -90.0, 90.0);
+            bounds.north = std::clamp(bounds.north, -90.0, 90.0);
+            bounds.west = std::clamp(bounds.west, -180.0, 180.0);
+            bounds.east = std::clamp(bounds.east, -180.0, 180.0);
+            ws_server_->subscribeViewport(session, bounds);
+
+            json::object response;
+            response["type"] = "viewport_subscribed";
+            response["west"] = bounds.west;
+            response["south"] = bounds.south;
+            response["east"] = bounds.east;
+            response["north"] = bounds.north;
+            session->send(json::serialize(response));
+        } else if (type == "unsubscribe_viewport") {
+            // 取消视域订阅，恢复接收全部更新
+            ws_server_->unsubscribeViewport(session);
+
+            json::object response;
+            response["type"] = "viewport_unsubscribed";
+            session->send(json::serialize(response));
         }
     } catch (const std::exception& e) {
         std::cerr << "Error handling WebSocket message: " << e.what() << std::endl;
@@ -506,6 +1082,7 @@ void CesiumServerApp::handleWebSocketConnection(
     if (connected) {
         // 客户端连接
         client_count_++;
+        connection_events_++;
         std::cout << "WebSocket client connected. Total clients: " << client_count_.load() << std::endl;
         
         // 发送欢迎消息
@@ -521,49 +1098,162 @@ void CesiumServerApp::handleWebSocketConnection(
         } catch (const std::exception& e) {
             std::cerr << "Error sending welcome message: " << e.what() << std::endl;
         }
+
+        // 发送所有活跃航迹的快照，之后切换为增量更新
+        if (config_.ws_snapshot.enabled) {
+            try {
+                sendTrackSnapshot(session);
+            } catch (const std::exception& e) {
+                std::cerr << "Error sending track snapshot: " << e.what() << std::endl;
+            }
+        }
     } else {
         // 客户端断开连接
         client_count_--;
+        connection_events_++;
         std::cout << "WebSocket client disconnected. Total clients: " << client_count_.load() << std::endl;
     }
 }
 
+// 获取航迹快照
+std::shared_ptr<const CesiumServerApp::TrackSnapshot> CesiumServerApp::getTrackSnapshot(bool need_binary) {
+    const SnapshotOptions& options = config_.ws_snapshot;
+    std::lock_guard<std::mutex> lock(track_snapshot_mutex_);
+
+    auto now = std::chrono::steady_clock::now();
+    if (track_snapshot_ && (track_snapshot_->has_binary || !need_binary) &&
+        now - track_snapshot_->built_at < options.cache_max_age) {
+        return track_snapshot_;
+    }
+
+    auto snapshot = std::make_shared<TrackSnapshot>();
+    snapshot->built_at = now;
+    snapshot->has_binary = need_binary || ws_server_->getBinarySessionCount() > 0;
+
+    // 先读取序号再遍历：序号不大于 base_seq 的更新一定包含在快照中
+    snapshot->base_seq = track_store_.sequence();
+    std::vector<Track> tracks = track_store_.snapshot(options.track_ttl);
+    snapshot->count = tracks.size();
+    serializeChunks(tracks, options.chunk_tracks, false, snapshot->json_chunks);
+    if (snapshot->has_binary) {
+        serializeChunks(tracks, options.chunk_tracks, true, snapshot->binary_chunks);
+    }
+
+    track_snapshot_ = snapshot;
+    return snapshot;
+}
+
+// 向新连接发送快照并切换到增量更新
+void CesiumServerApp::sendTrackSnapshot(const std::shared_ptr<WebSocketSession>& session) {
+    bool binary = session->getWireFormat() == WireFormat::Binary;
+    auto snapshot = getTrackSnapshot(binary);
+
+    // 会话在调用本函数前已加入广播集合并处于同步状态，此后的增量更新都暂存在会话中。
+    // 追赶：快照构建后（或缓存期间）发生的更新，以当前状态补发
+    SyncFilter filter;
+    filter.watermark = track_store_.sequence();
+    std::vector<Track> changed = track_store_.changedSince(snapshot->base_seq);
+
+    for (const Track& track : changed) {
+        // 遍历时看到的序号大于 watermark 的更新已随追赶发送，之后到达的同一更新需要去重
+        if (track.seq > filter.watermark) {
+            filter.delivered[track.id] = track.seq;
+        }
+    }
+
+    // 缓存的快照块只增加引用计数，追赶部分单独序列化
+    std::vector<SharedMessage> catch_up;
+    serializeChunks(changed, config_.ws_snapshot.chunk_tracks, binary, catch_up);
+
+    const auto& cached = binary ? snapshot->binary_chunks : snapshot->json_chunks;
+    std::vector<SyncChunk> chunks;
+    chunks.reserve(cached.size() + catch_up.size() + 1);
+    for (const auto& chunk : cached) {
+        chunks.push_back({chunk, binary});
+    }
+    for (auto& chunk : catch_up) {
+        chunks.push_back({std::move(chunk), binary});
+    }
+
+    // 快照结束标记
+    json::object complete;
+    complete["type"] = "snapshot_complete";
+    complete["count"] = snapshot->count;
+    complete["updated"] = changed.size();
+    complete["seq"] = filter.watermark;
+    chunks.push_back({std::make_shared<const std::string>(json::serialize(complete)), false});
+
+    session->startSync(std::move(chunks), std::move(filter), config_.ws_snapshot.chunk_interval);
+}
+
 // UDP 消息处理器
 void CesiumServerApp::handleUdpMessage(
     const std::string& message,
     const udp::endpoint& sender) {
-    try {
-        auto json_value = json::parse(message);
-        auto obj = json_value.as_object();
-        
-        // 处理不同类型的消息
-        std::string type = obj["type"].as_string().c_str();
-        
-        if (type == "coordinates") {
-            double longitude = obj["longitude"].as_double();
-            double latitude = obj["latitude"].as_double();
-            
-            // 更新最新坐标
-            {
-                std::lock_guard<std::mutex> lock(coordinates_mutex_);
-                latest_coordinates_.longitude = longitude;
-                latest_coordinates_.latitude = latitude;
-            }
-            
-            std::cout << "Received UDP coordinates: " << longitude << ", " << latitude << std::endl;
-            
-            // 广播坐标给所有 WebSocket 客户端
-            json::object broadcast_obj;
-            broadcast_obj["type"] = "coordinates_update";
-            broadcast_obj["longitude"] = longitude;
-            broadcast_obj["latitude"] = latitude;
-            broadcast_obj["timestamp"] = std::chrono::system_clock::now().time_since_epoch().count();
-            broadcast_obj["source"] = "udp";
-            
-            ws_server_->broadcast(json::serialize(broadcast_obj));
+    // 二进制帧与批量接收走同一路径
+    if (udp_frame::isFrame(message.data(), message.size())) {
+        UdpDatagram datagram{message.data(), message.size(), sender};
+        handleUdpBatch(&datagram, 1);
+        return;
+    }
+
+    // 更新航迹并广播给所有 WebSocket 客户端
+    Track track;
+    if (parseUdpTrack(message, track)) {
+        updateTrack(track, "udp");
+    }
+}
+
+// UDP 批量消息处理器
+void CesiumServerApp::handleUdpBatch(const UdpDatagram* datagrams, size_t count) {
+    // 一次 recvmmsg 收到的坐标合并为一次存储写入和一次合并广播；
+    // 多套接字模式下由多个接收线程并发调用，航迹存储按分片加锁
+    auto now = std::chrono::steady_clock::now();
+    std::vector<Track> tracks;
+    tracks.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const UdpDatagram& datagram = datagrams[i];
+        if (udp_frame::isFrame(datagram.data, datagram.size)) {
+            // 二进制帧：按组播数据源和源序号去重和重排
+            udp_feeds_[datagram.feed < udp_feeds_.size() ? datagram.feed : 0]->process(
+                datagram.data, datagram.size, tracks, now);
+            continue;
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Error processing UDP message: " << e.what() << std::endl;
+        Track track;
+        if (parseUdpTrack(json::string_view(datagram.data, datagram.size), track)) {
+            tracks.push_back(std::move(track));
+        }
+    }
+
+    if (tracks.empty()) {
+        return;
+    }
+
+    if (tracks.size() == 1) {
+        updateTrack(tracks.front(), "udp");
+    } else {
+        updateTracks(tracks, "udp");
+    }
+}
+
+// 交付等待超时的乱序帧
+void CesiumServerApp::expireUdpFeeds() {
+    // 每个调用批量处理器的线程各自周期调用，与本线程的 handleUdpBatch 串行；
+    // expire 只交付本线程处理的数据源，不会与其他线程上同一数据源的批次交错
+    auto now = std::chrono::steady_clock::now();
+    std::vector<Track> tracks;
+    for (auto& feed : udp_feeds_) {
+        feed->expire(tracks, now);
+    }
+
+    if (tracks.empty()) {
+        return;
+    }
+
+    if (tracks.size() == 1) {
+        updateTrack(tracks.front(), "udp");
+    } else {
+        updateTracks(tracks, "udp");
     }
 }
 
@@ -595,7 +1285,9 @@ void CesiumServerApp::simulationThread() {
             // 广播给所有客户端
             if (client_count_.load() > 0) {
                 try {
-                    ws_server_->broadcast(json::serialize(sim_data));
+                    ws_server_->broadcastAt(
+                        std::make_shared<const std::string>(json::serialize(sim_data)),
+                        longitude, latitude);
                 } catch (const std::exception& e) {
                     std::cerr << "Error broadcasting simulation data: " << e.what() << std::endl;
                 }
@@ -607,10 +1299,11 @@ void CesiumServerApp::simulationThread() {
                     // 轮流发送不同类型的测试数据
                     static int udp_test_counter = 0;
                     std::string test_type;
-                    switch (udp_test_counter % 3) {
+                    switch (udp_test_counter % 4) {
                         case 0: test_type = "position"; break;
                         case 1: test_type = "status"; break;
                         case 2: test_type = "alert"; break;
+                        case 3: test_type = "tracks"; break;
                     }
                     udp_server_->sendTestData(test_type);
                     udp_test_counter++;
@@ -0,0 +1,92 @@
+#include "datagram_ring.h"
+#include <cstring>
+
+namespace cesium_server {
+
+// 构造函数
+DatagramRing::DatagramRing(size_t capacity, size_t slot_size)
+    : slot_size_(slot_size), tail_(0), head_(0), head_published_(0) {
+    size_t count = 2;
+    while (count < capacity) {
+        count <<= 1;
+    }
+    mask_ = count - 1;
+
+    cells_ = std::make_unique<Cell[]>(count);
+    buffer_.resize(count * slot_size_);
+    for (size_t i = 0; i < count; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+        cells_[i].data = buffer_.data() + i * slot_size_;
+    }
+}
+
+// 入队
+bool DatagramRing::tryPush(const char* data, size_t size, const boost::asio::ip::udp::endpoint& sender, size_t feed) {
+    if (size > slot_size_) {
+        return false;
+    }
+
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells_[pos & mask_];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            // 槽位空闲，抢占写位置
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 槽位仍被上一轮占用：队列已满
+            return false;
+        } else {
+            // 其他生产者已抢占，重新读取写位置
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+
+    std::memcpy(cell->data, data, size);
+    cell->size = size;
+    cell->sender = sender;
+    cell->feed = feed;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+// 认领已入队的数据报
+size_t DatagramRing::claim(size_t max) {
+    size_t count = 0;
+    while (count < max) {
+        size_t pos = head_ + count;
+        if (cells_[pos & mask_].sequence.load(std::memory_order_acquire) != pos + 1) {
+            break;
+        }
+        ++count;
+    }
+    return count;
+}
+
+// 释放已认领的数据报
+void DatagramRing::release(size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        size_t pos = head_ + i;
+        cells_[pos & mask_].sequence.store(pos + mask_ + 1, std::memory_order_release);
+    }
+    head_ += count;
+    head_published_.store(head_, std::memory_order_relaxed);
+}
+
+// 队列是否为空
+bool DatagramRing::empty() const {
+    return cells_[head_ & mask_].sequence.load(std::memory_order_seq_cst) != head_ + 1;
+}
+
+// 当前排队数
+size_t DatagramRing::size() const {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_published_.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+}
+
+} // namespace cesium_server
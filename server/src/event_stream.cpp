@@ -0,0 +1,325 @@
+#include "event_stream.h"
+#include <boost/beast/version.hpp>
+#include <deque>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+namespace cesium_server {
+
+namespace {
+
+// 事件格式：data: <内容>\n\n
+const char kEventPrefix[] = "data: ";
+const char kEventSuffix[] = "\n\n";
+
+// 心跳注释行（以冒号开头的行会被客户端忽略）
+const char kHeartbeat[] = ": keep-alive\n\n";
+
+} // namespace
+
+// 事件流订阅者，持有一个已完成请求的 HTTP 连接
+// 所有 I/O 都在连接的执行器上进行；publish 从任意线程调用，通过互斥锁入队。
+class EventStreamSubscriber : public std::enable_shared_from_this<EventStreamSubscriber> {
+public:
+    EventStreamSubscriber(uint64_t id, beast::tcp_stream&& stream, unsigned version,
+                          const EventStreamOptions& options, std::weak_ptr<EventStreamHub> hub)
+        : id_(id),
+          stream_(std::move(stream)),
+          chunked_(version >= 11),
+          options_(options),
+          hub_(std::move(hub)),
+          heartbeat_timer_(stream_.get_executor()) {
+        if (options_.max_queue_messages == 0) {
+            options_.max_queue_messages = 1;
+        }
+        if (options_.max_batch_messages == 0) {
+            options_.max_batch_messages = 1;
+        }
+
+        header_.version(version);
+        header_.result(http::status::ok);
+        header_.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        header_.set(http::field::content_type, "text/event-stream");
+        header_.set(http::field::cache_control, "no-cache");
+        header_.set(http::field::access_control_allow_origin, "*");
+        if (chunked_) {
+            header_.chunked(true);
+        } else {
+            // HTTP/1.0 没有分块编码，响应体持续到连接关闭
+            header_.keep_alive(false);
+        }
+    }
+
+    // 写出响应头并开始推送
+    void start() {
+        net::dispatch(stream_.get_executor(),
+            beast::bind_front_handler(&EventStreamSubscriber::writeHeader, shared_from_this()));
+    }
+
+    // 事件入队，返回因积压丢弃的事件数
+    size_t push(const SharedMessage& data) {
+        size_t dropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return 0;
+            }
+            queue_.push_back(data);
+            while (queue_.size() > options_.max_queue_messages) {
+                queue_.pop_front();
+                ++dropped;
+            }
+            if (writing_ || !started_) {
+                return dropped;
+            }
+            writing_ = true;
+        }
+
+        net::post(stream_.get_executor(),
+            beast::bind_front_handler(&EventStreamSubscriber::doWrite, shared_from_this()));
+        return dropped;
+    }
+
+    // 关闭连接（可从任意线程调用）
+    void close() {
+        net::post(stream_.get_executor(),
+            beast::bind_front_handler(&EventStreamSubscriber::shutdown, shared_from_this()));
+    }
+
+private:
+    void writeHeader() {
+        serializer_.emplace(header_);
+        stream_.expires_after(options_.write_timeout);
+        http::async_write_header(stream_, *serializer_,
+            beast::bind_front_handler(&EventStreamSubscriber::onHeader, shared_from_this()));
+    }
+
+    void onHeader(beast::error_code ec, std::size_t) {
+        if (ec) {
+            shutdown();
+            return;
+        }
+        stream_.expires_never();
+        serializer_.reset();
+
+        // 订阅者不会再发送数据：挂起一个读操作，用于发现客户端断开
+        stream_.socket().async_read_some(net::buffer(read_buffer_),
+            beast::bind_front_handler(&EventStreamSubscriber::onRead, shared_from_this()));
+
+        bool pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            started_ = true;
+            pending = !queue_.empty();
+            writing_ = pending;
+        }
+        if (pending) {
+            doWrite();
+        } else {
+            armHeartbeat();
+        }
+    }
+
+    void onRead(beast::error_code ec, std::size_t) {
+        if (ec) {
+            shutdown();
+            return;
+        }
+        stream_.socket().async_read_some(net::buffer(read_buffer_),
+            beast::bind_front_handler(&EventStreamSubscriber::onRead, shared_from_this()));
+    }
+
+    void armHeartbeat() {
+        heartbeat_timer_.expires_after(options_.heartbeat);
+        heartbeat_timer_.async_wait(
+            [self = shared_from_this()](beast::error_code ec) {
+                if (ec) {
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(self->mutex_);
+                    if (self->writing_ || self->closed_) {
+                        return;
+                    }
+                    self->writing_ = true;
+                }
+                self->doWrite();
+            });
+    }
+
+    // 把积压的事件合并为一次写操作（事件内容不复制）
+    void doWrite() {
+        in_flight_.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (!queue_.empty() && in_flight_.size() < options_.max_batch_messages) {
+                in_flight_.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+
+        buffers_.clear();
+        if (in_flight_.empty()) {
+            buffers_.push_back(net::buffer(kHeartbeat, sizeof(kHeartbeat) - 1));
+        } else {
+            buffers_.reserve(in_flight_.size() * 3);
+            for (const auto& data : in_flight_) {
+                buffers_.push_back(net::buffer(kEventPrefix, sizeof(kEventPrefix) - 1));
+                buffers_.push_back(net::buffer(*data));
+                buffers_.push_back(net::buffer(kEventSuffix, sizeof(kEventSuffix) - 1));
+            }
+        }
+
+        heartbeat_timer_.cancel();
+        stream_.expires_after(options_.write_timeout);
+        if (chunked_) {
+            net::async_write(stream_, http::make_chunk(buffers_),
+                beast::bind_front_handler(&EventStreamSubscriber::onWrite, shared_from_this()));
+        } else {
+            net::async_write(stream_, buffers_,
+                beast::bind_front_handler(&EventStreamSubscriber::onWrite, shared_from_this()));
+        }
+    }
+
+    void onWrite(beast::error_code ec, std::size_t) {
+        in_flight_.clear();
+        if (ec) {
+            shutdown();
+            return;
+        }
+        stream_.expires_never();
+
+        bool more;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            more = !queue_.empty() && !closed_;
+            writing_ = more;
+        }
+        if (more) {
+            doWrite();
+        } else {
+            armHeartbeat();
+        }
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return;
+            }
+            closed_ = true;
+            queue_.clear();
+        }
+
+        heartbeat_timer_.cancel();
+        beast::error_code ec;
+        stream_.socket().shutdown(tcp::socket::shutdown_both, ec);
+        stream_.close();
+
+        if (auto hub = hub_.lock()) {
+            hub->remove(id_);
+        }
+    }
+
+    uint64_t id_;
+    beast::tcp_stream stream_;
+    bool chunked_;
+    EventStreamOptions options_;
+    std::weak_ptr<EventStreamHub> hub_;
+
+    http::response<http::empty_body> header_;
+    std::optional<http::response_serializer<http::empty_body>> serializer_;
+    net::steady_timer heartbeat_timer_;
+    char read_buffer_[512];
+
+    // 待发送的事件
+    std::mutex mutex_;
+    std::deque<SharedMessage> queue_;
+    bool started_ = false;      // 响应头已写出
+    bool writing_ = false;
+    bool closed_ = false;
+
+    // 正在发送的事件及其缓冲区序列
+    std::vector<SharedMessage> in_flight_;
+    std::vector<net::const_buffer> buffers_;
+};
+
+// 构造函数
+EventStreamHub::EventStreamHub(const EventStreamOptions& options)
+    : options_(options) {
+}
+
+// 析构函数
+EventStreamHub::~EventStreamHub() = default;
+
+// 接管连接并开始推送
+void EventStreamHub::subscribe(beast::tcp_stream&& stream, unsigned version) {
+    uint64_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    auto subscriber = std::make_shared<EventStreamSubscriber>(
+        id, std::move(stream), version, options_, weak_from_this());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        subscribers_.emplace(id, subscriber);
+        subscriber_count_.store(subscribers_.size(), std::memory_order_relaxed);
+    }
+    subscriber->start();
+}
+
+// 发布事件
+void EventStreamHub::publish(const SharedMessage& data) {
+    if (!data || subscriber_count_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    // 在锁内复制指针，在锁外入队
+    std::vector<std::shared_ptr<EventStreamSubscriber>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        snapshot.reserve(subscribers_.size());
+        for (const auto& entry : subscribers_) {
+            snapshot.push_back(entry.second);
+        }
+    }
+
+    size_t dropped = 0;
+    for (const auto& subscriber : snapshot) {
+        dropped += subscriber->push(data);
+    }
+    published_.fetch_add(1, std::memory_order_relaxed);
+    if (dropped > 0) {
+        dropped_.fetch_add(dropped, std::memory_order_relaxed);
+    }
+}
+
+// 关闭所有订阅者
+void EventStreamHub::closeAll() {
+    std::unordered_map<uint64_t, std::shared_ptr<EventStreamSubscriber>> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        subscribers.swap(subscribers_);
+        subscriber_count_.store(0, std::memory_order_relaxed);
+    }
+    for (const auto& entry : subscribers) {
+        entry.second->close();
+    }
+}
+
+// 获取统计
+EventStreamStats EventStreamHub::getStats() const {
+    EventStreamStats stats;
+    stats.subscribers = size();
+    stats.published = published_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// 订阅者断开时移除
+void EventStreamHub::remove(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscribers_.erase(id);
+    subscriber_count_.store(subscribers_.size(), std::memory_order_relaxed);
+}
+
+} // namespace cesium_server
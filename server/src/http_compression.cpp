@@ -0,0 +1,248 @@
+#include "http_compression.h"
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <array>
+
+namespace cesium_server {
+
+namespace zlib = beast::zlib;
+
+namespace {
+
+// gzip 头：magic、CM=8（deflate）、无标志、无修改时间、XFL=0、OS=255（未知）
+const unsigned char kGzipHeader[10] = {0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff};
+
+// zlib 头：CMF=0x78（deflate，32K 窗口），FLG 取默认级别且满足 (CMF*256+FLG) % 31 == 0
+const unsigned char kZlibHeader[2] = {0x78, 0x9c};
+
+// CRC-32 查找表（slicing-by-8：每次处理 8 字节，比逐字节查表快 3-4 倍，避免校验和成为压缩的瓶颈）
+using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+const CrcTables& crcTables() {
+    static const CrcTables tables = [] {
+        CrcTables t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int k = 1; k < 8; ++k) {
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+            }
+        }
+        return t;
+    }();
+    return tables;
+}
+
+// 线程局部的压缩上下文：deflate_stream 在参数不变时复用内部缓冲区（约 256KB）
+zlib::deflate_stream& threadDeflateStream(int level) {
+    thread_local zlib::deflate_stream stream;
+    thread_local int current_level = -1;
+    if (level != current_level) {
+        stream.reset(level, 15, 8, zlib::Strategy::normal);
+        current_level = level;
+    } else {
+        stream.reset();
+    }
+    return stream;
+}
+
+// 追加小端序 32 位整数
+void appendLE32(std::string& out, size_t offset, uint32_t value) {
+    out[offset] = static_cast<char>(value & 0xFF);
+    out[offset + 1] = static_cast<char>((value >> 8) & 0xFF);
+    out[offset + 2] = static_cast<char>((value >> 16) & 0xFF);
+    out[offset + 3] = static_cast<char>((value >> 24) & 0xFF);
+}
+
+// 追加大端序 32 位整数
+void appendBE32(std::string& out, size_t offset, uint32_t value) {
+    out[offset] = static_cast<char>((value >> 24) & 0xFF);
+    out[offset + 1] = static_cast<char>((value >> 16) & 0xFF);
+    out[offset + 2] = static_cast<char>((value >> 8) & 0xFF);
+    out[offset + 3] = static_cast<char>(value & 0xFF);
+}
+
+} // namespace
+
+// CRC-32
+uint32_t crc32(uint32_t crc, const unsigned char* data, size_t size) {
+    const auto& t = crcTables();
+    crc = ~crc;
+    while (size >= 8) {
+        // 按字节组合，与主机字节序无关
+        uint32_t lo = crc ^ (static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+                             static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24);
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+        data += 8;
+        size -= 8;
+    }
+    while (size--) {
+        crc = t[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// Adler-32
+uint32_t adler32(uint32_t adler, const unsigned char* data, size_t size) {
+    // 每 5552 字节取一次模，保证 32 位累加不溢出
+    constexpr uint32_t kBase = 65521;
+    constexpr size_t kMaxBlock = 5552;
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = (adler >> 16) & 0xFFFF;
+    while (size > 0) {
+        size_t block = size < kMaxBlock ? size : kMaxBlock;
+        size -= block;
+        while (block--) {
+            a += *data++;
+            b += a;
+        }
+        a %= kBase;
+        b %= kBase;
+    }
+    return (b << 16) | a;
+}
+
+// 客户端是否接受指定的内容编码
+bool acceptsEncoding(beast::string_view accept_encoding, beast::string_view coding) {
+    size_t pos = 0;
+    while (pos < accept_encoding.size()) {
+        size_t end = accept_encoding.find(',', pos);
+        if (end == beast::string_view::npos) {
+            end = accept_encoding.size();
+        }
+        beast::string_view item = accept_encoding.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t semicolon = item.find(';');
+        beast::string_view name = item.substr(0, semicolon);
+        while (!name.empty() && name.front() == ' ') name.remove_prefix(1);
+        while (!name.empty() && name.back() == ' ') name.remove_suffix(1);
+        if (!beast::iequals(name, coding)) {
+            continue;
+        }
+
+        if (semicolon != beast::string_view::npos) {
+            beast::string_view params = item.substr(semicolon + 1);
+            size_t q = params.find("q=");
+            if (q != beast::string_view::npos) {
+                beast::string_view value = params.substr(q + 2);
+                // q=0、q=0.0、q=0.00 等表示明确拒绝
+                bool zero = !value.empty() && value[0] == '0';
+                for (size_t i = 1; zero && i < value.size() && value[i] != ' ' && value[i] != ';'; ++i) {
+                    zero = value[i] == '.' || value[i] == '0';
+                }
+                if (zero) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+// 按 Accept-Encoding 选择编码
+ContentCoding negotiateCoding(beast::string_view accept_encoding) {
+    if (accept_encoding.empty()) {
+        return ContentCoding::Identity;
+    }
+    if (acceptsEncoding(accept_encoding, "gzip")) {
+        return ContentCoding::Gzip;
+    }
+    if (acceptsEncoding(accept_encoding, "deflate")) {
+        return ContentCoding::Deflate;
+    }
+    return ContentCoding::Identity;
+}
+
+// 内容类型是否值得压缩
+bool isCompressibleType(beast::string_view content_type) {
+    return content_type.substr(0, 5) == "text/" ||
+           content_type.find("json") != beast::string_view::npos ||
+           content_type.find("javascript") != beast::string_view::npos ||
+           content_type.find("xml") != beast::string_view::npos;
+}
+
+// 压缩数据
+void compress(ContentCoding coding, int level, const char* data, size_t size, std::string& out) {
+    auto& stream = threadDeflateStream(level);
+
+    size_t header_size = coding == ContentCoding::Gzip ? sizeof(kGzipHeader) : sizeof(kZlibHeader);
+    size_t trailer_size = coding == ContentCoding::Gzip ? 8 : 4;
+    out.resize(header_size + stream.upper_bound(size) + trailer_size);
+
+    if (coding == ContentCoding::Gzip) {
+        out.replace(0, header_size, reinterpret_cast<const char*>(kGzipHeader), header_size);
+    } else {
+        out.replace(0, header_size, reinterpret_cast<const char*>(kZlibHeader), header_size);
+    }
+
+    zlib::z_params zs;
+    zs.next_in = data;
+    zs.avail_in = size;
+    zs.next_out = &out[header_size];
+    zs.avail_out = out.size() - header_size - trailer_size;
+
+    beast::error_code ec;
+    stream.write(zs, zlib::Flush::finish, ec);
+    // 输出缓冲区按上界分配，一次 finish 即可写完
+    if (ec && ec != zlib::error::end_of_stream) {
+        throw beast::system_error(ec);
+    }
+
+    size_t offset = header_size + zs.total_out;
+    out.resize(offset + trailer_size);
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    if (coding == ContentCoding::Gzip) {
+        appendLE32(out, offset, crc32(0, bytes, size));
+        appendLE32(out, offset + 4, static_cast<uint32_t>(size & 0xFFFFFFFFu));
+    } else {
+        appendBE32(out, offset, adler32(1, bytes, size));
+    }
+}
+
+// 按请求的 Accept-Encoding 压缩响应体
+bool compressResponse(const http::request<http::string_body>& req,
+                      http::response<http::string_body>& res,
+                      const CompressionOptions& options) {
+    if (!options.enabled || res.body().size() < options.min_size ||
+        res.count(http::field::content_encoding) > 0 ||
+        res.result() == http::status::no_content ||
+        res.result() == http::status::not_modified ||
+        res.result() == http::status::partial_content ||
+        !isCompressibleType(res[http::field::content_type])) {
+        return false;
+    }
+
+    ContentCoding coding = negotiateCoding(req[http::field::accept_encoding]);
+    if (coding == ContentCoding::Identity) {
+        return false;
+    }
+
+    thread_local std::string compressed;
+    compress(coding, options.level, res.body().data(), res.body().size(), compressed);
+    if (compressed.size() >= res.body().size()) {
+        return false;
+    }
+
+    // 交换缓冲区：线程局部缓冲区接管原响应体的容量，下次压缩时复用
+    res.body().swap(compressed);
+    res.set(http::field::content_encoding, coding == ContentCoding::Gzip ? "gzip" : "deflate");
+    res.set(http::field::vary, "Accept-Encoding");
+
+    // 压缩后的字节与原始表示不同，强 ETag 改为弱 ETag（If-None-Match 使用弱比较，仍可返回 304）
+    auto etag = res[http::field::etag];
+    if (!etag.empty() && etag.substr(0, 2) != "W/") {
+        res.set(http::field::etag, "W/" + std::string(etag.data(), etag.size()));
+    }
+
+    res.prepare_payload();
+    return true;
+}
+
+} // namespace cesium_server
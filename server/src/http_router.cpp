@@ -0,0 +1,306 @@
+#include "http_router.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace cesium_server {
+
+namespace {
+
+// 按方法划分的处理器槽位，最后一个槽位匹配任意方法
+enum MethodSlot : size_t {
+    kSlotGet,
+    kSlotHead,
+    kSlotPost,
+    kSlotPut,
+    kSlotDelete,
+    kSlotPatch,
+    kSlotOptions,
+    kSlotAny,
+    kSlotCount
+};
+
+constexpr size_t kNoSlot = kSlotCount;
+
+// 方法对应的槽位
+size_t methodSlot(http::verb method) {
+    switch (method) {
+    case http::verb::get:     return kSlotGet;
+    case http::verb::head:    return kSlotHead;
+    case http::verb::post:    return kSlotPost;
+    case http::verb::put:     return kSlotPut;
+    case http::verb::delete_: return kSlotDelete;
+    case http::verb::patch:   return kSlotPatch;
+    case http::verb::options: return kSlotOptions;
+    case http::verb::unknown: return kSlotAny;
+    default:                  return kNoSlot;
+    }
+}
+
+const char* const kSlotNames[kSlotCount] = {
+    "GET", "HEAD", "POST", "PUT", "DELETE", "PATCH", "OPTIONS", "*"
+};
+
+// 公共前缀长度
+size_t commonPrefix(std::string_view a, std::string_view b) {
+    size_t n = std::min(a.size(), b.size());
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+} // namespace
+
+// 路由树节点
+struct HttpRouter::Node {
+    std::string prefix;                             // 静态片段（压缩后的公共前缀）
+    std::vector<std::unique_ptr<Node>> children;    // 静态子节点，首字符各不相同
+    std::unique_ptr<Node> param;                    // {name} 子节点
+    std::string param_name;
+    std::unique_ptr<Node> wildcard;                 // 通配符子节点
+    std::string wildcard_name;
+
+    std::array<RouteHandler, kSlotCount> handlers;
+    bool has_handler = false;
+    std::string allow;                              // 允许的方法列表（用于 405 和 OPTIONS）
+
+    // 获取方法对应的处理器（没有时取任意方法处理器）
+    const RouteHandler* handlerFor(size_t slot) const {
+        if (slot < kSlotAny && handlers[slot]) {
+            return &handlers[slot];
+        }
+        if (handlers[kSlotAny]) {
+            return &handlers[kSlotAny];
+        }
+        return nullptr;
+    }
+
+    // 查找首字符匹配的静态子节点
+    Node* findChild(char c) const {
+        for (const auto& child : children) {
+            if (child->prefix[0] == c) {
+                return child.get();
+            }
+        }
+        return nullptr;
+    }
+};
+
+HttpRouter::HttpRouter() : root_(std::make_unique<Node>()) {}
+
+HttpRouter::~HttpRouter() = default;
+
+// 注册路由
+void HttpRouter::add(http::verb method, std::string_view pattern, RouteHandler handler) {
+    if (pattern.empty() || pattern[0] != '/') {
+        throw std::invalid_argument("route pattern must start with '/': " + std::string(pattern));
+    }
+    size_t slot = methodSlot(method);
+    if (slot == kNoSlot) {
+        throw std::invalid_argument("unsupported method for route: " + std::string(pattern));
+    }
+
+    Node* node = root_.get();
+    size_t param_count = 0;
+    std::string_view rest = pattern;
+
+    while (!rest.empty()) {
+        if (rest[0] == '{' || rest[0] == '*') {
+            // 参数或通配符
+            std::string name;
+            bool is_wildcard = false;
+            size_t consumed = 0;
+
+            if (rest[0] == '*') {
+                is_wildcard = true;
+                consumed = 1;
+            } else {
+                size_t close = rest.find('}');
+                if (close == std::string_view::npos || close == 1) {
+                    throw std::invalid_argument("invalid parameter in route: " + std::string(pattern));
+                }
+                name.assign(rest.substr(1, close - 1));
+                if (name.back() == '*') {
+                    name.pop_back();
+                    is_wildcard = true;
+                }
+                consumed = close + 1;
+            }
+
+            if (++param_count > RouteParams::kMaxParams) {
+                throw std::invalid_argument("too many parameters in route: " + std::string(pattern));
+            }
+
+            if (is_wildcard) {
+                if (consumed != rest.size()) {
+                    throw std::invalid_argument("wildcard must be last in route: " + std::string(pattern));
+                }
+                if (!node->wildcard) {
+                    node->wildcard = std::make_unique<Node>();
+                    node->wildcard_name = name;
+                } else if (node->wildcard_name != name) {
+                    throw std::invalid_argument("conflicting wildcard name in route: " + std::string(pattern));
+                }
+                node = node->wildcard.get();
+            } else {
+                if (consumed < rest.size() && rest[consumed] != '/') {
+                    throw std::invalid_argument("parameter must span a whole segment: " + std::string(pattern));
+                }
+                if (!node->param) {
+                    node->param = std::make_unique<Node>();
+                    node->param_name = name;
+                } else if (node->param_name != name) {
+                    throw std::invalid_argument("conflicting parameter name in route: " + std::string(pattern));
+                }
+                node = node->param.get();
+            }
+            rest.remove_prefix(consumed);
+            continue;
+        }
+
+        // 静态片段：取到下一个参数之前
+        size_t end = rest.find_first_of("{*");
+        std::string_view segment = rest.substr(0, end);
+        rest.remove_prefix(segment.size());
+
+        // 沿基数树插入静态片段
+        while (!segment.empty()) {
+            Node* child = node->findChild(segment[0]);
+            if (!child) {
+                auto created = std::make_unique<Node>();
+                created->prefix.assign(segment);
+                child = created.get();
+                node->children.push_back(std::move(created));
+                node = child;
+                break;
+            }
+
+            size_t common = commonPrefix(child->prefix, segment);
+            if (common < child->prefix.size()) {
+                // 拆分已有节点：公共前缀成为新的中间节点
+                auto split = std::make_unique<Node>();
+                split->prefix = child->prefix.substr(0, common);
+
+                auto& slot_ref = *std::find_if(node->children.begin(), node->children.end(),
+                    [child](const std::unique_ptr<Node>& p) { return p.get() == child; });
+                std::unique_ptr<Node> old = std::move(slot_ref);
+                old->prefix.erase(0, common);
+                split->children.push_back(std::move(old));
+                child = split.get();
+                slot_ref = std::move(split);
+            }
+
+            node = child;
+            segment.remove_prefix(common);
+        }
+    }
+
+    if (node->handlers[slot]) {
+        throw std::invalid_argument("duplicate route: " + std::string(kSlotNames[slot]) + " " + std::string(pattern));
+    }
+    node->handlers[slot] = std::move(handler);
+    node->has_handler = true;
+    ++route_count_;
+
+    // 更新允许的方法列表
+    node->allow.clear();
+    if (node->handlers[kSlotAny]) {
+        node->allow = "GET, HEAD, POST, PUT, DELETE, PATCH, OPTIONS";
+    } else {
+        for (size_t i = 0; i < kSlotAny; ++i) {
+            if (node->handlers[i]) {
+                if (!node->allow.empty()) {
+                    node->allow += ", ";
+                }
+                node->allow += kSlotNames[i];
+            }
+        }
+    }
+}
+
+// 检查终止节点：方法匹配时返回处理器，否则记录第一个路径匹配的节点（用于 405）
+const RouteHandler* HttpRouter::acceptNode(const Node* node, size_t slot, const Node** path_match) {
+    if (!node->has_handler) {
+        return nullptr;
+    }
+    if (const RouteHandler* handler = node->handlerFor(slot)) {
+        return handler;
+    }
+    if (!*path_match) {
+        *path_match = node;
+    }
+    return nullptr;
+}
+
+// 递归匹配，失败时回退并尝试参数和通配符分支
+// 静态路径只注册了其他方法时（如 POST /tracks/batch），GET 请求会继续尝试参数分支（GET /tracks/{id}）
+const RouteHandler* HttpRouter::matchNode(const Node* node, std::string_view path, size_t slot,
+                                          RouteParams& params, const Node** path_match) {
+    if (path.empty()) {
+        if (const RouteHandler* handler = acceptNode(node, slot, path_match)) {
+            return handler;
+        }
+        // 通配符可以匹配空的剩余路径
+        if (node->wildcard) {
+            if (const RouteHandler* handler = acceptNode(node->wildcard.get(), slot, path_match)) {
+                params.items_[params.count_++] = {node->wildcard_name, path};
+                return handler;
+            }
+        }
+        return nullptr;
+    }
+
+    // 静态片段
+    if (const Node* child = node->findChild(path[0])) {
+        if (path.size() >= child->prefix.size() &&
+            path.compare(0, child->prefix.size(), child->prefix) == 0) {
+            if (const RouteHandler* handler =
+                    matchNode(child, path.substr(child->prefix.size()), slot, params, path_match)) {
+                return handler;
+            }
+        }
+    }
+
+    // 参数：匹配到下一个 '/' 为止的非空片段
+    if (node->param && path[0] != '/') {
+        size_t end = std::min(path.find('/'), path.size());
+        size_t saved = params.count_;
+        params.items_[params.count_++] = {node->param_name, path.substr(0, end)};
+        if (const RouteHandler* handler =
+                matchNode(node->param.get(), path.substr(end), slot, params, path_match)) {
+            return handler;
+        }
+        params.count_ = saved;
+    }
+
+    // 通配符：匹配剩余全部路径
+    if (node->wildcard) {
+        if (const RouteHandler* handler = acceptNode(node->wildcard.get(), slot, path_match)) {
+            params.items_[params.count_++] = {node->wildcard_name, path};
+            return handler;
+        }
+    }
+
+    return nullptr;
+}
+
+// 匹配路由
+const RouteHandler* HttpRouter::match(http::verb method, std::string_view path,
+                                      RouteParams& params, const std::string** allow) const {
+    params.count_ = 0;
+    params.path_ = path;
+
+    const Node* path_match = nullptr;
+    if (const RouteHandler* handler = matchNode(root_.get(), path, methodSlot(method), params, &path_match)) {
+        return handler;
+    }
+
+    if (path_match && allow) {
+        *allow = &path_match->allow;
+    }
+    params.count_ = 0;
+    return nullptr;
+}
+
+} // namespace cesium_server
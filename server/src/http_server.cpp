@@ -3,166 +3,369 @@
 #include <boost/asio/strand.hpp>
 #include <boost/config.hpp>
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <thread>
+#include <deque>
+#include <optional>
 #include <vector>
 #include <sstream>
 
 namespace cesium_server {
 
-// HTTP会话类，处理单个HTTP请求
+namespace {
+
+// 构建 JSON 错误响应
+http::response<http::string_body> makeErrorResponse(http::status status, const std::string& error_message,
+                                                    unsigned version = 11) {
+    http::response<http::string_body> res{status, version};
+    res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+    res.set(http::field::content_type, "application/json");
+    res.set(http::field::access_control_allow_origin, "*");
+
+    // Create JSON error response
+    std::stringstream ss;
+    ss << "{\"error\":\"" << status << "\",\"message\":\""
+       << error_message << "\"}";
+
+    res.body() = ss.str();
+    res.prepare_payload();
+    return res;
+}
+
+// 设置响应的 keep-alive 标志
+void setKeepAlive(SessionResponse& res, bool keep_alive) {
+    if (auto* file = std::get_if<FileResponse>(&res)) {
+        file->header.keep_alive(keep_alive);
+    } else {
+        std::get<http::response<http::string_body>>(res).keep_alive(keep_alive);
+    }
+}
+
+// 响应是否保持连接
+bool isKeepAlive(const SessionResponse& res) {
+    if (auto* file = std::get_if<FileResponse>(&res)) {
+        return file->header.keep_alive();
+    }
+    return std::get<http::response<http::string_body>>(res).keep_alive();
+}
+
+// 单个请求从开始读取到读完的超时
+constexpr std::chrono::seconds kRequestTimeout(30);
+
+} // namespace
+
+// HTTP会话类，处理一个连接上的所有请求
+// keep-alive 连接在响应后继续读取下一个请求；客户端流水线发送的请求按顺序处理，
+// 处理完的响应进入有界队列按序写出，队列满时暂停读取。
 class HttpSession : public std::enable_shared_from_this<HttpSession> {
 public:
     HttpSession(
         tcp::socket&& socket,
-        std::function<http::response<http::string_body>(const http::request<http::string_body>&, const std::string&)> handler_func,
-        std::function<void(tcp::socket&, http::status, const std::string&)> error_handler)
+        std::function<SessionResponse(const http::request<http::string_body>&)> handler_func,
+        const KeepAliveOptions& keep_alive,
+        uint64_t body_limit,
+        std::shared_ptr<EventStreamHub> event_hub,
+        const std::string& event_stream_path)
         : stream_(std::move(socket)),
+          idle_timer_(stream_.get_executor()),
           handler_func_(std::move(handler_func)),
-          error_handler_(std::move(error_handler)) {
-        // 设置超时
-        stream_.expires_after(std::chrono::seconds(30));
+          keep_alive_(keep_alive),
+          body_limit_(body_limit),
+          event_hub_(std::move(event_hub)),
+          event_stream_path_(event_stream_path) {
+        if (keep_alive_.pipeline_limit == 0) {
+            keep_alive_.pipeline_limit = 1;
+        }
+
+        // 流水线上连续的小响应不能等待前一个响应的 ACK（Nagle 与延迟 ACK 叠加会带来约 40ms 延迟）
+        beast::error_code ec;
+        stream_.socket().set_option(tcp::no_delay(true), ec);
     }
 
     void run() {
-        // 开始异步读取请求
-        http::async_read(stream_, buffer_, req_,
+        // 在连接的执行器上开始读取
+        net::dispatch(stream_.get_executor(),
             beast::bind_front_handler(
-                &HttpSession::onRead,
+                &HttpSession::doRead,
                 shared_from_this()));
     }
 
 private:
     beast::tcp_stream stream_;
+    // 响应写完后等待下一个请求的空闲期限
+    // 写出期间发起的流水线读取不带期限，tcp_stream 无法在读取挂起时重设读期限，由此定时器代替
+    net::steady_timer idle_timer_;
+    uint64_t idle_generation_ = 0;
+    bool idle_expired_ = false;
     beast::flat_buffer buffer_{8192};
+    std::optional<http::request_parser<http::string_body>> parser_;
     http::request<http::string_body> req_;
-    std::function<http::response<http::string_body>(const http::request<http::string_body>&, const std::string&)> handler_func_;
-    std::function<void(tcp::socket&, http::status, const std::string&)> error_handler_;
+    std::function<SessionResponse(const http::request<http::string_body>&)> handler_func_;
+    KeepAliveOptions keep_alive_;
+    uint64_t body_limit_;
+
+    // 事件流：匹配的 GET 请求把连接交给事件流中心
+    std::shared_ptr<EventStreamHub> event_hub_;
+    std::string event_stream_path_;
+    bool pending_event_stream_ = false;     // 等待之前的响应写完后再交出连接
+
+    // 待写出的响应（按请求顺序）
+    std::deque<SessionResponse> responses_;
+    size_t handled_requests_ = 0;
+    bool reading_ = false;
+    bool writing_ = false;
+    bool closing_ = false;      // 不再读取新请求，写完队列后关闭
+
+    void doRead() {
+        // 每个请求使用新的解析器，以便设置请求体上限（默认解析器只允许 1MB）
+        parser_.emplace();
+        parser_->body_limit(body_limit_);
+
+        // 第一个请求使用请求超时，之后等待下一个请求使用空闲超时。
+        // 还有响应在写出时不设读期限：读定时器到期会关闭整个连接，中断正在写出的响应；
+        // 写出由 doWrite 设置的写期限限制，队列写空后由 armIdleTimer 开始计算空闲时间
+        if (responses_.empty()) {
+            stream_.expires_after(handled_requests_ == 0
+                ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(kRequestTimeout)
+                : std::chrono::duration_cast<std::chrono::steady_clock::duration>(keep_alive_.idle_timeout));
+        } else {
+            stream_.expires_never();
+        }
+
+        reading_ = true;
+        http::async_read(stream_, buffer_, *parser_,
+            beast::bind_front_handler(
+                &HttpSession::onRead,
+                shared_from_this()));
+    }
 
     void onRead(beast::error_code ec, std::size_t bytes_transferred) {
-        if (ec == http::error::end_of_stream) {
-            // 客户端关闭连接
-            stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
+        reading_ = false;
+        ++idle_generation_;
+        idle_timer_.cancel();
+        if (ec == net::error::operation_aborted && idle_expired_) {
+            ec = beast::error::timeout;
+        }
+
+        if (ec == http::error::end_of_stream || ec == beast::error::timeout) {
+            // 客户端关闭连接或空闲超时：写完已排队的响应后关闭
+            closing_ = true;
+            if (!writing_) {
+                close(tcp::socket::shutdown_send);
+            }
+            return;
+        }
+
+        if (ec == http::error::body_limit) {
+            // 请求体过大：返回 413 后关闭连接（剩余请求体不再读取）
+            closing_ = true;
+            auto res = makeErrorResponse(http::status::payload_too_large,
+                "Request body exceeds " + std::to_string(body_limit_) + " bytes",
+                parser_->get().version());
+            res.keep_alive(false);
+            responses_.emplace_back(std::move(res));
+            if (!writing_) {
+                doWrite();
+            }
             return;
         }
 
         if (ec) {
             std::cerr << "Error reading request: " << ec.message() << std::endl;
-            // 确保在错误时关闭连接
-            beast::error_code shutdown_ec;
-            stream_.socket().shutdown(tcp::socket::shutdown_both, shutdown_ec);
-            if(shutdown_ec && shutdown_ec != beast::errc::not_connected) {
-                std::cerr << "Error shutting down socket: " << shutdown_ec.message() << std::endl;
-            }
+            close(tcp::socket::shutdown_both);
             return;
         }
 
         // 处理请求
+        req_ = parser_->release();
         handleRequest();
+
+        // 继续读取流水线中的下一个请求
+        if (!closing_ && responses_.size() < keep_alive_.pipeline_limit) {
+            doRead();
+        }
+    }
+
+    // 是否为事件流订阅请求
+    bool isEventStreamRequest() const {
+        if (!event_hub_ || req_.method() != http::verb::get) {
+            return false;
+        }
+        auto target = req_.target();
+        std::string_view path(target.data(), target.size());
+        return path.substr(0, path.find('?')) == event_stream_path_;
+    }
+
+    // 把连接交给事件流中心，之后本会话不再读写
+    void startEventStream() {
+        pending_event_stream_ = false;
+        event_hub_->subscribe(std::move(stream_), req_.version());
     }
 
     void handleRequest() {
-        try {
-            // 解析请求目标
-            auto const& target_view = req_.target();
-            std::string target_string(target_view.begin(), target_view.end());
-
-            // 创建响应
-            http::response<http::string_body> res;
-
-            try {
-                // 调用处理函数
-                res = handler_func_(req_, target_string);
-            } catch (const std::exception& e) {
-                std::cerr << "Handler error: " << e.what() << std::endl;
-                // 创建socket的副本，确保在异步操作期间socket不会被销毁
-                auto self = shared_from_this();
-                error_handler_(self->stream_.socket(), http::status::internal_server_error, 
-                    "Internal server error processing request");
-                return;
+        if (isEventStreamRequest()) {
+            // 事件流占用连接直到客户端断开，之后不再读取请求
+            ++handled_requests_;
+            closing_ = true;
+            if (!writing_ && responses_.empty()) {
+                startEventStream();
+            } else {
+                pending_event_stream_ = true;
             }
+            return;
+        }
 
-            // 发送响应
-            sendResponse(std::move(res));
+        // 创建响应
+        SessionResponse res;
+
+        try {
+            // 调用处理函数
+            res = handler_func_(req_);
         } catch (const std::exception& e) {
-            std::cerr << "Error handling request: " << e.what() << std::endl;
-            try {
-                // 创建socket的副本，确保在异步操作期间socket不会被销毁
-                auto self = shared_from_this();
-                error_handler_(self->stream_.socket(), http::status::internal_server_error, "Internal server error");
-            } catch (const std::exception& ex) {
-                std::cerr << "Error sending error response: " << ex.what() << std::endl;
-                // 确保在发生异常时关闭连接
-                beast::error_code ec;
-                stream_.socket().shutdown(tcp::socket::shutdown_both, ec);
-            }
+            std::cerr << "Handler error: " << e.what() << std::endl;
+            res = makeErrorResponse(http::status::internal_server_error,
+                "Internal server error processing request", req_.version());
+        }
+
+        // 设置keep-alive标志：客户端要求关闭或达到单连接请求上限时关闭连接
+        ++handled_requests_;
+        bool keep_alive = req_.keep_alive() &&
+            (keep_alive_.max_requests == 0 || handled_requests_ < keep_alive_.max_requests);
+        setKeepAlive(res, keep_alive);
+        if (!keep_alive) {
+            closing_ = true;
+        }
+
+        // 发送响应
+        responses_.push_back(std::move(res));
+        if (!writing_) {
+            doWrite();
         }
     }
 
-    void sendResponse(http::response<http::string_body>&& res) {
-        // 设置keep-alive标志
-        res.keep_alive(req_.keep_alive());
+    void doWrite() {
+        writing_ = true;
 
-        // 创建响应的共享指针，确保在异步操作期间响应对象不会被销毁
-        auto res_ptr = std::make_shared<http::response<http::string_body>>(std::move(res));
+        // 每个响应重新设置写期限（流水线读取挂起时只影响写定时器）
+        stream_.expires_after(keep_alive_.write_timeout);
 
-        // 发送响应
-        auto self = shared_from_this();
-        http::async_write(stream_, *res_ptr,
-            [self, res_ptr](beast::error_code ec, std::size_t bytes_transferred) {
-                if (ec) {
-                    std::cerr << "Error writing response: " << ec.message() << std::endl;
-                    return;
-                }
+        // 静态文件：写出头部后直接发送文件内容
+        if (auto* file = std::get_if<FileResponse>(&responses_.front())) {
+            sendFileResponse(stream_, *file, keep_alive_.write_timeout,
+                [self = shared_from_this()](beast::error_code ec) {
+                    self->onWrite(ec, 0);
+                });
+            return;
+        }
 
-                // 如果不是keep-alive，关闭连接
-                if (!self->req_.keep_alive()) {
-                    self->stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
-                    if (ec && ec != beast::errc::not_connected) {
-                        std::cerr << "Error shutting down socket: " << ec.message() << std::endl;
-                    }
+        http::async_write(stream_, std::get<http::response<http::string_body>>(responses_.front()),
+            beast::bind_front_handler(
+                &HttpSession::onWrite,
+                shared_from_this()));
+    }
+
+    void onWrite(beast::error_code ec, std::size_t bytes_transferred) {
+        writing_ = false;
+
+        if (ec) {
+            std::cerr << "Error writing response: " << ec.message() << std::endl;
+            close(tcp::socket::shutdown_both);
+            return;
+        }
+
+        // 如果不是keep-alive，关闭连接
+        bool keep_alive = isKeepAlive(responses_.front());
+        responses_.pop_front();
+        if (!keep_alive) {
+            close(tcp::socket::shutdown_send);
+            return;
+        }
+
+        if (!responses_.empty()) {
+            doWrite();
+            return;
+        }
+
+        if (pending_event_stream_) {
+            startEventStream();
+            return;
+        }
+
+        if (closing_) {
+            close(tcp::socket::shutdown_send);
+            return;
+        }
+
+        // 队列曾满而暂停读取时恢复；读取已在进行时从现在开始计算空闲时间
+        if (!reading_) {
+            doRead();
+        } else {
+            armIdleTimer();
+        }
+    }
+
+    // 空闲超时：取消挂起的读取，onRead 按超时处理
+    void armIdleTimer() {
+        idle_timer_.expires_after(keep_alive_.idle_timeout);
+        idle_timer_.async_wait(
+            [self = shared_from_this(), generation = ++idle_generation_](beast::error_code ec) {
+                if (ec || generation != self->idle_generation_) {
+                    return;
                 }
+                self->idle_expired_ = true;
+                beast::error_code ignored;
+                self->stream_.socket().cancel(ignored);
             });
     }
+
+    void close(tcp::socket::shutdown_type how) {
+        // 超时已经关闭了套接字
+        if (!stream_.socket().is_open()) {
+            return;
+        }
+        beast::error_code ec;
+        stream_.socket().shutdown(how, ec);
+        if (ec && ec != beast::errc::not_connected) {
+            std::cerr << "Error shutting down socket: " << ec.message() << std::endl;
+        }
+    }
 };
 
 // HTTP Server Constructor
-HttpServer::HttpServer(const std::string& address, unsigned short port, int threads)
+HttpServer::HttpServer(const std::string& address, unsigned short port, int threads,
+                       const IoModelOptions& io_model)
     : address_(address), port_(port), num_threads_(threads), 
-      ioc_(threads), acceptor_(net::make_strand(ioc_)), running_(false) {
+      ioc_(threads), acceptor_(net::make_strand(ioc_)), io_model_(io_model), running_(false) {
     
-    beast::error_code ec;
-
-    // Open acceptor
     tcp::endpoint endpoint(net::ip::make_address(address), port);
-    acceptor_.open(endpoint.protocol(), ec);
-    if (ec) {
-        std::cerr << "Error opening acceptor: " << ec.message() << std::endl;
-        return;
-    }
 
-    // Allow address reuse
-    acceptor_.set_option(net::socket_base::reuse_address(true), ec);
-    if (ec) {
-        std::cerr << "Error setting reuse_address: " << ec.message() << std::endl;
-        return;
-    }
+    if (io_model_.model == IoModel::PerThread) {
+        io_pool_ = std::make_unique<IoContextPool>(static_cast<size_t>(std::max(threads, 1)));
 
-    // Bind to port
-    acceptor_.bind(endpoint, ec);
-    if (ec) {
-        std::cerr << "Error binding to " << address << ":" << port << ": " << ec.message() << std::endl;
-        return;
+        if (io_model_.accept_mode == AcceptMode::ReusePort) {
+            if (!isReusePortSupported()) {
+                std::cerr << "SO_REUSEPORT not supported, falling back to round-robin accept" << std::endl;
+                io_model_.accept_mode = AcceptMode::RoundRobin;
+            } else {
+                // 每个 io_context 一个监听套接字
+                for (size_t i = 0; i < io_pool_->size(); ++i) {
+                    auto acceptor = std::make_unique<tcp::acceptor>(io_pool_->getIoContext(i));
+                    if (!openAcceptor(*acceptor, endpoint, true)) {
+                        reuse_port_acceptors_.clear();
+                        return;
+                    }
+                    reuse_port_acceptors_.push_back(std::move(acceptor));
+                }
+            }
+        }
     }
 
-    // Start listening
-    acceptor_.listen(net::socket_base::max_listen_connections, ec);
-    if (ec) {
-        std::cerr << "Error listening: " << ec.message() << std::endl;
+    if (reuse_port_acceptors_.empty() && !openAcceptor(acceptor_, endpoint, false)) {
         return;
     }
 
@@ -179,15 +382,35 @@ void HttpServer::run() {
     if (running_) return;
     running_ = true;
 
+    if (io_pool_) {
+        // 每线程一个 io_context：连接在所属线程上完成全部处理
+        io_pool_->run();
+
+        if (!reuse_port_acceptors_.empty()) {
+            for (size_t i = 0; i < reuse_port_acceptors_.size(); ++i) {
+                doAccept(*reuse_port_acceptors_[i], &io_pool_->getIoContext(i));
+            }
+        } else {
+            // 单个接收器在独立线程上运行，按轮询分配连接
+            doAccept(acceptor_, nullptr);
+            thread_pool_ = std::make_unique<ThreadPool>(1);
+            thread_pool_->post([this] { ioc_.run(); });
+        }
+
+        std::cout << "HTTP server running with " << io_pool_->size() << " io_context threads ("
+                  << (reuse_port_acceptors_.empty() ? "round-robin" : "reuseport") << " accept)" << std::endl;
+        return;
+    }
+
     // Initialize thread pool
     thread_pool_ = std::make_unique<ThreadPool>(num_threads_);
 
     // Start accepting connections
-    doAccept();
+    doAccept(acceptor_, nullptr);
 
     // Run IO context in thread pool, not blocking main thread
     for (int i = 0; i < num_threads_; ++i) {
-        thread_pool_->enqueue([this] { 
+        thread_pool_->post([this] { 
             // 直接在线程中运行io_context，不需要额外的strand
             // 因为io_context已经在构造函数中指定了线程数
             // 并且Boost.Asio会自动处理线程安全
@@ -203,12 +426,23 @@ void HttpServer::stop() {
     if (!running_) return;
     running_ = false;
 
+    // 关闭事件流连接
+    if (event_hub_) {
+        event_hub_->closeAll();
+    }
+
     // Stop acceptor
     beast::error_code ec;
     acceptor_.close(ec);
+    for (auto& acceptor : reuse_port_acceptors_) {
+        acceptor->close(ec);
+    }
 
     // Stop IO context
     ioc_.stop();
+    if (io_pool_) {
+        io_pool_->stop();
+    }
 
     // Destroy thread pool
     thread_pool_.reset();
@@ -218,42 +452,75 @@ void HttpServer::stop() {
 
 // Register route handler
 void HttpServer::registerHandler(const std::string& path, HttpRequestHandler handler) {
-    handlers_[path] = handler;
+    // 兼容旧接口：精确匹配路径，接受任意方法
+    router_.add(http::verb::unknown, path,
+        [handler = std::move(handler)](const http::request<http::string_body>& req, const RouteParams& params) {
+            return handler(req, std::string(params.path()));
+        });
     std::cout << "Registered handler for path: " << path << std::endl;
 }
 
+// Register route with method and pattern
+void HttpServer::addRoute(http::verb method, const std::string& pattern, RouteHandler handler) {
+    router_.add(method, pattern, std::move(handler));
+    std::cout << "Registered route: " << (method == http::verb::unknown ? "*" : std::string(http::to_string(method)))
+              << " " << pattern << std::endl;
+}
+
+// Register event stream path
+void HttpServer::addEventStream(const std::string& path, const EventStreamOptions& options) {
+    event_hub_ = std::make_shared<EventStreamHub>(options);
+    event_stream_path_ = path;
+    std::cout << "Registered event stream: GET " << path << std::endl;
+}
+
+// Publish event to all event stream subscribers
+void HttpServer::publishEvent(const SharedMessage& data) {
+    if (event_hub_) {
+        event_hub_->publish(data);
+    }
+}
+
+// Get event stream statistics
+EventStreamStats HttpServer::getEventStreamStats() const {
+    return event_hub_ ? event_hub_->getStats() : EventStreamStats();
+}
+
+// Enable static file serving
+void HttpServer::setStaticFiles(const StaticFileOptions& options) {
+    static_files_ = std::make_unique<StaticFileHandler>(options);
+    std::cout << "Serving static files from: " << static_files_->root() << std::endl;
+}
+
+// Select executor for a new connection
+net::any_io_executor HttpServer::sessionExecutor(net::io_context* pinned_context) {
+    if (pinned_context) {
+        return pinned_context->get_executor();
+    }
+    if (io_pool_) {
+        // 单线程运行的 io_context 不需要 strand
+        return io_pool_->getNextIoContext().get_executor();
+    }
+    return net::make_strand(ioc_);
+}
+
 // Accept new connection
-void HttpServer::doAccept() {
-    acceptor_.async_accept(
-        net::make_strand(ioc_),
+void HttpServer::doAccept(tcp::acceptor& acceptor, net::io_context* pinned_context) {
+    acceptor.async_accept(
+        sessionExecutor(pinned_context),
         beast::bind_front_handler(
-            [this](beast::error_code ec, tcp::socket socket) {
+            [this, &acceptor, pinned_context](beast::error_code ec, tcp::socket socket) {
                 if (!ec) {
                     // 创建一个新的会话来处理请求
                     std::make_shared<HttpSession>(
                         std::move(socket),
-                        [this](const http::request<http::string_body>& req, const std::string& target) {
-                            auto handler = findHandler(target);
-                            if (handler) {
-                                return handler(req, target);
-                            } else {
-                                // 默认404响应
-                                http::response<http::string_body> res(
-                                    http::status::not_found, req.version());
-                                res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-                                res.set(http::field::content_type, "text/plain");
-                                
-                                // 构建错误消息
-                                std::stringstream ss;
-                                ss << "The resource '" << target << "' was not found.";
-                                res.body() = ss.str();
-                                res.prepare_payload();
-                                return res;
-                            }
+                        [this](const http::request<http::string_body>& req) {
+                            return dispatch(req);
                         },
-                        [this](tcp::socket& socket, http::status status, const std::string& error_message) {
-                            sendErrorResponse(socket, status, error_message);
-                        }
+                        keep_alive_,
+                        body_limit_,
+                        event_hub_,
+                        event_stream_path_
                     )->run();
                 } else {
                     std::cerr << "Accept error: " << ec.message() << std::endl;
@@ -261,7 +528,7 @@ void HttpServer::doAccept() {
 
                 // If server is still running, continue accepting connections
                 if (running_) {
-                    doAccept();
+                    doAccept(acceptor, pinned_context);
                 }
             }));
 }
@@ -271,77 +538,85 @@ void HttpServer::handleRequest(tcp::socket socket) {
     // 创建会话并启动
     std::make_shared<HttpSession>(
         std::move(socket),
-        [this](const http::request<http::string_body>& req, const std::string& target) {
-            auto handler = findHandler(target);
-            if (handler) {
-                return handler(req, target);
-            } else {
-                // 默认404响应
-                http::response<http::string_body> res(
-                    http::status::not_found, req.version());
-                res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-                res.set(http::field::content_type, "text/plain");
-                
-                // 构建错误消息
-                std::stringstream ss;
-                ss << "The resource '" << target << "' was not found.";
-                res.body() = ss.str();
-                res.prepare_payload();
-                return res;
-            }
+        [this](const http::request<http::string_body>& req) {
+            return dispatch(req);
         },
-        [this](tcp::socket& socket, http::status status, const std::string& error_message) {
-            sendErrorResponse(socket, status, error_message);
-        }
+        keep_alive_,
+        body_limit_,
+        event_hub_,
+        event_stream_path_
     )->run();
 }
 
-// Find route handler
-HttpRequestHandler HttpServer::findHandler(const std::string& path) {
-    // Exact match
-    auto it = handlers_.find(path);
-    if (it != handlers_.end()) {
-        return it->second;
+// Dispatch request through the router
+SessionResponse HttpServer::dispatch(const http::request<http::string_body>& req) {
+    // 去掉查询串，匹配过程只使用请求目标的视图
+    auto target = req.target();
+    std::string_view path(target.data(), target.size());
+    path = path.substr(0, path.find('?'));
+
+    // 浏览器访问根路径时返回前端页面，API 客户端仍由路由处理
+    if (static_files_ && path == "/" &&
+        req[http::field::accept].find("text/html") != beast::string_view::npos) {
+        FileResponse file;
+        if (static_files_->serve(req, file)) {
+            return file;
+        }
     }
 
-    // Prefix match
-    for (const auto& [prefix, handler] : handlers_) {
-        if (path.find(prefix) == 0) {
-            return handler;
+    RouteParams params;
+    const std::string* allow = nullptr;
+    if (const RouteHandler* handler = router_.match(req.method(), path, params, &allow)) {
+        http::response<http::string_body> res = (*handler)(req, params);
+        compressResponse(req, res, compression_);
+        return res;
+    }
+
+    // 未匹配路由的 GET/HEAD 请求按静态文件处理
+    if (static_files_) {
+        FileResponse file;
+        if (static_files_->serve(req, file)) {
+            return file;
         }
     }
 
-    // 返回默认处理器而不是nullptr
-    return [](const http::request<http::string_body>& req, const std::string& target) {
-        http::response<http::string_body> res(http::status::not_found, req.version());
+    if (allow) {
+        // 路径存在但方法不匹配：OPTIONS 返回 CORS 预检响应，其他方法返回 405
+        bool preflight = req.method() == http::verb::options;
+        http::response<http::string_body> res(
+            preflight ? http::status::no_content : http::status::method_not_allowed, req.version());
         res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-        res.set(http::field::content_type, "text/plain");
+        res.set(http::field::allow, *allow);
         res.set(http::field::access_control_allow_origin, "*");
-        
-        std::stringstream ss;
-        ss << "The resource '" << target << "' was not found.";
-        res.body() = ss.str();
+        if (preflight) {
+            res.set(http::field::access_control_allow_methods, *allow);
+            res.set(http::field::access_control_allow_headers, "Content-Type");
+        } else {
+            res.set(http::field::content_type, "text/plain");
+            res.body() = "Method not allowed";
+        }
         res.prepare_payload();
         return res;
-    };
+    }
+
+    // 默认404响应
+    http::response<http::string_body> res(http::status::not_found, req.version());
+    res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+    res.set(http::field::content_type, "text/plain");
+    res.set(http::field::access_control_allow_origin, "*");
+
+    std::stringstream ss;
+    ss << "The resource '" << path << "' was not found.";
+    res.body() = ss.str();
+    res.prepare_payload();
+    return res;
 }
 
 // Send error response
 // Send error response
 void HttpServer::sendErrorResponse(tcp::socket& socket, http::status status, const std::string& error_message) {
     try {
-        http::response<http::string_body> res{status, 11}; // HTTP/1.1
-        res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-        res.set(http::field::content_type, "application/json");
-        res.set(http::field::access_control_allow_origin, "*");
-        
-        // Create JSON error response
-        std::stringstream ss;
-        ss << "{\"error\":\"" << status << "\",\"message\":\"" 
-           << error_message << "\"}";
-        
-        res.body() = ss.str();
-        res.prepare_payload();
+        http::response<http::string_body> res = makeErrorResponse(status, error_message); // HTTP/1.1
         
         // 使用异步写入，创建socket的共享指针以确保在异步操作期间socket不会被销毁
         auto socket_ptr = std::make_shared<tcp::socket>(std::move(socket));
@@ -0,0 +1,135 @@
+#include "io_context_pool.h"
+#include <cerrno>
+#include <iostream>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#endif
+
+namespace cesium_server {
+
+// 构造函数
+IoContextPool::IoContextPool(size_t pool_size) {
+    if (pool_size == 0) {
+        pool_size = 1;
+    }
+
+    contexts_.reserve(pool_size);
+    work_guards_.reserve(pool_size);
+    for (size_t i = 0; i < pool_size; ++i) {
+        // 每个 io_context 只由一个线程运行，提示 Asio 可以省去内部锁
+        contexts_.push_back(std::make_unique<net::io_context>(1));
+        // 没有连接时也保持 run() 不返回
+        work_guards_.push_back(net::make_work_guard(*contexts_.back()));
+    }
+}
+
+// 析构函数
+IoContextPool::~IoContextPool() {
+    stop();
+}
+
+// 启动所有 io_context
+void IoContextPool::run() {
+    if (thread_pool_) {
+        return;
+    }
+
+    thread_pool_ = std::make_unique<ThreadPool>(contexts_.size());
+    for (auto& context : contexts_) {
+        net::io_context* ioc = context.get();
+        thread_pool_->post([ioc] {
+            try {
+                ioc->run();
+            } catch (const std::exception& e) {
+                std::cerr << "IoContextPool run error: " << e.what() << std::endl;
+            }
+        });
+    }
+}
+
+// 停止所有 io_context
+void IoContextPool::stop() {
+    for (auto& guard : work_guards_) {
+        guard.reset();
+    }
+    for (auto& context : contexts_) {
+        context->stop();
+    }
+
+    // 等待线程退出
+    thread_pool_.reset();
+}
+
+// 按轮询获取下一个 io_context
+net::io_context& IoContextPool::getNextIoContext() {
+    size_t index = next_context_.fetch_add(1, std::memory_order_relaxed) % contexts_.size();
+    return *contexts_[index];
+}
+
+// 获取指定的 io_context
+net::io_context& IoContextPool::getIoContext(size_t index) {
+    return *contexts_[index % contexts_.size()];
+}
+
+// 当前平台是否支持 SO_REUSEPORT 分发连接
+bool isReusePortSupported() {
+#if defined(__linux__) && defined(SO_REUSEPORT)
+    return true;
+#else
+    // 其他平台的 SO_REUSEPORT 不做负载分发（或不存在），统一退回轮询
+    return false;
+#endif
+}
+
+// 打开、绑定并监听接收器
+bool openAcceptor(tcp::acceptor& acceptor, const tcp::endpoint& endpoint, bool reuse_port) {
+    boost::system::error_code ec;
+
+    // 打开接收器
+    acceptor.open(endpoint.protocol(), ec);
+    if (ec) {
+        std::cerr << "Error opening acceptor: " << ec.message() << std::endl;
+        return false;
+    }
+
+    // 允许地址重用
+    acceptor.set_option(net::socket_base::reuse_address(true), ec);
+    if (ec) {
+        std::cerr << "Error setting reuse_address: " << ec.message() << std::endl;
+        return false;
+    }
+
+#if defined(__linux__) && defined(SO_REUSEPORT)
+    // 多个接收器绑定同一端口，由内核按连接哈希分发
+    // Asio 没有公开的 SO_REUSEPORT 选项类型，直接在原生句柄上设置
+    if (reuse_port) {
+        int enable = 1;
+        if (::setsockopt(acceptor.native_handle(), SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0) {
+            ec = boost::system::error_code(errno, boost::system::system_category());
+            std::cerr << "Error setting SO_REUSEPORT: " << ec.message() << std::endl;
+            return false;
+        }
+    }
+#else
+    (void)reuse_port;
+#endif
+
+    // 绑定到端口
+    acceptor.bind(endpoint, ec);
+    if (ec) {
+        std::cerr << "Error binding to " << endpoint << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    // 开始监听
+    acceptor.listen(net::socket_base::max_listen_connections, ec);
+    if (ec) {
+        std::cerr << "Error listening: " << ec.message() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace cesium_server
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <string>
 #include <csignal>
+#include <algorithm>
 #include <thread>
 #include <chrono>
 
@@ -33,6 +34,137 @@ int main(int argc, char* argv[]) {
                 config.ws_address = argv[++i];
             } else if (arg == "--ws-port" && i + 1 < argc) {
                 config.ws_port = static_cast<unsigned short>(std::stoi(argv[++i]));
+            } else if (arg == "--ws-batch-bytes" && i + 1 < argc) {
+                config.ws_write_batch.enabled = true;
+                config.ws_write_batch.max_batch_bytes = std::stoul(argv[++i]);
+            } else if (arg == "--ws-batch-delay-ms" && i + 1 < argc) {
+                config.ws_write_batch.enabled = true;
+                config.ws_write_batch.max_delay = std::chrono::milliseconds(std::stoi(argv[++i]));
+            } else if (arg == "--ws-queue-max" && i + 1 < argc) {
+                config.ws_backpressure.max_queue_messages = std::stoul(argv[++i]);
+            } else if (arg == "--ws-overflow-policy" && i + 1 < argc) {
+                std::string policy = argv[++i];
+                if (policy == "drop-oldest") {
+                    config.ws_backpressure.policy = cesium_server::OverflowPolicy::DropOldest;
+                } else if (policy == "conflate") {
+                    config.ws_backpressure.policy = cesium_server::OverflowPolicy::ConflateByEntity;
+                } else {
+                    std::cerr << "Unknown overflow policy: " << policy << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--ws-deflate") {
+                config.ws_deflate.enabled = true;
+            } else if (arg == "--ws-deflate-level" && i + 1 < argc) {
+                config.ws_deflate.enabled = true;
+                config.ws_deflate.level = std::stoi(argv[++i]);
+            } else if (arg == "--ws-deflate-window-bits" && i + 1 < argc) {
+                int bits = std::stoi(argv[++i]);
+                if (bits < 9 || bits > 15) {
+                    std::cerr << "Invalid window bits: " << bits << std::endl;
+                    return 1;
+                }
+                config.ws_deflate.enabled = true;
+                config.ws_deflate.server_max_window_bits = bits;
+                config.ws_deflate.client_max_window_bits = bits;
+            } else if (arg == "--ws-deflate-mem-level" && i + 1 < argc) {
+                config.ws_deflate.enabled = true;
+                config.ws_deflate.mem_level = std::stoi(argv[++i]);
+            } else if (arg == "--ws-deflate-no-context-takeover") {
+                config.ws_deflate.enabled = true;
+                config.ws_deflate.server_no_context_takeover = true;
+                config.ws_deflate.client_no_context_takeover = true;
+            } else if (arg == "--ws-deflate-min" && i + 1 < argc) {
+                config.ws_deflate.enabled = true;
+                config.ws_deflate.min_size = std::stoul(argv[++i]);
+            } else if (arg == "--ws-snapshot-disable") {
+                config.ws_snapshot.enabled = false;
+            } else if (arg == "--ws-snapshot-chunk" && i + 1 < argc) {
+                config.ws_snapshot.chunk_tracks = std::stoul(argv[++i]);
+            } else if (arg == "--ws-snapshot-interval-ms" && i + 1 < argc) {
+                config.ws_snapshot.chunk_interval = std::chrono::milliseconds(std::stoi(argv[++i]));
+            } else if (arg == "--ws-snapshot-ttl" && i + 1 < argc) {
+                config.ws_snapshot.track_ttl = std::chrono::seconds(std::stoi(argv[++i]));
+            } else if (arg == "--http-threads" && i + 1 < argc) {
+                config.http_threads = std::stoi(argv[++i]);
+            } else if (arg == "--http-idle-timeout" && i + 1 < argc) {
+                config.http_keep_alive.idle_timeout = std::chrono::seconds(std::stoi(argv[++i]));
+            } else if (arg == "--http-write-timeout" && i + 1 < argc) {
+                config.http_keep_alive.write_timeout = std::chrono::seconds(std::stoi(argv[++i]));
+            } else if (arg == "--http-max-requests" && i + 1 < argc) {
+                config.http_keep_alive.max_requests = std::stoul(argv[++i]);
+            } else if (arg == "--http-body-limit" && i + 1 < argc) {
+                config.http_body_limit = std::stoull(argv[++i]);
+            } else if (arg == "--http-compress-level" && i + 1 < argc) {
+                int level = std::stoi(argv[++i]);
+                if (level < 0 || level > 9) {
+                    std::cerr << "Invalid compression level: " << level << std::endl;
+                    return 1;
+                }
+                config.http_compression.enabled = level > 0;
+                config.http_compression.level = level;
+            } else if (arg == "--http-compress-min" && i + 1 < argc) {
+                config.http_compression.min_size = std::stoul(argv[++i]);
+            } else if (arg == "--static-root" && i + 1 < argc) {
+                config.static_root = argv[++i];
+            } else if (arg == "--ws-threads" && i + 1 < argc) {
+                config.ws_threads = std::stoi(argv[++i]);
+            } else if (arg == "--io-model" && i + 1 < argc) {
+                std::string model = argv[++i];
+                if (model == "shared") {
+                    config.io_model.model = cesium_server::IoModel::Shared;
+                } else if (model == "per-thread") {
+                    config.io_model.model = cesium_server::IoModel::PerThread;
+                } else {
+                    std::cerr << "Unknown IO model: " << model << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--io-accept" && i + 1 < argc) {
+                std::string mode = argv[++i];
+                if (mode == "round-robin") {
+                    config.io_model.accept_mode = cesium_server::AcceptMode::RoundRobin;
+                } else if (mode == "reuseport") {
+                    config.io_model.accept_mode = cesium_server::AcceptMode::ReusePort;
+                } else {
+                    std::cerr << "Unknown accept mode: " << mode << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--udp-group" && i + 1 < argc) {
+                // <组播地址>[:<端口>][@<接口地址>]
+                std::string spec = argv[++i];
+                UdpGroupJoin join;
+                join.interface_address.clear();
+                size_t at = spec.find('@');
+                if (at != std::string::npos) {
+                    join.interface_address = spec.substr(at + 1);
+                    spec.resize(at);
+                }
+                size_t colon = spec.find(':');
+                if (colon != std::string::npos) {
+                    join.port = static_cast<unsigned short>(std::stoi(spec.substr(colon + 1)));
+                    spec.resize(colon);
+                }
+                join.group = spec;
+                config.udp_groups.push_back(join);
+            } else if (arg == "--udp-batch" && i + 1 < argc) {
+                config.udp_receive.batch_size = std::stoul(argv[++i]);
+            } else if (arg == "--udp-sockets" && i + 1 < argc) {
+                config.udp_receive.sockets = std::max<size_t>(std::stoul(argv[++i]), 1);
+            } else if (arg == "--udp-rcvbuf" && i + 1 < argc) {
+                config.udp_receive.socket_buffer_size = std::stoul(argv[++i]);
+            } else if (arg == "--udp-datagram-buffer" && i + 1 < argc) {
+                config.udp_buffer_size = std::max<size_t>(std::stoul(argv[++i]), 512);
+            } else if (arg == "--udp-workers" && i + 1 < argc) {
+                config.udp_receive.workers = std::stoul(argv[++i]);
+            } else if (arg == "--udp-queue-slots" && i + 1 < argc) {
+                config.udp_receive.queue_slots = std::max<size_t>(std::stoul(argv[++i]), 2);
+            } else if (arg == "--udp-max-datagram" && i + 1 < argc) {
+                config.udp_send.max_datagram_size = std::stoul(argv[++i]);
+            } else if (arg == "--udp-source-id" && i + 1 < argc) {
+                config.udp_send.source_id = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--udp-reorder-window" && i + 1 < argc) {
+                config.udp_feed.reorder_window = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--udp-reorder-timeout-ms" && i + 1 < argc) {
+                config.udp_feed.reorder_timeout = std::chrono::milliseconds(std::stoi(argv[++i]));
             } else if (arg == "--zmq-address" && i + 1 < argc) {
                 config.zmq_address = argv[++i];
             } else if (arg == "--zmq-port" && i + 1 < argc) {
@@ -58,6 +190,43 @@ int main(int argc, char* argv[]) {
                           << "  --http-port <port>        HTTP server port (default: 3000)\n"
                           << "  --ws-address <address>    WebSocket server address (default: 0.0.0.0)\n"
                           << "  --ws-port <port>          WebSocket server port (default: 3001)\n"
+                          << "  --ws-batch-bytes <n>      Enable write coalescing, max bytes per frame (default: 65536)\n"
+                          << "  --ws-batch-delay-ms <ms>  Enable write coalescing, max delay before flush (default: 0)\n"
+                          << "  --ws-queue-max <n>        Max queued messages per WebSocket session (default: 4096)\n"
+                          << "  --ws-overflow-policy <p>  Queue overflow policy (drop-oldest|conflate) (default: conflate)\n"
+                          << "  --ws-deflate              Negotiate permessage-deflate with WebSocket clients\n"
+                          << "  --ws-deflate-level <n>    permessage-deflate compression level 1-9 (default: 6)\n"
+                          << "  --ws-deflate-window-bits <n> Max sliding window bits 9-15 (default: 15)\n"
+                          << "  --ws-deflate-mem-level <n> Deflate memory level 1-9 (default: 4)\n"
+                          << "  --ws-deflate-no-context-takeover Reset the compression context for every message\n"
+                          << "  --ws-deflate-min <bytes>  Frames smaller than this are sent uncompressed (default: 256)\n"
+                          << "  --ws-snapshot-disable     Do not send the initial track snapshot to new WebSocket clients\n"
+                          << "  --ws-snapshot-chunk <n>   Tracks per snapshot chunk (default: 500)\n"
+                          << "  --ws-snapshot-interval-ms <ms> Min delay between snapshot chunks (default: 0)\n"
+                          << "  --ws-snapshot-ttl <s>     Only include tracks updated within this many seconds, 0 = all (default: 10)\n"
+                          << "  --http-threads <n>        HTTP server IO threads (default: 2)\n"
+                          << "  --http-idle-timeout <s>   Keep-alive idle timeout in seconds (default: 60)\n"
+                          << "  --http-write-timeout <s>  Max time to write one response (per chunk for files) (default: 30)\n"
+                          << "  --http-max-requests <n>   Max requests per keep-alive connection, 0 = unlimited (default: 1000)\n"
+                          << "  --http-body-limit <bytes> Max HTTP request body size (default: 16777216)\n"
+                          << "  --http-compress-level <n> gzip/deflate level for HTTP responses, 0 = off (default: 6)\n"
+                          << "  --http-compress-min <bytes> Min response size to compress (default: 1024)\n"
+                          << "  --static-root <dir>       Serve the built frontend (e.g. ../dist) from the HTTP server\n"
+                          << "  --ws-threads <n>          WebSocket server IO threads (default: 2)\n"
+                          << "  --io-model <m>            IO model (shared|per-thread) (default: shared)\n"
+                          << "  --io-accept <a>           Accept mode for per-thread model (round-robin|reuseport) (default: round-robin)\n"
+                          << "  --udp-group <group>[:<port>][@<interface>] Also join this multicast group, repeatable\n"
+                          << "                            (default port: UDP port, default interface: UDP listen address)\n"
+                          << "  --udp-batch <n>           Max datagrams per recvmmsg call on Linux, 0/1 = one per receive (default: 64)\n"
+                          << "  --udp-sockets <n>         SO_REUSEPORT receive threads on Linux, one socket per port each (default: 1)\n"
+                          << "  --udp-rcvbuf <bytes>      Kernel receive buffer (SO_RCVBUF) per UDP socket, 0 = system default (default: 4194304)\n"
+                          << "  --udp-datagram-buffer <bytes> Receive buffer per UDP datagram, larger datagrams are dropped (default: 8192)\n"
+                          << "  --udp-workers <n>         Decoder threads fed by lock-free queues, 0 = decode on the receive thread (default: 1)\n"
+                          << "  --udp-queue-slots <n>     Queue slots per UDP decoder thread (default: 2048)\n"
+                          << "  --udp-max-datagram <bytes> Max size of outgoing binary UDP track frames (default: 1472)\n"
+                          << "  --udp-source-id <n>       Source id written into outgoing binary UDP frames (default: 1)\n"
+                          << "  --udp-reorder-window <n>  Out-of-order binary UDP frames buffered per source, 0 = no reordering (default: 32)\n"
+                          << "  --udp-reorder-timeout-ms <ms> Max wait for a missing UDP frame before counting it lost (default: 50)\n"
                           << "  --zmq-address <address>   ZeroMQ server address (default: 0.0.0.0)\n"
                           << "  --zmq-port <port>         ZeroMQ server port (default: 5555)\n"
                           << "  --zmq-mode <mode>         ZeroMQ mode (req-rep|pub-sub|push-pull) (default: req-rep)\n"
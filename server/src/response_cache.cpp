@@ -0,0 +1,69 @@
+#include "response_cache.h"
+#include <cstdio>
+
+namespace cesium_server {
+
+namespace {
+
+// 进程启动标识：重启后版本号从头开始，ETag 不能与重启前的重复
+uint64_t bootId() {
+    static const uint64_t id = static_cast<uint64_t>(
+        std::chrono::system_clock::now().time_since_epoch().count());
+    return id;
+}
+
+} // namespace
+
+// 生成 ETag
+std::string ResponseCache::makeETag(uint64_t version, std::chrono::steady_clock::time_point now) const {
+    char buffer[64];
+    if (max_age_.count() == 0) {
+        std::snprintf(buffer, sizeof(buffer), "\"%llx-%llx\"",
+                      static_cast<unsigned long long>(bootId()),
+                      static_cast<unsigned long long>(version));
+    } else {
+        // 版本未变但按时重新生成的响应内容可能不同，加上生成时间区分
+        auto built = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+        std::snprintf(buffer, sizeof(buffer), "\"%llx-%llx-%llx\"",
+                      static_cast<unsigned long long>(bootId()),
+                      static_cast<unsigned long long>(version),
+                      static_cast<unsigned long long>(built));
+    }
+    return buffer;
+}
+
+// If-None-Match 是否与 ETag 匹配
+bool etagMatches(boost::beast::string_view if_none_match, const std::string& etag) {
+    size_t pos = 0;
+    while (pos < if_none_match.size()) {
+        size_t end = if_none_match.find(',', pos);
+        if (end == boost::beast::string_view::npos) {
+            end = if_none_match.size();
+        }
+
+        boost::beast::string_view candidate = if_none_match.substr(pos, end - pos);
+        pos = end + 1;
+
+        // 去掉首尾空白
+        while (!candidate.empty() && (candidate.front() == ' ' || candidate.front() == '\t')) {
+            candidate.remove_prefix(1);
+        }
+        while (!candidate.empty() && (candidate.back() == ' ' || candidate.back() == '\t')) {
+            candidate.remove_suffix(1);
+        }
+
+        if (candidate == "*") {
+            return true;
+        }
+        // If-None-Match 使用弱比较
+        if (candidate.size() > 2 && candidate[0] == 'W' && candidate[1] == '/') {
+            candidate.remove_prefix(2);
+        }
+        if (candidate == boost::beast::string_view(etag.data(), etag.size())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace cesium_server
@@ -0,0 +1,601 @@
+#include "static_files.h"
+#include "http_compression.h"
+#include "response_cache.h"
+#include <boost/beast/version.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+#endif
+
+namespace cesium_server {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 每次写操作发送的最大字节数（sendfile 单次调用或非 Linux 平台的读缓冲区大小）
+constexpr uint64_t kSendChunkSize = 512 * 1024;
+
+// 按扩展名确定 Content-Type
+const char* contentTypeFor(const std::string& path) {
+    static const std::unordered_map<std::string, const char*> kTypes = {
+        {".html", "text/html; charset=utf-8"},
+        {".htm", "text/html; charset=utf-8"},
+        {".js", "text/javascript; charset=utf-8"},
+        {".mjs", "text/javascript; charset=utf-8"},
+        {".css", "text/css; charset=utf-8"},
+        {".json", "application/json"},
+        {".map", "application/json"},
+        {".txt", "text/plain; charset=utf-8"},
+        {".xml", "application/xml"},
+        {".svg", "image/svg+xml"},
+        {".png", "image/png"},
+        {".jpg", "image/jpeg"},
+        {".jpeg", "image/jpeg"},
+        {".gif", "image/gif"},
+        {".webp", "image/webp"},
+        {".ico", "image/x-icon"},
+        {".ktx2", "image/ktx2"},
+        {".wasm", "application/wasm"},
+        {".woff", "font/woff"},
+        {".woff2", "font/woff2"},
+        {".ttf", "font/ttf"},
+        // Cesium 三维模型与瓦片
+        {".glb", "model/gltf-binary"},
+        {".gltf", "model/gltf+json"},
+        {".b3dm", "application/octet-stream"},
+        {".i3dm", "application/octet-stream"},
+        {".pnts", "application/octet-stream"},
+        {".cmpt", "application/octet-stream"},
+        {".terrain", "application/vnd.quantized-mesh"},
+        {".czml", "application/json"},
+        {".geojson", "application/geo+json"}
+    };
+
+    size_t slash = path.rfind('/');
+    size_t dot = path.rfind('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return "application/octet-stream";
+    }
+
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    auto it = kTypes.find(ext);
+    return it != kTypes.end() ? it->second : "application/octet-stream";
+}
+
+// 十六进制字符的值，非法时返回 -1
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// 解码请求路径（去掉查询串、百分号解码），拒绝越出根目录的路径
+bool decodePath(beast::string_view target, std::string& out) {
+    target = target.substr(0, target.find('?'));
+    if (target.empty() || target[0] != '/') {
+        return false;
+    }
+
+    out.clear();
+    out.reserve(target.size());
+    for (size_t i = 0; i < target.size(); ++i) {
+        char c = target[i];
+        if (c == '%') {
+            if (i + 2 >= target.size()) {
+                return false;
+            }
+            int high = hexValue(target[i + 1]);
+            int low = hexValue(target[i + 2]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            c = static_cast<char>(high * 16 + low);
+            i += 2;
+        }
+        if (c == '\0' || c == '\\') {
+            return false;
+        }
+        out.push_back(c);
+    }
+
+    // 拒绝 ".." 路径段
+    size_t pos = 0;
+    while (pos < out.size()) {
+        size_t end = out.find('/', pos + 1);
+        if (end == std::string::npos) {
+            end = out.size();
+        }
+        if (out.compare(pos, end - pos, "/..") == 0) {
+            return false;
+        }
+        pos = end;
+    }
+    return true;
+}
+
+// 区间请求解析结果
+enum class RangeResult {
+    None,           // 没有可用的区间（忽略 Range 头，返回完整内容）
+    Satisfiable,
+    Unsatisfiable
+};
+
+// 解析单区间 Range 头（bytes=a-b、bytes=a-、bytes=-n），多区间请求按无区间处理
+RangeResult parseRange(beast::string_view header, uint64_t size, uint64_t& first, uint64_t& last) {
+    if (header.substr(0, 6) != "bytes=") {
+        return RangeResult::None;
+    }
+    beast::string_view spec = header.substr(6);
+    if (spec.find(',') != beast::string_view::npos) {
+        return RangeResult::None;
+    }
+
+    size_t dash = spec.find('-');
+    if (dash == beast::string_view::npos) {
+        return RangeResult::None;
+    }
+
+    auto parseNumber = [](beast::string_view text, uint64_t& value) {
+        if (text.empty() || text.size() > 19) {
+            return false;
+        }
+        value = 0;
+        for (char c : text) {
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            value = value * 10 + static_cast<uint64_t>(c - '0');
+        }
+        return true;
+    };
+
+    beast::string_view start_text = spec.substr(0, dash);
+    beast::string_view end_text = spec.substr(dash + 1);
+
+    if (start_text.empty()) {
+        // 后缀区间：最后 n 个字节
+        uint64_t suffix = 0;
+        if (!parseNumber(end_text, suffix)) {
+            return RangeResult::None;
+        }
+        if (suffix == 0 || size == 0) {
+            return RangeResult::Unsatisfiable;
+        }
+        first = size - std::min(suffix, size);
+        last = size - 1;
+        return RangeResult::Satisfiable;
+    }
+
+    if (!parseNumber(start_text, first)) {
+        return RangeResult::None;
+    }
+    if (end_text.empty()) {
+        last = size == 0 ? 0 : size - 1;
+    } else if (!parseNumber(end_text, last) || last < first) {
+        return RangeResult::None;
+    }
+
+    if (first >= size) {
+        return RangeResult::Unsatisfiable;
+    }
+    last = std::min(last, size - 1);
+    return RangeResult::Satisfiable;
+}
+
+// 生成 ETag：文件大小 + 修改时间（+ 编码）
+std::string makeFileETag(uint64_t size, int64_t mtime, const char* encoding) {
+    char buffer[80];
+    std::snprintf(buffer, sizeof(buffer), "\"%llx-%llx%s%s\"",
+                  static_cast<unsigned long long>(size),
+                  static_cast<unsigned long long>(mtime),
+                  encoding ? "-" : "", encoding ? encoding : "");
+    return buffer;
+}
+
+// 读取文件大小和修改时间，不是普通文件时返回 false
+bool statFile(const std::string& path, uint64_t& size, int64_t& mtime) {
+    std::error_code ec;
+    fs::path p(path);
+    if (!fs::is_regular_file(p, ec) || ec) {
+        return false;
+    }
+    size = fs::file_size(p, ec);
+    if (ec) {
+        return false;
+    }
+    auto time = fs::last_write_time(p, ec);
+    mtime = ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+// 写出静态文件响应的异步操作
+class FileSendOp : public std::enable_shared_from_this<FileSendOp> {
+public:
+    FileSendOp(beast::tcp_stream& stream, FileResponse& res, std::chrono::steady_clock::duration timeout,
+               std::function<void(beast::error_code)> handler)
+        : stream_(stream),
+          res_(res),
+          handler_(std::move(handler)),
+          timeout_(timeout),
+#if defined(__linux__)
+          deadline_(stream.get_executor()),
+#endif
+          offset_(res.offset),
+          remaining_(res.length) {}
+
+    ~FileSendOp() {
+#if defined(__linux__)
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+#endif
+    }
+
+    void start() {
+        serializer_.emplace(res_.header);
+        stream_.expires_after(timeout_);
+        http::async_write_header(stream_, *serializer_,
+            beast::bind_front_handler(&FileSendOp::onHeader, shared_from_this()));
+    }
+
+private:
+    void onHeader(beast::error_code ec, std::size_t) {
+        if (ec || res_.path.empty() || remaining_ == 0) {
+            finish(ec);
+            return;
+        }
+
+#if defined(__linux__)
+        fd_ = ::open(res_.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            finish(beast::error_code(errno, boost::system::system_category()));
+            return;
+        }
+
+        // sendfile 在套接字缓冲区满时返回 EAGAIN，由 async_wait 等待可写
+        stream_.socket().native_non_blocking(true, ec);
+        if (ec) {
+            finish(ec);
+            return;
+        }
+        sendSome();
+#else
+        file_.open(res_.path.c_str(), beast::file_mode::scan, ec);
+        if (!ec) {
+            file_.seek(offset_, ec);
+        }
+        if (ec) {
+            finish(ec);
+            return;
+        }
+        buffer_.resize(static_cast<size_t>(std::min(remaining_, kSendChunkSize)));
+        readSome();
+#endif
+    }
+
+#if defined(__linux__)
+    // 零拷贝发送：文件内容由内核直接从页缓存写入套接字
+    void sendSome() {
+        uint64_t sent_this_turn = 0;
+        while (remaining_ > 0 && sent_this_turn < kSendChunkSize) {
+            off_t offset = static_cast<off_t>(offset_);
+            ssize_t n = ::sendfile(stream_.socket().native_handle(), fd_, &offset,
+                                   static_cast<size_t>(std::min(remaining_, kSendChunkSize - sent_this_turn)));
+            if (n > 0) {
+                offset_ += static_cast<uint64_t>(n);
+                remaining_ -= static_cast<uint64_t>(n);
+                sent_this_turn += static_cast<uint64_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            // n == 0：文件在发送过程中被截短
+            finish(n == 0 ? beast::error_code(net::error::eof)
+                          : beast::error_code(errno, boost::system::system_category()));
+            return;
+        }
+
+        if (remaining_ == 0) {
+            finish({});
+            return;
+        }
+
+        // 等待套接字可写；大文件每发送一段就让出线程，避免占住 I/O 线程
+        // 直接在套接字上等待不经过 tcp_stream 的定时器，每段单独设置期限
+        deadline_.expires_after(timeout_);
+        deadline_.async_wait(
+            [self = shared_from_this(), generation = ++deadline_generation_](beast::error_code ec) {
+                if (ec || generation != self->deadline_generation_) {
+                    return;
+                }
+                // 与 tcp_stream 超时的处理相同：关闭套接字，挂起的操作以错误完成
+                self->timed_out_ = true;
+                beast::error_code ignored;
+                self->stream_.socket().close(ignored);
+            });
+        stream_.socket().async_wait(net::ip::tcp::socket::wait_write,
+            [self = shared_from_this()](beast::error_code ec) {
+                ++self->deadline_generation_;
+                self->deadline_.cancel();
+                if (self->timed_out_) {
+                    ec = beast::error::timeout;
+                }
+                if (ec) {
+                    self->finish(ec);
+                    return;
+                }
+                self->sendSome();
+            });
+    }
+#else
+    // 分块读取文件后写出
+    void readSome() {
+        beast::error_code ec;
+        size_t n = file_.read(buffer_.data(), static_cast<size_t>(std::min<uint64_t>(remaining_, buffer_.size())), ec);
+        if (!ec && n == 0) {
+            ec = net::error::eof;
+        }
+        if (ec) {
+            finish(ec);
+            return;
+        }
+
+        remaining_ -= n;
+        stream_.expires_after(timeout_);
+        net::async_write(stream_, net::buffer(buffer_.data(), n),
+            [self = shared_from_this()](beast::error_code ec, std::size_t) {
+                if (ec || self->remaining_ == 0) {
+                    self->finish(ec);
+                    return;
+                }
+                self->readSome();
+            });
+    }
+#endif
+
+    void finish(beast::error_code ec) {
+        auto handler = std::move(handler_);
+        handler(ec);
+    }
+
+    beast::tcp_stream& stream_;
+    FileResponse& res_;
+    std::function<void(beast::error_code)> handler_;
+    std::chrono::steady_clock::duration timeout_;
+#if defined(__linux__)
+    net::steady_timer deadline_;            // 当前等待可写的期限
+    uint64_t deadline_generation_ = 0;      // 区分已过期的期限和当前期限
+    bool timed_out_ = false;
+#endif
+    std::optional<http::response_serializer<http::empty_body>> serializer_;
+    uint64_t offset_;
+    uint64_t remaining_;
+
+#if defined(__linux__)
+    int fd_ = -1;
+#else
+    beast::file file_;
+    std::vector<char> buffer_;
+#endif
+};
+
+} // namespace
+
+// 构造函数
+StaticFileHandler::StaticFileHandler(const StaticFileOptions& options)
+    : options_(options) {
+    // 去掉根目录末尾的分隔符，请求路径总是以 '/' 开头
+    while (options_.root.size() > 1 && (options_.root.back() == '/' || options_.root.back() == '\\')) {
+        options_.root.pop_back();
+    }
+}
+
+// 读取文件元数据
+std::shared_ptr<StaticFileHandler::FileInfo> StaticFileHandler::stat(const std::string& relative_path) const {
+    auto info = std::make_shared<FileInfo>();
+    info->checked_at = std::chrono::steady_clock::now();
+
+    std::string path = options_.root + relative_path;
+    int64_t mtime = 0;
+    if (!statFile(path, info->size, mtime)) {
+        return info;
+    }
+
+    info->exists = true;
+    info->etag = makeFileETag(info->size, mtime, nullptr);
+    info->content_type = contentTypeFor(relative_path);
+
+    // 预压缩版本（构建时生成，例如 vite-plugin-compression）
+    uint64_t variant_size = 0;
+    int64_t variant_mtime = 0;
+    if (statFile(path + ".br", variant_size, variant_mtime)) {
+        info->br_size = static_cast<int64_t>(variant_size);
+        info->br_etag = makeFileETag(variant_size, variant_mtime, "br");
+    }
+    if (statFile(path + ".gz", variant_size, variant_mtime)) {
+        info->gz_size = static_cast<int64_t>(variant_size);
+        info->gz_etag = makeFileETag(variant_size, variant_mtime, "gz");
+    }
+    return info;
+}
+
+// 获取文件元数据（带缓存）
+std::shared_ptr<const StaticFileHandler::FileInfo> StaticFileHandler::lookup(const std::string& relative_path) {
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = cache_.find(relative_path);
+        if (it != cache_.end() &&
+            (options_.metadata_ttl.count() == 0 || now - it->second->checked_at < options_.metadata_ttl)) {
+            return it->second;
+        }
+    }
+
+    // 在锁外访问文件系统
+    std::shared_ptr<const FileInfo> info = stat(relative_path);
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (cache_.size() >= options_.max_cached_entries) {
+        // 条目过多（例如被扫描不存在的路径）时整体清空
+        cache_.clear();
+    }
+    cache_[relative_path] = info;
+    return info;
+}
+
+// 处理 GET/HEAD 请求
+bool StaticFileHandler::serve(const http::request<http::string_body>& req, FileResponse& res) {
+    if (options_.root.empty() ||
+        (req.method() != http::verb::get && req.method() != http::verb::head)) {
+        return false;
+    }
+
+    std::string relative_path;
+    if (!decodePath(req.target(), relative_path)) {
+        return false;
+    }
+    if (relative_path.back() == '/') {
+        relative_path += options_.index;
+    }
+
+    auto info = lookup(relative_path);
+    if (!info->exists) {
+        size_t slash = relative_path.rfind('/');
+        bool has_extension = relative_path.find('.', slash) != std::string::npos;
+        if (has_extension) {
+            return false;
+        }
+
+        // 目录或前端路由
+        relative_path += "/" + options_.index;
+        info = lookup(relative_path);
+        if (!info->exists && options_.spa_fallback) {
+            relative_path = "/" + options_.index;
+            info = lookup(relative_path);
+        }
+        if (!info->exists) {
+            return false;
+        }
+    }
+
+    // 选择内容编码：区间请求只针对原始文件
+    auto range_header = req[http::field::range];
+    bool has_range = !range_header.empty() && req.method() == http::verb::get;
+    auto accept_encoding = req[http::field::accept_encoding];
+
+    const char* encoding = nullptr;
+    uint64_t size = info->size;
+    const std::string* etag = &info->etag;
+    if (!has_range) {
+        if (info->br_size >= 0 && acceptsEncoding(accept_encoding, "br")) {
+            encoding = "br";
+            size = static_cast<uint64_t>(info->br_size);
+            etag = &info->br_etag;
+        } else if (info->gz_size >= 0 && acceptsEncoding(accept_encoding, "gzip")) {
+            encoding = "gzip";
+            size = static_cast<uint64_t>(info->gz_size);
+            etag = &info->gz_etag;
+        }
+    }
+
+    auto& header = res.header;
+    header = {};
+    header.version(req.version());
+    header.keep_alive(req.keep_alive());
+    header.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+    header.set(http::field::content_type, info->content_type);
+    header.set(http::field::etag, *etag);
+    header.set(http::field::accept_ranges, "bytes");
+    header.set(http::field::access_control_allow_origin, "*");
+    if (!options_.immutable_prefix.empty() &&
+        relative_path.compare(0, options_.immutable_prefix.size(), options_.immutable_prefix) == 0) {
+        header.set(http::field::cache_control, "public, max-age=31536000, immutable");
+    } else {
+        header.set(http::field::cache_control, "no-cache");
+    }
+    if (info->br_size >= 0 || info->gz_size >= 0) {
+        header.set(http::field::vary, "Accept-Encoding");
+    }
+    if (encoding) {
+        header.set(http::field::content_encoding, encoding);
+    }
+
+    res.path.clear();
+    res.offset = 0;
+    res.length = 0;
+
+    // 条件请求
+    if (etagMatches(req[http::field::if_none_match], *etag)) {
+        header.result(http::status::not_modified);
+        header.erase(http::field::content_type);
+        return true;
+    }
+
+    std::string path = options_.root + relative_path;
+    if (encoding) {
+        path += encoding[0] == 'b' ? ".br" : ".gz";
+    }
+
+    uint64_t first = 0;
+    uint64_t last = 0;
+    RangeResult range = RangeResult::None;
+    if (has_range) {
+        // If-Range 与当前 ETag 不一致时文件已变化，返回完整内容
+        auto if_range = req[http::field::if_range];
+        if (if_range.empty() || if_range == beast::string_view(etag->data(), etag->size())) {
+            range = parseRange(range_header, size, first, last);
+        }
+    }
+
+    if (range == RangeResult::Unsatisfiable) {
+        header.result(http::status::range_not_satisfiable);
+        header.set(http::field::content_range, "bytes */" + std::to_string(size));
+        header.erase(http::field::content_type);
+        header.content_length(0);
+        return true;
+    }
+
+    if (range == RangeResult::Satisfiable) {
+        header.result(http::status::partial_content);
+        header.set(http::field::content_range,
+                   "bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" + std::to_string(size));
+        res.offset = first;
+        res.length = last - first + 1;
+    } else {
+        header.result(http::status::ok);
+        res.length = size;
+    }
+
+    header.content_length(res.length);
+    if (req.method() == http::verb::get) {
+        res.path = std::move(path);
+    }
+    return true;
+}
+
+// 写出静态文件响应
+void sendFileResponse(beast::tcp_stream& stream, FileResponse& res,
+                      std::chrono::steady_clock::duration timeout,
+                      std::function<void(beast::error_code)> handler) {
+    std::make_shared<FileSendOp>(stream, res, timeout, std::move(handler))->start();
+}
+
+} // namespace cesium_server
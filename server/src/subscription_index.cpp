@@ -0,0 +1,123 @@
+#include "subscription_index.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace cesium_server {
+
+// 构造函数
+SubscriptionIndex::SubscriptionIndex(double cell_size_degrees)
+    : cell_size_(cell_size_degrees > 0.0 ? cell_size_degrees : 10.0) {
+    columns_ = static_cast<int>(std::ceil(360.0 / cell_size_));
+    rows_ = static_cast<int>(std::ceil(180.0 / cell_size_));
+    cells_.resize(static_cast<size_t>(columns_) * rows_);
+}
+
+// 计算经度所在的网格列
+int SubscriptionIndex::columnOf(double longitude) const {
+    int column = static_cast<int>((longitude + 180.0) / cell_size_);
+    return std::clamp(column, 0, columns_ - 1);
+}
+
+// 计算纬度所在的网格行
+int SubscriptionIndex::rowOf(double latitude) const {
+    int row = static_cast<int>((latitude + 90.0) / cell_size_);
+    return std::clamp(row, 0, rows_ - 1);
+}
+
+// 遍历范围覆盖的网格
+template <typename Fn>
+void SubscriptionIndex::forEachCell(const GeoBounds& bounds, Fn&& fn) {
+    int row_begin = rowOf(bounds.south);
+    int row_end = rowOf(bounds.north);
+    int col_begin = columnOf(bounds.west);
+    int col_end = columnOf(bounds.east);
+
+    // 是否跨越 180° 经线由范围本身决定，不能看列号：west=175、east=172 落在同一列，却覆盖几乎整个经度范围
+    bool wraps = bounds.west > bounds.east;
+    if (wraps && col_end >= col_begin) {
+        // 两段在同一行内重叠，覆盖整行（每个网格只访问一次）
+        col_begin = 0;
+        col_end = columns_ - 1;
+        wraps = false;
+    }
+
+    for (int row = row_begin; row <= row_end; ++row) {
+        if (!wraps) {
+            for (int col = col_begin; col <= col_end; ++col) {
+                fn(cells_[static_cast<size_t>(row) * columns_ + col]);
+            }
+        } else {
+            // 跨越 180° 经线：分成两段
+            for (int col = col_begin; col < columns_; ++col) {
+                fn(cells_[static_cast<size_t>(row) * columns_ + col]);
+            }
+            for (int col = 0; col <= col_end; ++col) {
+                fn(cells_[static_cast<size_t>(row) * columns_ + col]);
+            }
+        }
+    }
+}
+
+// 从网格中移除会话
+void SubscriptionIndex::removeFromCells(uint64_t session_id, const GeoBounds& bounds) {
+    forEachCell(bounds, [session_id](std::vector<uint64_t>& cell) {
+        auto it = std::find(cell.begin(), cell.end(), session_id);
+        if (it != cell.end()) {
+            *it = cell.back();
+            cell.pop_back();
+        }
+    });
+}
+
+// 设置会话的订阅范围
+void SubscriptionIndex::subscribe(uint64_t session_id, const GeoBounds& bounds) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    auto it = bounds_.find(session_id);
+    if (it != bounds_.end()) {
+        removeFromCells(session_id, it->second);
+        it->second = bounds;
+    } else {
+        bounds_.emplace(session_id, bounds);
+    }
+
+    forEachCell(bounds, [session_id](std::vector<uint64_t>& cell) {
+        cell.push_back(session_id);
+    });
+}
+
+// 取消会话的订阅
+void SubscriptionIndex::unsubscribe(uint64_t session_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    auto it = bounds_.find(session_id);
+    if (it == bounds_.end()) {
+        return;
+    }
+
+    removeFromCells(session_id, it->second);
+    bounds_.erase(it);
+}
+
+// 查询视域包含该点的会话
+void SubscriptionIndex::query(double longitude, double latitude, std::vector<uint64_t>& out) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    const auto& cell = cells_[static_cast<size_t>(rowOf(latitude)) * columns_ + columnOf(longitude)];
+    for (uint64_t session_id : cell) {
+        // 网格只是粗筛，再用精确范围过滤
+        auto it = bounds_.find(session_id);
+        if (it != bounds_.end() && it->second.contains(longitude, latitude)) {
+            out.push_back(session_id);
+        }
+    }
+}
+
+// 获取订阅数量
+size_t SubscriptionIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return bounds_.size();
+}
+
+} // namespace cesium_server
@@ -0,0 +1,209 @@
+#include "track_codec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace cesium_server {
+namespace track_codec {
+
+namespace {
+
+// 小端序写入
+template <typename T>
+void putLE(std::string& out, T value) {
+    using U = std::make_unsigned_t<T>;
+    U bits = static_cast<U>(value);
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<char>((bits >> (i * 8)) & 0xFF));
+    }
+}
+
+// 小端序读取
+template <typename T>
+T getLE(const unsigned char* p) {
+    using U = std::make_unsigned_t<T>;
+    U bits = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        bits |= static_cast<U>(p[i]) << (i * 8);
+    }
+    return static_cast<T>(bits);
+}
+
+void putFloat(std::string& out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putLE(out, bits);
+}
+
+float getFloat(const unsigned char* p) {
+    uint32_t bits = getLE<uint32_t>(p);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// 写入长度前缀字符串（最长255字节）
+void putShortString(std::string& out, const std::string& value) {
+    size_t len = std::min<size_t>(value.size(), 0xFF);
+    out.push_back(static_cast<char>(len));
+    out.append(value, 0, len);
+}
+
+// 读取长度前缀字符串
+bool getShortString(const unsigned char*& p, const unsigned char* end, std::string& value) {
+    if (p >= end) {
+        return false;
+    }
+    size_t len = *p++;
+    if (static_cast<size_t>(end - p) < len) {
+        return false;
+    }
+    value.assign(reinterpret_cast<const char*>(p), len);
+    p += len;
+    return true;
+}
+
+// 角度量化为 1e-7 度
+int32_t quantizeDegrees(double degrees) {
+    return static_cast<int32_t>(std::lround(degrees * 1e7));
+}
+
+// 航向量化为 0.01 度，范围 [0, 360)
+uint16_t quantizeHeading(double heading) {
+    double normalized = std::fmod(heading, 360.0);
+    if (normalized < 0.0) {
+        normalized += 360.0;
+    }
+    return static_cast<uint16_t>(std::lround(normalized * 100.0) % 36000);
+}
+
+// 固定部分长度：lon + lat + alt + heading + timestamp
+constexpr size_t kFixedFieldsSize = 4 + 4 + 4 + 2 + 8;
+
+} // namespace
+
+// 追加帧头
+size_t beginFrame(std::string& out) {
+    size_t offset = out.size();
+    out.push_back(static_cast<char>(kMagic0));
+    out.push_back(static_cast<char>(kMagic1));
+    out.push_back(static_cast<char>(kVersion));
+    out.push_back(0);           // flags
+    putLE<uint16_t>(out, 0);    // record_count，结束时回填
+    putLE<uint16_t>(out, 0);    // reserved
+    return offset;
+}
+
+// 回填帧头中的记录数
+void endFrame(std::string& out, size_t header_offset, uint16_t record_count) {
+    out[header_offset + 4] = static_cast<char>(record_count & 0xFF);
+    out[header_offset + 5] = static_cast<char>(record_count >> 8);
+}
+
+// 追加一条记录
+void appendRecord(std::string& out, const Track& track) {
+    bool has_attributes = !track.ship_name.empty() || !track.ship_number.empty() ||
+                          !track.country.empty() || !track.ship_type.empty() || track.attr >= 0;
+
+    out.push_back(static_cast<char>(has_attributes ? kRecordHasAttributes : 0));
+    putShortString(out, track.id);
+    putLE<int32_t>(out, quantizeDegrees(track.longitude));
+    putLE<int32_t>(out, quantizeDegrees(track.latitude));
+    putFloat(out, static_cast<float>(track.altitude));
+    putLE<uint16_t>(out, quantizeHeading(track.heading));
+    putLE<int64_t>(out, track.timestamp);
+
+    if (has_attributes) {
+        putShortString(out, track.ship_name);
+        putShortString(out, track.ship_number);
+        putShortString(out, track.country);
+        putShortString(out, track.ship_type);
+        out.push_back(static_cast<char>(static_cast<int8_t>(track.attr)));
+    }
+}
+
+// 编码单条航迹为一帧
+std::string encode(const Track& track) {
+    std::string out;
+    out.reserve(kFrameHeaderSize + 2 + track.id.size() + kFixedFieldsSize);
+    size_t header = beginFrame(out);
+    appendRecord(out, track);
+    endFrame(out, header, 1);
+    return out;
+}
+
+// 编码多条航迹
+std::string encode(const std::vector<Track>& tracks) {
+    std::string out;
+    out.reserve(tracks.size() * (kFixedFieldsSize + 16) + kFrameHeaderSize);
+
+    size_t index = 0;
+    do {
+        size_t count = std::min(tracks.size() - index, kMaxRecordsPerFrame);
+        size_t header = beginFrame(out);
+        for (size_t i = 0; i < count; ++i) {
+            appendRecord(out, tracks[index + i]);
+        }
+        endFrame(out, header, static_cast<uint16_t>(count));
+        index += count;
+    } while (index < tracks.size());
+
+    return out;
+}
+
+// 读取一条记录
+bool readRecord(const unsigned char*& p, const unsigned char* end, Track& track) {
+    if (p >= end) {
+        return false;
+    }
+    uint8_t flags = *p++;
+    if (!getShortString(p, end, track.id) ||
+        static_cast<size_t>(end - p) < kFixedFieldsSize) {
+        return false;
+    }
+    track.longitude = getLE<int32_t>(p) / 1e7;
+    track.latitude = getLE<int32_t>(p + 4) / 1e7;
+    track.altitude = getFloat(p + 8);
+    track.heading = getLE<uint16_t>(p + 12) / 100.0;
+    track.timestamp = getLE<int64_t>(p + 14);
+    p += kFixedFieldsSize;
+
+    if (flags & kRecordHasAttributes) {
+        if (!getShortString(p, end, track.ship_name) ||
+            !getShortString(p, end, track.ship_number) ||
+            !getShortString(p, end, track.country) ||
+            !getShortString(p, end, track.ship_type) ||
+            p >= end) {
+            return false;
+        }
+        track.attr = static_cast<int8_t>(*p++);
+    }
+    return true;
+}
+
+// 解码一条消息中的所有帧
+bool decode(const char* data, size_t size, std::vector<Track>& out) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+
+    while (p < end) {
+        if (static_cast<size_t>(end - p) < kFrameHeaderSize ||
+            p[0] != kMagic0 || p[1] != kMagic1 || p[2] != kVersion) {
+            return false;
+        }
+        uint16_t count = getLE<uint16_t>(p + 4);
+        p += kFrameHeaderSize;
+
+        for (uint16_t i = 0; i < count; ++i) {
+            Track track;
+            if (!readRecord(p, end, track)) {
+                return false;
+            }
+            out.push_back(std::move(track));
+        }
+    }
+    return true;
+}
+
+} // namespace track_codec
+} // namespace cesium_server
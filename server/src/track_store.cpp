@@ -0,0 +1,337 @@
+#include "track_store.h"
+#include <utility>
+
+namespace cesium_server {
+
+// 构造函数
+TrackStore::TrackStore(size_t shard_count)
+    : size_(0) {
+    // 分片数取不小于请求值的2的幂，便于用掩码取模
+    size_t count = 1;
+    while (count < shard_count) {
+        count <<= 1;
+    }
+    shard_mask_ = count - 1;
+
+    shards_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+// 根据实体ID计算分片下标
+size_t TrackStore::shardIndex(const std::string& id) const {
+    return std::hash<std::string>{}(id) & shard_mask_;
+}
+
+// 根据实体ID定位分片
+TrackStore::Shard& TrackStore::shardFor(const std::string& id) const {
+    return *shards_[shardIndex(id)];
+}
+
+// 当前时间
+int64_t TrackStore::nowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 插入或更新航迹
+bool TrackStore::upsert(const Track& track, uint64_t* seq, Track* stored) {
+    int64_t now = nowMillis();
+    Shard& shard = shardFor(track.id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // 在分片锁内分配序号，保证读取序号后再遍历的一方能看到该更新
+    uint64_t update_seq = sequence_.fetch_add(1) + 1;
+    if (seq) {
+        *seq = update_seq;
+    }
+
+    auto it = shard.index.find(track.id);
+    if (it != shard.index.end()) {
+        shard.write(it->second, track, update_seq, now);
+        if (stored) {
+            shard.read(it->second, *stored);
+        }
+        shard.bump();
+        return false;
+    }
+
+    uint32_t row = shard.append(track, update_seq, now);
+    shard.index.emplace(track.id, row);
+    if (stored) {
+        shard.read(row, *stored);
+    }
+    shard.bump();
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// 批量插入或更新航迹
+size_t TrackStore::upsertBatch(const std::vector<Track>& tracks, std::vector<uint64_t>* seqs,
+                               std::vector<Track>* stored) {
+    // 计数排序：按分片分组，组内保持原顺序
+    std::vector<uint32_t> shard_of(tracks.size());
+    std::vector<uint32_t> offsets(shards_.size() + 1, 0);
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        shard_of[i] = static_cast<uint32_t>(shardIndex(tracks[i].id));
+        ++offsets[shard_of[i] + 1];
+    }
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        offsets[s + 1] += offsets[s];
+    }
+
+    std::vector<uint32_t> order(tracks.size());
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        order[cursor[shard_of[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    if (seqs) {
+        seqs->assign(tracks.size(), 0);
+    }
+    if (stored) {
+        stored->assign(tracks.size(), Track());
+    }
+
+    int64_t now = nowMillis();
+    size_t inserted = 0;
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        if (offsets[s] == offsets[s + 1]) {
+            continue;
+        }
+
+        Shard& shard = *shards_[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        // 一次为该分片的所有更新分配连续的序号
+        uint32_t count = offsets[s + 1] - offsets[s];
+        uint64_t update_seq = sequence_.fetch_add(count) + 1;
+        for (uint32_t k = offsets[s]; k < offsets[s + 1]; ++k, ++update_seq) {
+            const Track& track = tracks[order[k]];
+            if (seqs) {
+                (*seqs)[order[k]] = update_seq;
+            }
+            auto it = shard.index.find(track.id);
+            uint32_t row;
+            if (it != shard.index.end()) {
+                row = it->second;
+                shard.write(row, track, update_seq, now);
+            } else {
+                row = shard.append(track, update_seq, now);
+                shard.index.emplace(track.id, row);
+                ++inserted;
+            }
+            // 同一ID出现多次时，每条返回的都是写入该条之后的行
+            if (stored) {
+                shard.read(row, (*stored)[order[k]]);
+            }
+        }
+        shard.bump();
+    }
+
+    size_.fetch_add(inserted, std::memory_order_relaxed);
+    return inserted;
+}
+
+// 获取数据版本号
+uint64_t TrackStore::generation() const {
+    // 各分片版本号单调递增，其和也单调递增，任一分片变化都会改变结果
+    uint64_t generation = 0;
+    for (const auto& shard : shards_) {
+        generation += shard->generation.load(std::memory_order_acquire);
+    }
+    return generation;
+}
+
+// 按ID读取航迹
+bool TrackStore::get(const std::string& id, Track& out) const {
+    Shard& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(id);
+    if (it == shard.index.end()) {
+        return false;
+    }
+
+    shard.read(it->second, out);
+    return true;
+}
+
+// 删除航迹
+bool TrackStore::remove(const std::string& id) {
+    Shard& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(id);
+    if (it == shard.index.end()) {
+        return false;
+    }
+
+    uint32_t row = it->second;
+    shard.index.erase(it);
+
+    // 最后一行被移动到被删除的位置，需要修正其索引
+    uint32_t last = static_cast<uint32_t>(shard.id.size() - 1);
+    if (row != last) {
+        shard.index[shard.id[last]] = row;
+    }
+    shard.erase(row);
+
+    shard.bump();
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+// 遍历所有航迹
+void TrackStore::forEach(const std::function<void(const Track&)>& fn) const {
+    Track track;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (uint32_t row = 0; row < shard->id.size(); ++row) {
+            shard->read(row, track);
+            fn(track);
+        }
+    }
+}
+
+// 获取所有航迹的快照
+std::vector<Track> TrackStore::snapshot() const {
+    std::vector<Track> tracks;
+    tracks.reserve(size());
+    forEach([&tracks](const Track& track) {
+        tracks.push_back(track);
+    });
+    return tracks;
+}
+
+// 获取最近更新过的航迹的快照
+std::vector<Track> TrackStore::snapshot(std::chrono::milliseconds max_age) const {
+    if (max_age.count() <= 0) {
+        return snapshot();
+    }
+
+    int64_t cutoff = nowMillis() - max_age.count();
+    std::vector<Track> tracks;
+    tracks.reserve(size());
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (uint32_t row = 0; row < shard->id.size(); ++row) {
+            if (shard->updated_at[row] >= cutoff) {
+                tracks.emplace_back();
+                shard->read(row, tracks.back());
+            }
+        }
+    }
+    return tracks;
+}
+
+// 获取更新序号大于 seq 的航迹
+std::vector<Track> TrackStore::changedSince(uint64_t seq) const {
+    std::vector<Track> tracks;
+    if (seq >= sequence()) {
+        return tracks;
+    }
+
+    // 只扫描序号列，命中的行才读取完整数据
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (uint32_t row = 0; row < shard->seq.size(); ++row) {
+            if (shard->seq[row] > seq) {
+                tracks.emplace_back();
+                shard->read(row, tracks.back());
+            }
+        }
+    }
+    return tracks;
+}
+
+// 读取一行
+void TrackStore::Shard::read(uint32_t row, Track& out) const {
+    out.id = id[row];
+    out.longitude = longitude[row];
+    out.latitude = latitude[row];
+    out.altitude = altitude[row];
+    out.heading = heading[row];
+    out.timestamp = timestamp[row];
+    out.ship_name = ship_name[row];
+    out.ship_number = ship_number[row];
+    out.country = country[row];
+    out.ship_type = ship_type[row];
+    out.attr = attr[row];
+    out.seq = seq[row];
+}
+
+// 写入一行（静态属性为空时保留原值）
+void TrackStore::Shard::write(uint32_t row, const Track& track, uint64_t update_seq, int64_t now) {
+    longitude[row] = track.longitude;
+    latitude[row] = track.latitude;
+    altitude[row] = track.altitude;
+    heading[row] = track.heading;
+    timestamp[row] = track.timestamp;
+    seq[row] = update_seq;
+    updated_at[row] = now;
+
+    if (!track.ship_name.empty()) ship_name[row] = track.ship_name;
+    if (!track.ship_number.empty()) ship_number[row] = track.ship_number;
+    if (!track.country.empty()) country[row] = track.country;
+    if (!track.ship_type.empty()) ship_type[row] = track.ship_type;
+    if (track.attr >= 0) attr[row] = track.attr;
+}
+
+// 追加一行
+uint32_t TrackStore::Shard::append(const Track& track, uint64_t update_seq, int64_t now) {
+    uint32_t row = static_cast<uint32_t>(id.size());
+
+    id.push_back(track.id);
+    longitude.push_back(track.longitude);
+    latitude.push_back(track.latitude);
+    altitude.push_back(track.altitude);
+    heading.push_back(track.heading);
+    timestamp.push_back(track.timestamp);
+    seq.push_back(update_seq);
+    updated_at.push_back(now);
+    ship_name.push_back(track.ship_name);
+    ship_number.push_back(track.ship_number);
+    country.push_back(track.country);
+    ship_type.push_back(track.ship_type);
+    attr.push_back(track.attr);
+
+    return row;
+}
+
+// 删除一行（与最后一行交换后弹出，保持 O(1)）
+void TrackStore::Shard::erase(uint32_t row) {
+    size_t last = id.size() - 1;
+    if (row != last) {
+        id[row] = std::move(id[last]);
+        longitude[row] = longitude[last];
+        latitude[row] = latitude[last];
+        altitude[row] = altitude[last];
+        heading[row] = heading[last];
+        timestamp[row] = timestamp[last];
+        seq[row] = seq[last];
+        updated_at[row] = updated_at[last];
+        ship_name[row] = std::move(ship_name[last]);
+        ship_number[row] = std::move(ship_number[last]);
+        country[row] = std::move(country[last]);
+        ship_type[row] = std::move(ship_type[last]);
+        attr[row] = attr[last];
+    }
+
+    id.pop_back();
+    longitude.pop_back();
+    latitude.pop_back();
+    altitude.pop_back();
+    heading.pop_back();
+    timestamp.pop_back();
+    seq.pop_back();
+    updated_at.pop_back();
+    ship_name.pop_back();
+    ship_number.pop_back();
+    country.pop_back();
+    ship_type.pop_back();
+    attr.pop_back();
+}
+
+} // namespace cesium_server
@@ -0,0 +1,302 @@
+#include "udp_feed.h"
+#include "track_codec.h"
+#include <algorithm>
+#include <iterator>
+#include <thread>
+
+namespace cesium_server {
+
+namespace {
+
+// 序号回退超过该距离时视为数据源重启（重排窗口上限为 1024）
+constexpr uint32_t kRestartDistance = 4096;
+constexpr uint32_t kMaxReorderWindow = 1024;
+
+void putLE16(std::string& out, size_t offset, uint16_t value) {
+    out[offset] = static_cast<char>(value & 0xFF);
+    out[offset + 1] = static_cast<char>(value >> 8);
+}
+
+void putLE32(std::string& out, size_t offset, uint32_t value) {
+    for (size_t i = 0; i < 4; ++i) {
+        out[offset + i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+    }
+}
+
+uint16_t getLE16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t getLE32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+// 生效的重排窗口（按序号距离）
+uint32_t reorderWindow(const UdpFeedOptions& options) {
+    return std::min(options.reorder_window, kMaxReorderWindow);
+}
+
+// 槽位数取不小于重排窗口的最小 2 的幂，序号回绕时 sequence % size 仍然连续
+size_t windowSize(uint32_t reorder_window) {
+    if (reorder_window == 0) {
+        return 0;
+    }
+    size_t size = 1;
+    while (size < reorder_window) {
+        size <<= 1;
+    }
+    return size;
+}
+
+} // namespace
+
+namespace udp_frame {
+
+// 追加帧头
+size_t beginFrame(std::string& out, uint32_t source_id, uint32_t sequence) {
+    size_t offset = out.size();
+    out.resize(offset + kHeaderSize, '\0');
+    out[offset] = static_cast<char>(kMagic0);
+    out[offset + 1] = static_cast<char>(kMagic1);
+    out[offset + 2] = static_cast<char>(kVersion);
+    putLE32(out, offset + 8, source_id);
+    putLE32(out, offset + 12, sequence);
+    return offset;
+}
+
+// 回填帧头中的记录数
+void endFrame(std::string& out, size_t header_offset, uint16_t record_count) {
+    putLE16(out, header_offset + 4, record_count);
+}
+
+// 编码一帧
+std::string encode(uint32_t source_id, uint32_t sequence, const std::vector<Track>& tracks) {
+    std::string out;
+    size_t header = beginFrame(out, source_id, sequence);
+    for (const auto& track : tracks) {
+        track_codec::appendRecord(out, track);
+    }
+    endFrame(out, header, static_cast<uint16_t>(tracks.size()));
+    return out;
+}
+
+// 数据报是否为二进制 UDP 帧
+bool isFrame(const char* data, size_t size) {
+    return size >= kHeaderSize &&
+           static_cast<uint8_t>(data[0]) == kMagic0 &&
+           static_cast<uint8_t>(data[1]) == kMagic1 &&
+           static_cast<uint8_t>(data[2]) == kVersion;
+}
+
+// 解码一帧
+bool decode(const char* data, size_t size, FrameHeader& header, std::vector<Track>& out) {
+    if (!isFrame(data, size)) {
+        return false;
+    }
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    header.record_count = getLE16(p + 4);
+    header.source_id = getLE32(p + 8);
+    header.sequence = getLE32(p + 12);
+    p += kHeaderSize;
+
+    size_t original_size = out.size();
+    for (uint16_t i = 0; i < header.record_count; ++i) {
+        Track track;
+        if (!track_codec::readRecord(p, end, track)) {
+            out.resize(original_size);
+            return false;
+        }
+        out.push_back(std::move(track));
+    }
+    // 帧尾多余字节视为格式错误（一个数据报只有一帧）
+    if (p != end) {
+        out.resize(original_size);
+        return false;
+    }
+    return true;
+}
+
+} // namespace udp_frame
+
+// 构造函数
+UdpFeedDecoder::UdpFeedDecoder(const UdpFeedOptions& options)
+    : options_(options) {
+}
+
+// 设置配置
+void UdpFeedDecoder::setOptions(const UdpFeedOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_ = options;
+    sources_.clear();
+}
+
+// 处理一个数据报
+bool UdpFeedDecoder::process(const char* data, size_t size, std::vector<Track>& out,
+                             std::chrono::steady_clock::time_point now) {
+    // 在锁外解码，锁内只做序号判断
+    thread_local std::vector<Track> tracks;
+    tracks.clear();
+    udp_frame::FrameHeader header;
+    bool valid = udp_frame::decode(data, size, header, tracks);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!valid) {
+        ++stats_.invalid;
+        return false;
+    }
+    ++stats_.frames;
+
+    auto it = sources_.find(header.source_id);
+    if (it == sources_.end()) {
+        Source& source = sources_[header.source_id];
+        source.window.resize(windowSize(reorderWindow(options_)));
+        source.owner = std::this_thread::get_id();
+        source.expected = header.sequence;
+        deliver(source, tracks, out);
+        return true;
+    }
+
+    Source& source = it->second;
+    source.owner = std::this_thread::get_id();
+    int32_t distance = static_cast<int32_t>(header.sequence - source.expected);
+
+    if (distance == 0) {
+        deliver(source, tracks, out);
+        drain(source, out);
+        return true;
+    }
+
+    if (distance < 0) {
+        uint32_t back = static_cast<uint32_t>(-static_cast<int64_t>(distance));
+        if (back > kRestartDistance) {
+            // 数据源重启后序号从头开始
+            ++stats_.restarts;
+            clearWindow(source);
+            source.expected = header.sequence;
+            source.history = 0;
+            deliver(source, tracks, out);
+            return true;
+        }
+        uint32_t bit = back - 1;
+        if (bit < 64 && ((source.history >> bit) & 1)) {
+            ++stats_.duplicates;
+        } else {
+            ++stats_.late;
+        }
+        return true;
+    }
+
+    // 槽位数向上取整到 2 的幂，可能大于重排窗口：按配置的窗口判断，不按槽位数
+    if (static_cast<uint32_t>(distance) < reorderWindow(options_)) {
+        size_t window = source.window.size();
+        Slot& slot = source.window[header.sequence % window];
+        if (slot.filled) {
+            ++stats_.duplicates;
+            return true;
+        }
+        slot.filled = true;
+        slot.sequence = header.sequence;
+        slot.tracks.swap(tracks);
+        if (source.pending++ == 0) {
+            source.gap_since = now;
+        } else if (now - source.gap_since >= options_.reorder_timeout) {
+            skipToPending(source, out);
+            source.gap_since = now;
+        }
+        return true;
+    }
+
+    // 超出重排窗口：先按序交付缓冲的帧，剩余缺口计为丢失
+    while (source.pending > 0) {
+        skipToPending(source, out);
+    }
+    skip(source, header.sequence - source.expected);
+    deliver(source, tracks, out);
+    return true;
+}
+
+// 交付等待超时的缓冲帧
+void UdpFeedDecoder::expire(std::vector<Track>& out, std::chrono::steady_clock::time_point now) {
+    std::thread::id self = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : sources_) {
+        Source& source = entry.second;
+        // 其他线程处理的数据源由该线程自己的定时调用负责，避免越过它的下一批数据交付
+        if (source.owner != self) {
+            continue;
+        }
+        if (source.pending > 0 && now - source.gap_since >= options_.reorder_timeout) {
+            skipToPending(source, out);
+            source.gap_since = now;
+        }
+    }
+}
+
+// 获取统计
+UdpFeedStats UdpFeedDecoder::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    UdpFeedStats stats = stats_;
+    stats.sources = sources_.size();
+    for (const auto& entry : sources_) {
+        stats.pending += entry.second.pending;
+    }
+    return stats;
+}
+
+// 交付一帧
+void UdpFeedDecoder::deliver(Source& source, std::vector<Track>& tracks, std::vector<Track>& out) {
+    stats_.records += tracks.size();
+    out.insert(out.end(), std::make_move_iterator(tracks.begin()), std::make_move_iterator(tracks.end()));
+    tracks.clear();
+    ++source.expected;
+    source.history = (source.history << 1) | 1;
+}
+
+// 跳过缺失序号
+void UdpFeedDecoder::skip(Source& source, uint32_t count) {
+    stats_.lost += count;
+    source.expected += count;
+    source.history = count >= 64 ? 0 : source.history << count;
+}
+
+// 交付连续的缓冲帧
+void UdpFeedDecoder::drain(Source& source, std::vector<Track>& out) {
+    size_t window = source.window.size();
+    while (source.pending > 0) {
+        Slot& slot = source.window[source.expected % window];
+        if (!slot.filled || slot.sequence != source.expected) {
+            break;
+        }
+        slot.filled = false;
+        --source.pending;
+        ++stats_.reordered;
+        deliver(source, slot.tracks, out);
+    }
+}
+
+// 跳到最早的缓冲帧
+void UdpFeedDecoder::skipToPending(Source& source, std::vector<Track>& out) {
+    size_t window = source.window.size();
+    for (uint32_t distance = 1; distance < window; ++distance) {
+        const Slot& slot = source.window[(source.expected + distance) % window];
+        if (slot.filled && slot.sequence == source.expected + distance) {
+            skip(source, distance);
+            drain(source, out);
+            return;
+        }
+    }
+    clearWindow(source);
+}
+
+// 清空缓冲
+void UdpFeedDecoder::clearWindow(Source& source) {
+    for (auto& slot : source.window) {
+        slot.filled = false;
+        slot.tracks.clear();
+    }
+    source.pending = 0;
+}
+
+} // namespace cesium_server
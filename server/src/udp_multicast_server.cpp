@@ -1,28 +1,43 @@
 #include "../include/udp_multicast_server.h"
+#include "../include/track_codec.h"
 #include <boost/asio.hpp>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <random>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#include <linux/sock_diag.h>
+#endif
 
 // Constructor
 UdpMulticastServer::UdpMulticastServer(const std::string& multicast_address, unsigned short port, const std::string& listen_address, size_t buffer_size)
-	:multicast_endpoint_(net::ip::make_address(multicast_address), port),
-	recv_buffer_(buffer_size),
-	socket_(net::make_strand(io_context_)),
+	:socket_(net::make_strand(io_context_)),
+	multicast_endpoint_(net::ip::make_address(multicast_address), port),
 	listen_address_(listen_address),
+	buffer_size_(buffer_size),
 	running_(false),
-	error_count_(0),
-	last_error_time_(std::chrono::steady_clock::now()),
-	sending_(false) {
+	next_datagram_(0),
+	next_sequence_(std::random_device{}()),
+	sending_(false),
+	sent_count_(0),
+	send_error_count_(0),
+	truncated_count_(0) {
 	try {
 		// 打印初始化信息
 		std::cout << "Initializing UDP Multicast Server..." << std::endl;
 		std::cout << "  Multicast address: " << multicast_address << std::endl;
 		std::cout << "  Listen address: " << listen_address << std::endl;
 		std::cout << "  Port: " << port << std::endl;
-		std::cout << "  Buffer size: " << buffer_size << " bytes" << std::endl;
+		std::cout << "  Datagram buffer size: " << buffer_size << " bytes" << std::endl;
 		
 		// 验证多播地址
 		net::ip::address addr = net::ip::make_address(multicast_address);
@@ -47,13 +62,8 @@ UdpMulticastServer::UdpMulticastServer(const std::string& multicast_address, uns
 			throw std::runtime_error("Failed to set reuse_address option: " + ec.message());
 		}
 		
-		// Set receive buffer size
-		socket_.set_option(boost::asio::socket_base::receive_buffer_size(buffer_size), ec);
-		if (ec) {
-			std::cerr << "Warning: Failed to set receive buffer size: " << ec.message() << std::endl;
-			// 非致命错误，继续执行
-		}
-		
+		// 内核接收缓冲区在 run() 时按 socket_buffer_size 设置，与数据报缓冲区大小无关
+
 		// Set send buffer size
 		socket_.set_option(boost::asio::socket_base::send_buffer_size(buffer_size), ec);
 		if (ec) {
@@ -123,6 +133,10 @@ UdpMulticastServer::UdpMulticastServer(const std::string& multicast_address, uns
 			// 非致命错误，继续执行
 		}
 
+		// 构造时的组为 0 号数据源，沿用监听地址作为加入组播组的接口
+		joins_.push_back(UdpGroupJoin{multicast_address, port, listen_address});
+		feeds_.push_back(multicast_endpoint_);
+
 		std::cout << "UDP Multicast Server successfully initialized on " << listen_address
 			<< ":" << port << " (group: " << multicast_address << ")" << std::endl;
 	}
@@ -162,21 +176,86 @@ void UdpMulticastServer::run() {
 	work_guard_ = std::make_unique<net::executor_work_guard<net::io_context::executor_type>>(
 		io_context_.get_executor());
 
-	// Start receiving messages
-	doReceive();
+	// Create receive sockets
+	createReceivers(receive_options_.sockets);
 
-	// Initialize thread pool
-	thread_pool_ = std::make_unique<ThreadPool>(1);
+	// Create decoder workers: the receive threads only copy datagrams into their rings
+	// (a slot never needs more than the largest UDP payload)
+	workers_.clear();
+	size_t slot_size = std::min<size_t>(buffer_size_, 65536);
+	for (size_t i = 0; i < receive_options_.workers; ++i) {
+		auto worker = std::make_unique<DispatchWorker>();
+		worker->ring = std::make_unique<DatagramRing>(receive_options_.queue_slots, slot_size);
+		workers_.push_back(std::move(worker));
+	}
 
-	// Start IO context
-	thread_pool_->enqueue([this]() {
-		try {
-			io_context_.run();
+	// Start receiving messages
+	for (auto& receiver : receivers_) {
+		if (isBatchReceive()) {
+			prepareBatchBuffers(*receiver);
+			doReceiveBatch(*receiver);
+		} else {
+			doReceive(*receiver);
 		}
-		catch (const std::exception& e) {
-			std::cerr << "UDP Multicast Server IO error: " << e.what() << std::endl;
+	}
+	if (isBatchReceive()) {
+		std::cout << "UDP batched receive enabled (recvmmsg, batch size "
+			<< receivers_.front()->batch_datagrams.size() << ")" << std::endl;
+	}
+
+	// Start sampling kernel receive queues and rates
+	{
+		std::lock_guard<std::mutex> lock(stats_mutex_);
+		last_sample_time_ = std::chrono::steady_clock::now();
+		last_sample_packets_ = 0;
+		last_sample_bytes_ = 0;
+		last_sample_drops_ = truncated_count_;
+		queued_bytes_peak_ = 0;
+		packets_per_second_ = 0;
+		bytes_per_second_ = 0;
+		drops_per_second_ = 0;
+	}
+	for (auto& receiver : receivers_) {
+		receiver->stats_timer = std::make_unique<net::steady_timer>(receiver->socket->get_executor());
+		scheduleStatsSample(*receiver);
+	}
+
+	// Start periodic handlers on the receive threads when they call the handlers themselves
+	// (receivers are ordered by shard; one timer per receive thread)
+	if (tick_handler_ && workers_.empty()) {
+		for (size_t i = 0; i < receivers_.size(); ++i) {
+			Receiver& receiver = *receivers_[i];
+			if (i == 0 || receivers_[i - 1]->shard != receiver.shard) {
+				receiver.tick_timer = std::make_unique<net::steady_timer>(receiver.socket->get_executor());
+				scheduleTick(receiver);
+			}
 		}
-	});
+	}
+
+	// Initialize thread pool: one IO thread per receive shard plus the decoder workers
+	std::vector<net::io_context*> io_contexts{&io_context_};
+	for (auto& context : shard_contexts_) {
+		io_contexts.push_back(context.get());
+	}
+	thread_pool_ = std::make_unique<ThreadPool>(io_contexts.size() + workers_.size());
+
+	// Start decoder workers
+	for (auto& worker : workers_) {
+		DispatchWorker* w = worker.get();
+		thread_pool_->post([this, w]() { dispatchLoop(*w); });
+	}
+
+	// Start IO contexts
+	for (net::io_context* io_context : io_contexts) {
+		thread_pool_->post([io_context]() {
+			try {
+				io_context->run();
+			}
+			catch (const std::exception& e) {
+				std::cerr << "UDP Multicast Server IO error: " << e.what() << std::endl;
+			}
+		});
+	}
 
 	std::cout << "UDP Multicast Server running" << std::endl;
 }
@@ -192,6 +271,29 @@ void UdpMulticastServer::stop() {
 	// Remove work guard to allow io_context to exit
 	work_guard_.reset();
 
+	// Cancel stats timers and close additional sockets on their own executors
+	// (io_context_ keeps running until every pending operation on it has finished)
+	for (auto& receiver : receivers_) {
+		Receiver* r = receiver.get();
+		net::post(r->socket->get_executor(), [r]() {
+			if (r->stats_timer) {
+				r->stats_timer->cancel();
+			}
+			if (r->tick_timer) {
+				r->tick_timer->cancel();
+			}
+			if (r->owned_socket) {
+				boost::system::error_code ec;
+				r->owned_socket->close(ec);
+			}
+		});
+	}
+
+	// Stop the IO contexts of additional receive threads
+	for (auto& context : shard_contexts_) {
+		context->stop();
+	}
+
 	// Close socket
 	boost::system::error_code ec;
 	socket_.close(ec);
@@ -199,8 +301,19 @@ void UdpMulticastServer::stop() {
 		std::cerr << "Error closing socket: " << ec.message() << std::endl;
 	}
 
+	// Wake decoder workers so they observe running_ == false
+	for (auto& worker : workers_) {
+		std::lock_guard<std::mutex> lock(worker->mutex);
+		worker->cv.notify_all();
+	}
+
 	// Destroy thread pool
 	thread_pool_.reset();
+	workers_.clear();
+
+	// Destroy additional receive sockets (their IO threads have exited)
+	receivers_.clear();
+	shard_contexts_.clear();
 
 	// Reset io_context
 	io_context_.stop();
@@ -209,97 +322,202 @@ void UdpMulticastServer::stop() {
 	// Clear send queue
 	{
 		std::lock_guard<std::mutex> lock(mutex_);
-		std::queue<std::string> empty;
-		std::swap(send_queue_, empty);
+		send_pending_.clear();
+		send_flushing_.clear();
+		next_datagram_ = 0;
+		sending_ = false;
 	}
 
 	std::cout << "UDP Multicast Server stopped" << std::endl;
 }
 
-// Send multicast message
 // Send multicast message
 void UdpMulticastServer::sendMessage(const std::string& message) {
-	if (!running_) {
+	if (!running_ || message.empty()) {
 		return;
 	}
 
-	// Add message to send queue
+	bool schedule;
 	{
 		std::lock_guard<std::mutex> lock(mutex_);
-		send_queue_.push(message);
+		// 先封口未完成的航迹帧，保持发送顺序与调用顺序一致
+		closeTrackFrame();
+		send_pending_.bytes.append(message);
+		send_pending_.ends.push_back(send_pending_.bytes.size());
+		schedule = scheduleSend();
 	}
-	
-	// If no send operation is in progress, start one
-	if (!sending_.exchange(true)) {
-		// Use strand to ensure thread safety
-		net::dispatch(net::make_strand(io_context_), [this]() {
-			try {
-				// Process next message in the send queue
-				std::shared_ptr<std::string> next_message = std::make_shared<std::string>();
-				{
-					std::lock_guard<std::mutex> lock(mutex_);
-					if (send_queue_.empty()) {
+	if (schedule) {
+		net::post(socket_.get_executor(), [this]() { doSend(); });
+	}
+}
+
+// Send track updates packed into binary frames
+void UdpMulticastServer::sendTracks(const std::vector<Track>& tracks) {
+	if (!running_ || tracks.empty()) {
+		return;
+	}
+
+	// 记录先编码到线程局部缓冲区，判断放得下再追加到当前帧
+	thread_local std::string record;
+	size_t max_size = std::max(send_options_.max_datagram_size, udp_frame::kHeaderSize + 1);
+
+	bool schedule;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		SendBuffer& pending = send_pending_;
+		for (const auto& track : tracks) {
+			record.clear();
+			track_codec::appendRecord(record, track);
+
+			if (pending.open_frame != std::string::npos &&
+				(pending.bytes.size() - pending.open_frame + record.size() > max_size ||
+				 pending.open_records == 0xFFFF)) {
+				closeTrackFrame();
+			}
+			if (pending.open_frame == std::string::npos) {
+				pending.open_frame = udp_frame::beginFrame(pending.bytes, send_options_.source_id, next_sequence_++);
+			}
+			// 超过上限的单条记录仍单独成帧发送（由 IP 层分片）
+			pending.bytes.append(record);
+			++pending.open_records;
+		}
+		schedule = scheduleSend();
+	}
+	if (schedule) {
+		net::post(socket_.get_executor(), [this]() { doSend(); });
+	}
+}
+
+// Close the open track frame
+void UdpMulticastServer::closeTrackFrame() {
+	if (send_pending_.open_frame == std::string::npos) {
+		return;
+	}
+	udp_frame::endFrame(send_pending_.bytes, send_pending_.open_frame, send_pending_.open_records);
+	send_pending_.ends.push_back(send_pending_.bytes.size());
+	send_pending_.open_frame = std::string::npos;
+	send_pending_.open_records = 0;
+}
+
+// Schedule the send task if not already scheduled
+bool UdpMulticastServer::scheduleSend() {
+	if (sending_) {
+		return false;
+	}
+	sending_ = true;
+	return true;
+}
+
+// Drain the send queue on the socket strand
+void UdpMulticastServer::doSend() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!running_ || send_pending_.empty()) {
+			sending_ = false;
+			return;
+		}
+		// 取走队列中的全部数据报（包括未封口的航迹帧），生产者继续写入交换回来的空缓冲区
+		closeTrackFrame();
+		send_flushing_.clear();
+		std::swap(send_pending_, send_flushing_);
+		next_datagram_ = 0;
+	}
+
+	sendFlushing();
+}
+
+// Send the datagrams taken from the queue
+void UdpMulticastServer::sendFlushing() {
+	const SendBuffer& batch = send_flushing_;
+	size_t total = batch.ends.size();
+
+#if defined(__linux__)
+	// 一次 sendmmsg 最多发送 64 个数据报
+	constexpr size_t kMaxSendBatch = 64;
+	if (send_headers_.empty()) {
+		send_headers_.resize(kMaxSendBatch);
+		send_iovecs_.resize(kMaxSendBatch);
+	}
+
+	while (running_ && next_datagram_ < total) {
+		size_t count = std::min(total - next_datagram_, kMaxSendBatch);
+		for (size_t i = 0; i < count; ++i) {
+			size_t index = next_datagram_ + i;
+			size_t begin = index == 0 ? 0 : batch.ends[index - 1];
+			send_iovecs_[i].iov_base = const_cast<char*>(batch.bytes.data() + begin);
+			send_iovecs_[i].iov_len = batch.ends[index] - begin;
+			msghdr& header = send_headers_[i].msg_hdr;
+			header = msghdr{};
+			header.msg_name = const_cast<sockaddr*>(multicast_endpoint_.data());
+			header.msg_namelen = static_cast<socklen_t>(multicast_endpoint_.size());
+			header.msg_iov = &send_iovecs_[i];
+			header.msg_iovlen = 1;
+		}
+
+		int sent = ::sendmmsg(socket_.native_handle(), send_headers_.data(), static_cast<unsigned int>(count), MSG_DONTWAIT);
+		if (sent < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				// 发送缓冲区已满：等待可写后从当前位置继续
+				socket_.async_wait(udp::socket::wait_write, [this](boost::system::error_code ec) {
+					if (ec) {
+						std::lock_guard<std::mutex> lock(mutex_);
 						sending_ = false;
 						return;
 					}
-					*next_message = std::move(send_queue_.front());
-					send_queue_.pop();
-				}
-				
-				// 打印发送信息
-				std::cout << "Sending to " << multicast_endpoint_.address().to_string() 
-					<< ":" << multicast_endpoint_.port() << ", message size: " 
-					<< next_message->size() << " bytes" << std::endl;
-				
-				// 检查多播地址是否有效
-				if (!multicast_endpoint_.address().is_multicast()) {
-					std::cerr << "Error: " << multicast_endpoint_.address().to_string() 
-						<< " is not a valid multicast address" << std::endl;
-					sending_ = false;
-					return;
-				}
-				
-				// Send message
-				boost::system::error_code ec;
-				
-				// 尝试同步发送以获取立即的错误反馈
-				size_t bytes_sent = socket_.send_to(net::buffer(*next_message), multicast_endpoint_, 0, ec);
-				if (ec) {
-					std::cerr << "UDP Multicast send error (sync): " << ec.value() << " - " << ec.message() << std::endl;
-					
-					// 检查是否是网络不可达错误
-					if (ec == boost::asio::error::network_unreachable || 
-						ec == boost::asio::error::host_unreachable || 
-						ec == boost::asio::error::network_down) {
-						std::cerr << "Network location not found. Please check your network connection and multicast configuration." << std::endl;
-						
-						// 尝试重新加入多播组
-						std::cout << "Attempting to rejoin multicast group..." << std::endl;
-						if (rejoinMulticastGroup()) {
-							// 重试发送
-							bytes_sent = socket_.send_to(net::buffer(*next_message), multicast_endpoint_, 0, ec);
-							if (ec) {
-								std::cerr << "UDP Multicast send error after rejoin: " << ec.message() << std::endl;
-							} else {
-								std::cout << "Successfully sent message after rejoin: " << bytes_sent << " bytes" << std::endl;
-							}
-						}
-					}
-				} else {
-					std::cout << "Successfully sent message: " << bytes_sent << " bytes" << std::endl;
-				}
-				
-				// 继续处理队列中的下一条消息
-				sending_ = false;
-				if (running_ && !send_queue_.empty()) {
-					sendMessage(""); // 触发处理队列中的下一条消息
-				}
+					sendFlushing();
+				});
+				return;
 			}
-			catch (const std::exception& e) {
-				std::cerr << "UDP Multicast send exception: " << e.what() << std::endl;
-				sending_ = false;
+			if (errno == EINTR) {
+				continue;
 			}
-		});
+			// 跳过出错的数据报，整批只记录一次错误
+			++send_error_count_;
+			handleSendError(boost::system::error_code(errno, boost::system::system_category()));
+			++next_datagram_;
+			continue;
+		}
+		sent_count_ += static_cast<uint64_t>(sent);
+		next_datagram_ += static_cast<size_t>(sent);
+	}
+#else
+	for (; running_ && next_datagram_ < total; ++next_datagram_) {
+		size_t begin = next_datagram_ == 0 ? 0 : batch.ends[next_datagram_ - 1];
+		boost::system::error_code ec;
+		socket_.send_to(net::buffer(batch.bytes.data() + begin, batch.ends[next_datagram_] - begin),
+			multicast_endpoint_, 0, ec);
+		if (ec) {
+			++send_error_count_;
+			handleSendError(ec);
+		} else {
+			++sent_count_;
+		}
+	}
+#endif
+
+	// 继续发送期间新入队的数据
+	net::post(socket_.get_executor(), [this]() { doSend(); });
+}
+
+// Handle send error
+void UdpMulticastServer::handleSendError(const boost::system::error_code& ec) {
+	// 持续失败时每秒最多打印和重试一次
+	auto now = std::chrono::steady_clock::now();
+	if (now - last_send_error_time_ < std::chrono::seconds(1)) {
+		return;
+	}
+	last_send_error_time_ = now;
+	std::cerr << "UDP Multicast send error: " << ec.value() << " - " << ec.message() << std::endl;
+
+	// 检查是否是网络不可达错误
+	if (ec == boost::asio::error::network_unreachable ||
+		ec == boost::asio::error::host_unreachable ||
+		ec == boost::asio::error::network_down) {
+		std::cerr << "Network location not found. Please check your network connection and multicast configuration." << std::endl;
+
+		// 尝试重新加入多播组
+		std::cout << "Attempting to rejoin multicast group..." << std::endl;
+		rejoinMulticastGroup();
 	}
 }
 
@@ -309,12 +527,38 @@ void UdpMulticastServer::setMessageHandler(UdpMessageHandler handler) {
 	message_handler_ = std::move(handler);
 }
 
+// Set batch message handler
+void UdpMulticastServer::setBatchHandler(UdpBatchHandler handler) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	batch_handler_ = std::move(handler);
+}
+
+// Set periodic handler
+void UdpMulticastServer::setTickHandler(UdpTickHandler handler, std::chrono::milliseconds interval) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	tick_handler_ = std::move(handler);
+	tick_interval_ = std::max(interval, std::chrono::milliseconds(1));
+}
+
+// Whether recvmmsg batching is used
+bool UdpMulticastServer::isBatchReceive() const {
+#if defined(__linux__)
+	return receive_options_.batch_size > 1;
+#else
+	return false;
+#endif
+}
+
 // Rejoin multicast group
-bool UdpMulticastServer::rejoinMulticastGroup() {
+bool UdpMulticastServer::rejoinMulticastGroup(size_t index) {
 	try {
+		udp::socket& socket = index == 0 ? socket_ : *receivers_[index]->socket;
+		size_t shard = index < receivers_.size() ? receivers_[index]->shard : 0;
+		unsigned short port = index < receivers_.size() ? receivers_[index]->port : multicast_endpoint_.port();
+
 		// Close and reopen socket
 		boost::system::error_code ec;
-		socket_.close(ec);
+		socket.close(ec);
 		if (ec) {
 			std::cerr << "Error closing socket for rejoin: " << ec.message() << std::endl;
 			return false;
@@ -324,31 +568,54 @@ bool UdpMulticastServer::rejoinMulticastGroup() {
 		std::cout << "Network interface information:" << std::endl;
 		std::cout << "  Listen address: " << listen_address_ << std::endl;
 		std::cout << "  Multicast address: " << multicast_endpoint_.address().to_string() << std::endl;
-		std::cout << "  Port: " << multicast_endpoint_.port() << std::endl;
+		std::cout << "  Port: " << port << std::endl;
 		
+		if (!openSocket(socket, shard, port)) {
+			return false;
+		}
+		if (index < receivers_.size()) {
+			receivers_[index]->socket_drops = 0;
+		}
+
+		std::cout << "Successfully rejoined multicast group" << std::endl;
+		return true;
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Error rejoining multicast group: " << e.what() << std::endl;
+		return false;
+	}
+}
+
+// Open socket, set options, bind and join the multicast groups of a port
+bool UdpMulticastServer::openSocket(udp::socket& socket, size_t shard, unsigned short port) {
+	try {
+		boost::system::error_code ec;
+
 		// Reopen socket
-		socket_.open(udp::v4(), ec);
+		socket.open(udp::v4(), ec);
 		if (ec) {
 			std::cerr << "Error opening socket: " << ec.message() << std::endl;
 			return false;
 		}
 		
 		// Set socket options
-		socket_.set_option(udp::socket::reuse_address(true), ec);
+		socket.set_option(udp::socket::reuse_address(true), ec);
 		if (ec) {
 			std::cerr << "Error setting reuse_address option: " << ec.message() << std::endl;
 			return false;
 		}
-		
-		// Set receive buffer size
-		socket_.set_option(boost::asio::socket_base::receive_buffer_size(recv_buffer_.size()), ec);
-		if (ec) {
-			std::cerr << "Error setting receive buffer size: " << ec.message() << std::endl;
+
+		// 多套接字模式：加入 SO_REUSEPORT 组并按发送者分流
+		if (receive_options_.sockets > 1 && !applyReusePort(socket, shard, ec)) {
+			std::cerr << "Error setting SO_REUSEPORT: " << ec.message() << std::endl;
 			return false;
 		}
 		
+		// Set kernel receive buffer size
+		applySocketBufferSize(socket);
+		
 		// Set send buffer size
-		socket_.set_option(boost::asio::socket_base::send_buffer_size(recv_buffer_.size()), ec);
+		socket.set_option(boost::asio::socket_base::send_buffer_size(buffer_size_), ec);
 		if (ec) {
 			std::cerr << "Error setting send buffer size: " << ec.message() << std::endl;
 			return false;
@@ -356,15 +623,15 @@ bool UdpMulticastServer::rejoinMulticastGroup() {
 		
 		// Bind to specified port
 		try {
-			udp::endpoint bind_endpoint(net::ip::make_address(listen_address_), multicast_endpoint_.port());
+			udp::endpoint bind_endpoint(net::ip::make_address(listen_address_), port);
 			std::cout << "Binding to " << bind_endpoint.address().to_string() << ":" << bind_endpoint.port() << std::endl;
-			socket_.bind(bind_endpoint, ec);
+			socket.bind(bind_endpoint, ec);
 			if (ec) {
 				std::cerr << "Error binding socket: " << ec.message() << std::endl;
 				
 				// 尝试使用任意地址绑定
 				std::cout << "Trying to bind to any address (0.0.0.0)..." << std::endl;
-				socket_.bind(udp::endpoint(net::ip::address_v4::any(), multicast_endpoint_.port()), ec);
+				socket.bind(udp::endpoint(net::ip::address_v4::any(), port), ec);
 				if (ec) {
 					std::cerr << "Error binding to any address: " << ec.message() << std::endl;
 					return false;
@@ -376,28 +643,46 @@ bool UdpMulticastServer::rejoinMulticastGroup() {
 			return false;
 		}
 		
-		// Join multicast group
+		// Join the multicast groups of this port
 		try {
-			// 尝试使用特定网络接口加入多播组
-			if (listen_address_ != "0.0.0.0") {
-				std::cout << "Joining multicast group using specific interface: " << listen_address_ << std::endl;
-				net::ip::address listen_addr = net::ip::make_address(listen_address_);
-				net::ip::address multicast_addr = multicast_endpoint_.address();
-				
-				socket_.set_option(net::ip::multicast::join_group(
-					multicast_addr.to_v4(),
-					listen_addr.to_v4()), ec);
-			} else {
-				// 使用默认接口加入多播组
-				std::cout << "Joining multicast group using default interface" << std::endl;
-				socket_.set_option(net::ip::multicast::join_group(
-					multicast_endpoint_.address().to_v4()), ec);
+			size_t feeds = 0;
+			for (const auto& endpoint : feeds_) {
+				feeds += endpoint.port() == port ? 1 : 0;
 			}
-			
-			if (ec) {
-				std::cerr << "Error joining multicast group: " << ec.message() << std::endl;
-				return false;
+
+			for (const auto& join : joins_) {
+				if (join.port != port) {
+					continue;
+				}
+				net::ip::address_v4 multicast_addr = net::ip::make_address_v4(join.group);
+
+				// 尝试使用特定网络接口加入多播组
+				if (join.interface_address != "0.0.0.0") {
+					std::cout << "Joining multicast group " << join.group << " using specific interface: " << join.interface_address << std::endl;
+					socket.set_option(net::ip::multicast::join_group(
+						multicast_addr,
+						net::ip::make_address_v4(join.interface_address)), ec);
+				} else {
+					// 使用默认接口加入多播组
+					std::cout << "Joining multicast group " << join.group << " using default interface" << std::endl;
+					socket.set_option(net::ip::multicast::join_group(multicast_addr), ec);
+				}
+
+				if (ec) {
+					std::cerr << "Error joining multicast group " << join.group << ": " << ec.message() << std::endl;
+					return false;
+				}
 			}
+
+#if defined(__linux__)
+			// 同一端口上有多个组时，接收时取回目的地址以区分数据源
+			if (feeds > 1) {
+				int enable = 1;
+				if (::setsockopt(socket.native_handle(), IPPROTO_IP, IP_PKTINFO, &enable, sizeof(enable)) != 0) {
+					std::cerr << "Warning: Failed to enable IP_PKTINFO: " << std::strerror(errno) << std::endl;
+				}
+			}
+#endif
 		}
 		catch (const std::exception& e) {
 			std::cerr << "Exception joining multicast group: " << e.what() << std::endl;
@@ -405,84 +690,657 @@ bool UdpMulticastServer::rejoinMulticastGroup() {
 		}
 		
 		// Set multicast TTL
-		socket_.set_option(net::ip::multicast::hops(1), ec);
+		socket.set_option(net::ip::multicast::hops(1), ec);
 		if (ec) {
 			std::cerr << "Error setting multicast TTL: " << ec.message() << std::endl;
 			return false;
 		}
 		
 		// 设置多播回环选项（允许在同一主机上接收自己发送的多播消息）
-		socket_.set_option(net::ip::multicast::enable_loopback(true), ec);
+		socket.set_option(net::ip::multicast::enable_loopback(true), ec);
 		if (ec) {
 			std::cerr << "Error setting multicast loopback option: " << ec.message() << std::endl;
 			// 这不是致命错误，可以继续
 		}
 		
-		std::cout << "Successfully rejoined multicast group" << std::endl;
 		return true;
 	}
 	catch (const std::exception& e) {
-		std::cerr << "Error rejoining multicast group: " << e.what() << std::endl;
+		std::cerr << "Error setting up multicast socket: " << e.what() << std::endl;
 		return false;
 	}
 }
 
+// Add a multicast group
+size_t UdpMulticastServer::addGroup(const UdpGroupJoin& join) {
+	net::ip::address group = net::ip::make_address(join.group);
+	if (!group.is_v4() || !group.is_multicast()) {
+		throw std::invalid_argument("Invalid multicast address: " + join.group);
+	}
+	net::ip::make_address_v4(join.interface_address);
+	udp::endpoint endpoint(group, join.port);
+
+	bool joined = false;
+	for (const auto& existing : joins_) {
+		if (net::ip::make_address(existing.group) == group && existing.port == join.port &&
+			net::ip::make_address(existing.interface_address) == net::ip::make_address(join.interface_address)) {
+			joined = true;
+		}
+	}
+	if (!joined) {
+		joins_.push_back(join);
+	}
+
+	auto it = std::find(feeds_.begin(), feeds_.end(), endpoint);
+	if (it != feeds_.end()) {
+		return static_cast<size_t>(it - feeds_.begin());
+	}
+	feeds_.push_back(endpoint);
+	return feeds_.size() - 1;
+}
+
+// Get the feed of a datagram by destination address
+size_t UdpMulticastServer::feedOf(const Receiver& receiver, uint32_t destination) const {
+	for (const auto& feed : receiver.feeds) {
+		if (feed.first == destination) {
+			return feed.second;
+		}
+	}
+	// 单播或未知的目的地址归入该端口的第一个组
+	return receiver.feeds.front().second;
+}
+
+// Create receive sockets
+void UdpMulticastServer::createReceivers(size_t count) {
+	receivers_.clear();
+	shard_contexts_.clear();
+
+#if !(defined(__linux__) && defined(SO_REUSEPORT))
+	if (count > 1) {
+		std::cerr << "Multiple UDP receive sockets require SO_REUSEPORT on Linux, using a single receive socket" << std::endl;
+		receive_options_.sockets = 1;
+		count = 1;
+	}
+#endif
+
+	// 需要接收的端口，主套接字的端口在前
+	std::vector<unsigned short> ports;
+	for (const auto& join : joins_) {
+		if (std::find(ports.begin(), ports.end(), join.port) == ports.end()) {
+			ports.push_back(join.port);
+		}
+	}
+
+	// 主套接字在构造时只加入了主组播组：多线程（加入 SO_REUSEPORT 组）、多个组播组或 stop() 之后重新打开
+	boost::system::error_code ec;
+	if (count > 1 || joins_.size() > 1 || !socket_.is_open()) {
+		socket_.close(ec);
+		if (!openSocket(socket_, 0, ports.front())) {
+			if (count > 1) {
+				std::cerr << "Failed to reopen UDP socket with SO_REUSEPORT, using a single receive socket" << std::endl;
+				receive_options_.sockets = 1;
+				socket_.close(ec);
+				createReceivers(1);
+				return;
+			}
+			throw std::runtime_error("Failed to reopen UDP multicast socket");
+		}
+	}
+
+	// 每个接收线程在每个端口上一个套接字，由该线程的 io_context 统一等待
+	for (size_t shard = 0; shard < count; ++shard) {
+		net::io_context* io_context = &io_context_;
+		if (shard > 0) {
+			shard_contexts_.push_back(std::make_unique<net::io_context>(1));
+			io_context = shard_contexts_.back().get();
+		}
+
+		for (unsigned short port : ports) {
+			auto receiver = std::make_unique<Receiver>();
+			receiver->index = receivers_.size();
+			receiver->shard = shard;
+			receiver->port = port;
+			receiver->io_context = io_context;
+			if (shard == 0 && port == ports.front()) {
+				receiver->socket = &socket_;
+			} else {
+				receiver->owned_socket = std::make_unique<udp::socket>(*io_context);
+				receiver->socket = receiver->owned_socket.get();
+				if (!openSocket(*receiver->socket, shard, port)) {
+					if (count > 1) {
+						// 过滤器按线程数取模分流，缺少的套接字会丢失对应的发送者，因此整体退回单线程
+						std::cerr << "Failed to open UDP receive socket on port " << port << " for receive thread " << shard
+							<< ", using a single receive thread" << std::endl;
+						receive_options_.sockets = 1;
+						socket_.close(ec);
+						createReceivers(1);
+						return;
+					}
+					throw std::runtime_error("Failed to open UDP receive socket on port " + std::to_string(port));
+				}
+			}
+
+			for (size_t feed = 0; feed < feeds_.size(); ++feed) {
+				if (feeds_[feed].port() == port) {
+					receiver->feeds.emplace_back(feeds_[feed].address().to_v4().to_uint(), feed);
+				}
+			}
+			receivers_.push_back(std::move(receiver));
+		}
+	}
+
+	size_t socket_buffer_size = 0;
+	for (auto& receiver : receivers_) {
+		receiver->recv_buffer.assign(buffer_size_, 0);
+		receiver->last_error_time = std::chrono::steady_clock::now();
+		receiver->socket_buffer_size = applySocketBufferSize(*receiver->socket);
+		socket_buffer_size = receiver->socket_buffer_size;
+	}
+
+	// 请求值超过 net.core.rmem_max 时被内核截断
+	std::cout << "UDP receive buffers: " << buffer_size_ << " bytes per datagram, "
+		<< socket_buffer_size << " bytes kernel buffer per socket" << std::endl;
+	if (socket_buffer_size < receive_options_.socket_buffer_size) {
+		std::cerr << "Warning: Kernel receive buffer is smaller than the requested "
+			<< receive_options_.socket_buffer_size << " bytes (check net.core.rmem_max)" << std::endl;
+	}
+
+	if (count > 1) {
+		std::cout << "UDP multicast receive using " << count
+			<< " SO_REUSEPORT IO threads, one socket per port each" << std::endl;
+	}
+	if (feeds_.size() > 1) {
+		std::cout << "UDP multicast receive " << feeds_.size() << " groups on " << ports.size()
+			<< " ports, " << receivers_.size() << " sockets in total" << std::endl;
+	}
+}
+
+// Set SO_REUSEPORT and the per-sender steering filter
+bool UdpMulticastServer::applyReusePort(udp::socket& socket, size_t shard, boost::system::error_code& ec) {
+#if defined(__linux__) && defined(SO_REUSEPORT)
+	// Asio 没有公开的 SO_REUSEPORT 选项类型，直接在原生句柄上设置
+	int enable = 1;
+	if (::setsockopt(socket.native_handle(), SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0) {
+		ec = boost::system::error_code(errno, boost::system::system_category());
+		return false;
+	}
+
+	// 内核只对单播做 SO_REUSEPORT 负载分发，组播数据报会复制给组内每个套接字。
+	// 用 BPF 过滤器让每个套接字只接收 hash(源地址, 源端口) % sockets == shard（接收线程编号）的组播数据报，
+	// 其余的在内核中丢弃；同一发送者的数据报总是由同一个线程按序处理。单播数据报不过滤。
+	uint32_t sockets = static_cast<uint32_t>(receive_options_.sockets);
+	sock_filter code[] = {
+		BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_NET_OFF + 16)),		// 目的地址
+		BPF_STMT(BPF_ALU | BPF_AND | BPF_K, 0xf0000000),
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0xe0000000, 0, 8),		// 非组播：接收
+		BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_NET_OFF + 12)),		// 源地址
+		BPF_STMT(BPF_MISC | BPF_TAX, 0),
+		BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 0),						// UDP 源端口
+		BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+		BPF_STMT(BPF_ALU | BPF_MUL | BPF_K, 2654435761u),			// 乘法散列，避免相邻端口落到同一套接字
+		BPF_STMT(BPF_ALU | BPF_RSH | BPF_K, 16),
+		BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, sockets),
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(shard), 0, 1),
+		BPF_STMT(BPF_RET | BPF_K, 0xffffffff),						// 接收
+		BPF_STMT(BPF_RET | BPF_K, 0),								// 丢弃
+	};
+	sock_fprog program{static_cast<unsigned short>(sizeof(code) / sizeof(code[0])), code};
+	if (::setsockopt(socket.native_handle(), SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) != 0) {
+		ec = boost::system::error_code(errno, boost::system::system_category());
+		return false;
+	}
+	return true;
+#else
+	(void)socket;
+	(void)shard;
+	ec = boost::asio::error::operation_not_supported;
+	return false;
+#endif
+}
+
 // Receive messages
-void UdpMulticastServer::doReceive() {
+void UdpMulticastServer::doReceive(Receiver& receiver) {
 	if (!running_) {
 		return;
 	}
 
-	socket_.async_receive_from(
-		net::buffer(recv_buffer_), sender_endpoint_,
-		[this](boost::system::error_code ec, std::size_t bytes_transferred) {
+	receiver.socket->async_receive_from(
+		net::buffer(receiver.recv_buffer), receiver.sender_endpoint,
+		[this, &receiver](boost::system::error_code ec, std::size_t bytes_transferred) {
 			if (!ec && bytes_transferred > 0) {
 				// Process received message
-				std::shared_ptr<std::string> message = std::make_shared<std::string>(recv_buffer_.data(), bytes_transferred);
-				handleMessage(*message, sender_endpoint_);
+				receiver.batch_message.assign(receiver.recv_buffer.data(), bytes_transferred);
+				handleMessage(receiver, receiver.batch_message, receiver.sender_endpoint);
 
 				// Reset error counter
-				error_count_ = 0;
+				receiver.error_count = 0;
 			}
 			else if (ec) {
-				if (ec != boost::asio::error::operation_aborted) {
-					std::cerr << "UDP Multicast receive error: " << ec.message() << std::endl;
-
-					// Increment error count and check if reconnection is needed
-					auto now = std::chrono::steady_clock::now();
-					auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-						now - last_error_time_).count();
-					
-					// If errors occur frequently, try to reconnect
-					if (++error_count_ > 3 && elapsed < 60) {
-						std::cout << "Too many errors, attempting to rejoin multicast group..." << std::endl;
-						if (rejoinMulticastGroup()) {
-							error_count_ = 0;
+				handleReceiveError(receiver, ec);
+			}
+
+			// Continue receiving next message
+			if (running_) {
+				doReceive(receiver);
+			}
+		});
+}
+
+// Allocate batch receive buffers
+void UdpMulticastServer::prepareBatchBuffers(Receiver& receiver) {
+#if defined(__linux__)
+	// 内核对 recvmmsg 的 vlen 上限为 UIO_MAXIOV（1024）
+	size_t batch_size = std::min<size_t>(receive_options_.batch_size, 1024);
+	size_t slot_size = buffer_size_;
+
+	receiver.batch_buffer.assign(batch_size * slot_size, 0);
+	receiver.batch_headers.assign(batch_size, mmsghdr{});
+	receiver.batch_iovecs.assign(batch_size, iovec{});
+	receiver.batch_addresses.assign(batch_size, sockaddr_in{});
+	receiver.batch_datagrams.assign(batch_size, UdpDatagram{nullptr, 0, udp::endpoint()});
+
+	// 端口上有多个组播组时为每个槽位准备 IP_PKTINFO 控制消息缓冲区
+	size_t control_size = receiver.feeds.size() > 1 ? CMSG_SPACE(sizeof(in_pktinfo)) : 0;
+	receiver.batch_control.assign(batch_size * control_size, 0);
+
+	for (size_t i = 0; i < batch_size; ++i) {
+		receiver.batch_iovecs[i].iov_base = receiver.batch_buffer.data() + i * slot_size;
+		receiver.batch_iovecs[i].iov_len = slot_size;
+		receiver.batch_headers[i].msg_hdr.msg_iov = &receiver.batch_iovecs[i];
+		receiver.batch_headers[i].msg_hdr.msg_iovlen = 1;
+		receiver.batch_headers[i].msg_hdr.msg_name = &receiver.batch_addresses[i];
+		receiver.batch_headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		if (control_size > 0) {
+			receiver.batch_headers[i].msg_hdr.msg_control = receiver.batch_control.data() + i * control_size;
+			receiver.batch_headers[i].msg_hdr.msg_controllen = control_size;
+		}
+	}
+#endif
+}
+
+// Receive messages in batches
+void UdpMulticastServer::doReceiveBatch(Receiver& receiver) {
+#if defined(__linux__)
+	if (!running_) {
+		return;
+	}
+
+	receiver.socket->async_wait(udp::socket::wait_read,
+		[this, &receiver](boost::system::error_code ec) {
+			if (ec) {
+				handleReceiveError(receiver, ec);
+				if (running_) {
+					doReceiveBatch(receiver);
+				}
+				return;
+			}
+
+			// 读空内核队列：每轮最多 batch_size 个数据报，不足一批说明队列已空
+			unsigned int batch_size = static_cast<unsigned int>(receiver.batch_headers.size());
+			while (running_) {
+				int received = ::recvmmsg(receiver.socket->native_handle(), receiver.batch_headers.data(), batch_size, MSG_DONTWAIT, nullptr);
+				if (received < 0) {
+					if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+						handleReceiveError(receiver, boost::system::error_code(errno, boost::system::system_category()));
+					}
+					break;
+				}
+
+				size_t count = 0;
+				size_t control_size = receiver.batch_control.size() / batch_size;
+				for (int i = 0; i < received; ++i) {
+					mmsghdr& header = receiver.batch_headers[i];
+					if (header.msg_hdr.msg_flags & MSG_TRUNC) {
+						++truncated_count_;
+					} else if (header.msg_len > 0) {
+						const sockaddr_in& address = receiver.batch_addresses[i];
+						UdpDatagram& datagram = receiver.batch_datagrams[count++];
+						datagram.data = static_cast<const char*>(receiver.batch_iovecs[i].iov_base);
+						datagram.size = header.msg_len;
+						datagram.sender = udp::endpoint(
+							net::ip::address_v4(ntohl(address.sin_addr.s_addr)), ntohs(address.sin_port));
+
+						// 按目的组播组分派数据源
+						uint32_t destination = 0;
+						for (cmsghdr* cmsg = control_size > 0 ? CMSG_FIRSTHDR(&header.msg_hdr) : nullptr;
+							cmsg != nullptr; cmsg = CMSG_NXTHDR(&header.msg_hdr, cmsg)) {
+							if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO) {
+								in_pktinfo info;
+								std::memcpy(&info, CMSG_DATA(cmsg), sizeof(info));
+								destination = ntohl(info.ipi_addr.s_addr);
+							}
 						}
+						datagram.feed = feedOf(receiver, destination);
 					}
-					
-					last_error_time_ = now;
+					// recvmmsg 会改写地址和控制消息长度，下次调用前恢复
+					header.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+					header.msg_hdr.msg_controllen = control_size;
+				}
+
+				if (count > 0) {
+					handleBatch(receiver, receiver.batch_datagrams.data(), count);
+					receiver.error_count = 0;
+				}
+
+				if (static_cast<unsigned int>(received) < batch_size) {
+					break;
 				}
 			}
 
-			// Continue receiving next message
 			if (running_) {
-				doReceive();
+				doReceiveBatch(receiver);
 			}
 		});
+#endif
+}
+
+// Handle receive error
+void UdpMulticastServer::handleReceiveError(Receiver& receiver, const boost::system::error_code& ec) {
+	if (ec == boost::asio::error::operation_aborted) {
+		return;
+	}
+
+	std::cerr << "UDP Multicast receive error: " << ec.message() << std::endl;
+
+	// Increment error count and check if reconnection is needed
+	auto now = std::chrono::steady_clock::now();
+	auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+		now - receiver.last_error_time).count();
+	
+	// If errors occur frequently, try to reconnect
+	if (++receiver.error_count > 3 && elapsed < 60) {
+		std::cout << "Too many errors, attempting to rejoin multicast group..." << std::endl;
+		if (rejoinMulticastGroup(receiver.index)) {
+			receiver.error_count = 0;
+		}
+	}
+	
+	receiver.last_error_time = now;
 }
 
 // Handle received message
-void UdpMulticastServer::handleMessage(const std::string& message, const boost::asio::ip::udp::endpoint& sender) {
-	std::lock_guard<std::mutex> lock(mutex_);
-	if (message_handler_) {
+void UdpMulticastServer::handleMessage(Receiver& receiver, const std::string& message, const boost::asio::ip::udp::endpoint& sender) {
+	// 逐个接收时取不到目的地址，端口上有多个组时按该端口的第一个组处理
+	UdpDatagram datagram{message.data(), message.size(), sender, feedOf(receiver, 0)};
+	handleBatch(receiver, &datagram, 1);
+}
+
+// Handle a batch of received messages
+void UdpMulticastServer::handleBatch(Receiver& receiver, const UdpDatagram* datagrams, size_t count) {
+	size_t bytes = 0;
+	for (size_t i = 0; i < count; ++i) {
+		bytes += datagrams[i].size;
+	}
+	receiver.packets.fetch_add(count, std::memory_order_relaxed);
+	receiver.bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+	if (workers_.empty()) {
+		invokeHandlers(receiver.batch_message, datagrams, count);
+		return;
+	}
+
+	// 接收线程只复制字节：按发送者散列选择解码线程，同一发送者的数据报由同一线程按序处理
+	for (size_t i = 0; i < count; ++i) {
+		const UdpDatagram& datagram = datagrams[i];
+		uint32_t hash = (datagram.sender.address().to_v4().to_uint() ^ datagram.sender.port()) * 2654435761u;
+		DispatchWorker& worker = *workers_[(hash >> 16) % workers_.size()];
+		if (!worker.ring->tryPush(datagram.data, datagram.size, datagram.sender, datagram.feed)) {
+			worker.dropped.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+		worker.enqueued.fetch_add(1, std::memory_order_relaxed);
+
+		// 与 dispatchLoop 中的 sleeping 标志配对：发布数据后再检查对方是否在等待
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (worker.sleeping.load(std::memory_order_relaxed)) {
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			worker.cv.notify_one();
+		}
+	}
+}
+
+// Decoder worker loop
+void UdpMulticastServer::dispatchLoop(DispatchWorker& worker) {
+	size_t max_batch = std::max<size_t>(receive_options_.batch_size, 1);
+	std::vector<UdpDatagram> datagrams(max_batch, UdpDatagram{nullptr, 0, udp::endpoint()});
+	DatagramRing& ring = *worker.ring;
+	size_t idle_spins = 0;
+	auto idle_wait = std::chrono::milliseconds(100);
+	auto next_tick = std::chrono::steady_clock::now() + tick_interval_;
+	if (tick_handler_) {
+		idle_wait = std::min(idle_wait, tick_interval_);
+	}
+
+	while (running_) {
+		// 周期处理器与本线程的批量处理器串行调用
+		if (tick_handler_) {
+			auto now = std::chrono::steady_clock::now();
+			if (now >= next_tick) {
+				invokeTick();
+				next_tick = now + tick_interval_;
+			}
+		}
+
+		size_t count = ring.claim(max_batch);
+		if (count == 0) {
+			// 短暂自旋后休眠，避免空闲时占满 CPU
+			if (++idle_spins < 64) {
+				std::this_thread::yield();
+				continue;
+			}
+			idle_spins = 0;
+			std::unique_lock<std::mutex> lock(worker.mutex);
+			worker.sleeping.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (ring.empty() && running_) {
+				worker.cv.wait_for(lock, idle_wait);
+			}
+			worker.sleeping.store(false, std::memory_order_relaxed);
+			continue;
+		}
+		idle_spins = 0;
+
+		// 处理器直接引用队列槽位中的字节，处理完再释放槽位
+		for (size_t i = 0; i < count; ++i) {
+			datagrams[i].data = ring.data(i);
+			datagrams[i].size = ring.size(i);
+			datagrams[i].sender = ring.sender(i);
+			datagrams[i].feed = ring.feed(i);
+		}
+		invokeHandlers(worker.batch_message, datagrams.data(), count);
+		ring.release(count);
+		worker.processed.fetch_add(count, std::memory_order_relaxed);
+	}
+}
+
+// Get dispatch statistics
+UdpDispatchStats UdpMulticastServer::getDispatchStats() const {
+	UdpDispatchStats stats;
+	stats.workers = workers_.size();
+	for (const auto& worker : workers_) {
+		stats.queued += worker->ring->size();
+		stats.enqueued += worker->enqueued.load(std::memory_order_relaxed);
+		stats.dropped += worker->dropped.load(std::memory_order_relaxed);
+		stats.processed += worker->processed.load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+// Get receive statistics
+UdpReceiveStats UdpMulticastServer::getReceiveStats() const {
+	UdpReceiveStats stats;
+	stats.sockets = receivers_.size();
+	stats.datagram_buffer_size = buffer_size_;
+	for (const auto& receiver : receivers_) {
+		stats.packets += receiver->packets.load(std::memory_order_relaxed);
+		stats.bytes += receiver->bytes.load(std::memory_order_relaxed);
+		stats.queued_bytes += receiver->queued_bytes.load(std::memory_order_relaxed);
+		stats.socket_buffer_size = std::max<size_t>(stats.socket_buffer_size, receiver->socket_buffer_size);
+	}
+	stats.truncated = truncated_count_;
+	stats.kernel_drops = getKernelDropCount();
+	stats.queue_drops = getDispatchStats().dropped;
+
+	std::lock_guard<std::mutex> lock(stats_mutex_);
+	stats.queued_bytes_peak = queued_bytes_peak_;
+	stats.packets_per_second = packets_per_second_;
+	stats.bytes_per_second = bytes_per_second_;
+	stats.drops_per_second = drops_per_second_;
+	return stats;
+}
+
+// Get kernel drop count
+uint64_t UdpMulticastServer::getKernelDropCount() const {
+	uint64_t counted = 0;
+	uint64_t arrived = truncated_count_;
+	for (const auto& receiver : receivers_) {
+		counted += receiver->kernel_drops.load(std::memory_order_relaxed);
+		arrived += receiver->packets.load(std::memory_order_relaxed);
+	}
+
+	// n 个接收线程时，每个组播数据报都被同一端口上其余 n-1 个套接字的分流过滤器丢弃，同样计入内核丢弃计数。
+	// 按全部为组播流量估算：counted = drops + (n-1) * (arrived + drops)，忽略仍在内核队列中的数据报。
+	uint64_t n = shard_contexts_.size() + 1;
+	if (n <= 1) {
+		return counted;
+	}
+	uint64_t filtered = (n - 1) * arrived;
+	return counted > filtered ? (counted - filtered) / n : 0;
+}
+
+// Set kernel receive buffer size
+size_t UdpMulticastServer::applySocketBufferSize(udp::socket& socket) {
+	boost::system::error_code ec;
+	size_t requested = std::min<size_t>(receive_options_.socket_buffer_size, INT_MAX / 2);
+	if (requested > 0) {
+		bool forced = false;
+#if defined(__linux__) && defined(SO_RCVBUFFORCE)
+		// 有 CAP_NET_ADMIN 权限时越过 net.core.rmem_max 上限
+		int value = static_cast<int>(requested);
+		forced = ::setsockopt(socket.native_handle(), SOL_SOCKET, SO_RCVBUFFORCE, &value, sizeof(value)) == 0;
+#endif
+		if (!forced) {
+			socket.set_option(boost::asio::socket_base::receive_buffer_size(static_cast<int>(requested)), ec);
+			if (ec) {
+				std::cerr << "Warning: Failed to set receive buffer size: " << ec.message() << std::endl;
+			}
+		}
+	}
+
+	boost::asio::socket_base::receive_buffer_size option;
+	socket.get_option(option, ec);
+	return ec ? 0 : static_cast<size_t>(option.value());
+}
+
+// Schedule the next stats sample
+void UdpMulticastServer::scheduleStatsSample(Receiver& receiver) {
+	receiver.stats_timer->expires_after(std::chrono::seconds(1));
+	receiver.stats_timer->async_wait([this, &receiver](boost::system::error_code ec) {
+		if (ec || !running_) {
+			return;
+		}
+		sampleSocket(receiver);
+		if (receiver.index == 0) {
+			updateRates();
+		}
+		scheduleStatsSample(receiver);
+	});
+}
+
+// Sample the kernel receive queue of a socket
+void UdpMulticastServer::sampleSocket(Receiver& receiver) {
+#if defined(__linux__) && defined(SO_MEMINFO)
+	// SO_MEMINFO 随时读取套接字的丢弃计数（与 SO_RXQ_OVFL 附带的计数相同）和当前队列占用，
+	// 不依赖后续数据报到达
+	uint32_t meminfo[SK_MEMINFO_VARS] = {};
+	socklen_t length = sizeof(meminfo);
+	if (::getsockopt(receiver.socket->native_handle(), SOL_SOCKET, SO_MEMINFO, meminfo, &length) == 0 &&
+		length >= sizeof(uint32_t) * (SK_MEMINFO_DROPS + 1)) {
+		uint32_t drops = meminfo[SK_MEMINFO_DROPS];
+		receiver.kernel_drops.fetch_add(drops - receiver.socket_drops, std::memory_order_relaxed);
+		receiver.socket_drops = drops;
+		receiver.queued_bytes = meminfo[SK_MEMINFO_RMEM_ALLOC];
+	}
+#else
+	(void)receiver;
+#endif
+}
+
+// Update per-second rates
+void UdpMulticastServer::updateRates() {
+	uint64_t packets = 0;
+	uint64_t bytes = 0;
+	size_t queued_bytes = 0;
+	for (const auto& receiver : receivers_) {
+		packets += receiver->packets.load(std::memory_order_relaxed);
+		bytes += receiver->bytes.load(std::memory_order_relaxed);
+		queued_bytes += receiver->queued_bytes.load(std::memory_order_relaxed);
+	}
+	uint64_t drops = truncated_count_ + getKernelDropCount() + getDispatchStats().dropped;
+	auto now = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> lock(stats_mutex_);
+	double seconds = std::chrono::duration<double>(now - last_sample_time_).count();
+	if (seconds > 0) {
+		packets_per_second_ = (packets - last_sample_packets_) / seconds;
+		bytes_per_second_ = (bytes - last_sample_bytes_) / seconds;
+		// 多套接字模式下内核丢弃是估算值，可能回退
+		drops_per_second_ = drops > last_sample_drops_ ? (drops - last_sample_drops_) / seconds : 0;
+	}
+	last_sample_time_ = now;
+	last_sample_packets_ = packets;
+	last_sample_bytes_ = bytes;
+	last_sample_drops_ = std::max(drops, last_sample_drops_);
+	queued_bytes_peak_ = std::max(queued_bytes_peak_, queued_bytes);
+}
+
+// Invoke message handlers
+void UdpMulticastServer::invokeHandlers(std::string& message_buffer, const UdpDatagram* datagrams, size_t count) {
+	// 处理器在 run() 之前设置、之后只读，调用时不加锁，各线程并行写入分片的航迹存储
+	if (batch_handler_) {
 		try {
-			message_handler_(message, sender);
+			batch_handler_(datagrams, count);
 		}
 		catch (const std::exception& e) {
 			std::cerr << "UDP Message handler error: " << e.what() << std::endl;
 		}
 	}
+	else if (message_handler_) {
+		for (size_t i = 0; i < count; ++i) {
+			try {
+				// 逐个接收时消息已在缓冲区中，其他情况复制过去；容量增长到最大数据报后不再分配
+				if (message_buffer.data() != datagrams[i].data) {
+					message_buffer.assign(datagrams[i].data, datagrams[i].size);
+				}
+				message_handler_(message_buffer, datagrams[i].sender);
+			}
+			catch (const std::exception& e) {
+				std::cerr << "UDP Message handler error: " << e.what() << std::endl;
+			}
+		}
+	}
+}
+
+// Schedule the periodic handler on a receive thread
+void UdpMulticastServer::scheduleTick(Receiver& receiver) {
+	receiver.tick_timer->expires_after(tick_interval_);
+	receiver.tick_timer->async_wait([this, &receiver](boost::system::error_code ec) {
+		if (ec || !running_) {
+			return;
+		}
+		invokeTick();
+		scheduleTick(receiver);
+	});
+}
+
+// Invoke the periodic handler
+void UdpMulticastServer::invokeTick() {
+	try {
+		tick_handler_();
+	}
+	catch (const std::exception& e) {
+		std::cerr << "UDP tick handler error: " << e.what() << std::endl;
+	}
 }
 
 // Send test data
@@ -492,6 +1350,25 @@ void UdpMulticastServer::sendTestData(const std::string& test_data_type) {
 		return;
 	}
 	
+	// 航迹测试数据：三条航迹以二进制航迹帧发送，与真实生产者走同一条 sendTracks 路径
+	if (test_data_type == "tracks") {
+		static std::atomic<uint32_t> step{0};
+		uint32_t n = step++;
+		int64_t timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+		std::vector<Track> tracks(3);
+		for (size_t i = 0; i < tracks.size(); ++i) {
+			tracks[i].id = "udp-test-" + std::to_string(i + 1);
+			tracks[i].longitude = 120.0 + 0.5 * i + 0.001 * n;
+			tracks[i].latitude = 30.0 + 0.5 * i;
+			tracks[i].heading = 90.0;
+			tracks[i].timestamp = timestamp;
+			tracks[i].ship_name = "UDP Test " + std::to_string(i + 1);
+		}
+		std::cout << "Sending UDP multicast test tracks (" << tracks.size() << " records)" << std::endl;
+		sendTracks(tracks);
+		return;
+	}
+
 	std::string test_message;
 	
 	// 根据测试数据类型生成不同的测试数据
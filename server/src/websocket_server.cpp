@@ -3,6 +3,7 @@
 #include <boost/asio/strand.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
+#include <boost/version.hpp>
 #include <algorithm>
 #include <cstdlib>
 #include <functional>
@@ -14,53 +15,151 @@
 
 namespace cesium_server {
 
+namespace {
+
+// 写合并时拼接 JSON 数组使用的分隔符
+const char kArrayOpen[] = "[";
+const char kArraySeparator[] = ",";
+const char kArrayClose[] = "]";
+
+// 写合并时一条 JSON 消息在外层数组中占用的内容：
+// 消息本身是数组（批量广播、快照块）时去掉首尾方括号，元素直接并入外层数组，空数组返回空缓冲区
+net::const_buffer arrayElements(const std::string& message) {
+    if (message.size() >= 2 && message.front() == '[' && message.back() == ']') {
+        return net::buffer(message.data() + 1, message.size() - 2);
+    }
+    return net::buffer(message);
+}
+
+// 会话ID生成器
+std::atomic<uint64_t> g_next_session_id{1};
+
+} // namespace
+
 // WebSocket 会话构造函数
 WebSocketSession::WebSocketSession(
     tcp::socket&& socket,
     WebSocketMessageHandler message_handler,
-    WebSocketConnectionHandler connection_handler)
+    WebSocketConnectionHandler connection_handler,
+    const WebSocketSessionOptions& options,
+    std::atomic<size_t>* syncing_sessions)
     : ws_(std::move(socket)),
       message_handler_(std::move(message_handler)),
       connection_handler_(std::move(connection_handler)),
+      id_(g_next_session_id.fetch_add(1)),
+      batch_options_(options.write_batch),
+      backpressure_options_(options.backpressure),
+      deflate_options_(options.deflate),
+      flush_timer_(ws_.get_executor()),
       writing_(false),
-      is_open_(true) {
+      is_open_(true),
+      syncing_(options.sync_on_connect),
+      syncing_sessions_(syncing_sessions),
+      sync_timer_(ws_.get_executor()) {
+    if (syncing_ && syncing_sessions_) {
+        ++*syncing_sessions_;
+    }
+
+    // 记录远端地址，便于监控
+    beast::error_code ec;
+    auto endpoint = beast::get_lowest_layer(ws_).socket().remote_endpoint(ec);
+    if (!ec) {
+        remote_endpoint_ = endpoint.address().to_string() + ":" + std::to_string(endpoint.port());
+    }
 }
 
 // WebSocket 会话析构函数
 WebSocketSession::~WebSocketSession() {
     // 标记会话已关闭
+    // 关闭通知在 onClose 中发出：析构时已无法获取 shared_from_this()
     is_open_ = false;
-    
-    // 通知连接已关闭
-    if (connection_handler_) {
-        try {
-            // 使用尝试，而不是直接使用shared_from_this()，以防在析构过程中已经无法获取shared_ptr
-            connection_handler_(shared_from_this(), false);
-        } catch (const std::exception& e) {
-            std::cerr << "Error in ~WebSocketSession: " << e.what() << std::endl;
-        }
-    }
 }
 
 // 启动会话
 void WebSocketSession::run() {
+    // 先读取 HTTP 升级请求，以便根据 Sec-WebSocket-Protocol 协商消息格式
+    beast::get_lowest_layer(ws_).expires_after(std::chrono::seconds(30));
+    beast::http::async_read(ws_.next_layer(), buffer_, upgrade_request_,
+        beast::bind_front_handler(
+            [self = shared_from_this()](beast::error_code ec, std::size_t) {
+                self->onUpgradeRequest(ec);
+            }));
+}
+
+// 处理升级请求
+void WebSocketSession::onUpgradeRequest(beast::error_code ec) {
+    if (ec) {
+        std::cerr << "WebSocket upgrade request error: " << ec.message() << std::endl;
+        is_open_ = false;
+        notifyClosed();
+        return;
+    }
+
+    // 客户端按优先级列出子协议，选择第一个支持的
+    std::string offered(upgrade_request_[beast::http::field::sec_websocket_protocol]);
+    size_t pos = 0;
+    while (pos < offered.size() && subprotocol_.empty()) {
+        size_t comma = offered.find(',', pos);
+        if (comma == std::string::npos) {
+            comma = offered.size();
+        }
+        size_t begin = offered.find_first_not_of(' ', pos);
+        size_t end = offered.find_last_not_of(' ', comma - 1);
+        if (begin != std::string::npos && begin < comma && end >= begin) {
+            std::string protocol = offered.substr(begin, end - begin + 1);
+            if (protocol == kBinarySubprotocol) {
+                wire_format_ = WireFormat::Binary;
+                subprotocol_ = protocol;
+            } else if (protocol == kJsonSubprotocol) {
+                subprotocol_ = protocol;
+            }
+        }
+        pos = comma + 1;
+    }
+
+    // 握手阶段改由 WebSocket 自身的超时设置管理
+    beast::get_lowest_layer(ws_).expires_never();
+
     // 设置 WebSocket 选项
     ws_.set_option(websocket::stream_base::timeout::suggested(
         beast::role_type::server));
 
-    // 设置最大消息大小
+    // 启用 permessage-deflate：客户端提供该扩展时协商压缩，否则照常发送未压缩的帧
+    if (deflate_options_.enabled) {
+        websocket::permessage_deflate pmd;
+        pmd.server_enable = true;
+        pmd.server_max_window_bits = deflate_options_.server_max_window_bits;
+        pmd.client_max_window_bits = deflate_options_.client_max_window_bits;
+        pmd.server_no_context_takeover = deflate_options_.server_no_context_takeover;
+        pmd.client_no_context_takeover = deflate_options_.client_no_context_takeover;
+        pmd.compLevel = deflate_options_.level;
+        pmd.memLevel = deflate_options_.mem_level;
+#if BOOST_VERSION >= 108100
+        // 小帧（单条位置更新）压缩收益很小，直接发送
+        pmd.msg_size_threshold = deflate_options_.min_size;
+#endif
+        ws_.set_option(pmd);
+    }
+
+    // 设置响应头，回显选中的子协议
     ws_.set_option(websocket::stream_base::decorator(
-        [](websocket::response_type& res) {
+        [protocol = subprotocol_](websocket::response_type& res) {
             res.set(boost::beast::http::field::server, 
                     std::string(BOOST_BEAST_VERSION_STRING) + " cesium-server");
+            if (!protocol.empty()) {
+                res.set(boost::beast::http::field::sec_websocket_protocol, protocol);
+            }
         }));
 
     // 接受 WebSocket 握手
     ws_.async_accept(
+        upgrade_request_,
         beast::bind_front_handler(
             [self = shared_from_this()](beast::error_code ec) {
                 if (ec) {
                     std::cerr << "WebSocket accept error: " << ec.message() << std::endl;
+                    self->is_open_ = false;
+                    self->notifyClosed();
                     return;
                 }
 
@@ -76,6 +175,15 @@ void WebSocketSession::run() {
 
 // 发送消息
 void WebSocketSession::send(const std::string& message) {
+    send(std::make_shared<const std::string>(message));
+}
+
+// 发送共享消息
+void WebSocketSession::send(SharedMessage message, std::string key, bool binary, uint64_t seq) {
+    if (!message) {
+        return;
+    }
+
     // 使用互斥锁保护队列访问
     {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -85,35 +193,320 @@ void WebSocketSession::send(const std::string& message) {
             std::cerr << "Trying to send to closed WebSocket session" << std::endl;
             return;
         }
+
+        if (seq != 0) {
+            // 快照发送完之前暂存增量更新；之后丢弃快照中已包含的更新
+            if (syncing_) {
+                holdForSync(std::move(message), std::move(key), binary, seq);
+                return;
+            }
+            if (coveredBySync(key, seq)) {
+                return;
+            }
+        }
+
+        if (!enqueue(std::move(message), std::move(key), binary)) {
+            return;
+        }
         
-        // 将消息添加到队列
-        write_queue_.push(message);
-        
-        // 如果已经有写操作在进行，直接返回
+        // 如果已经有写操作在进行，直接返回；
+        // 正在等待合并且积压已达上限时，提前结束等待
         if (writing_) {
+            if (waiting_flush_ && queued_bytes_ >= batch_options_.max_batch_bytes) {
+                net::post(ws_.get_executor(), [self = shared_from_this()]() {
+                    self->flush_timer_.cancel();
+                });
+            }
             return;
         }
+        writing_ = true;
     }
     
-    // 开始处理写队列
+    // 在会话的 strand 上开始处理写队列
+    net::post(ws_.get_executor(),
+        beast::bind_front_handler(&WebSocketSession::startWrite, shared_from_this()));
+}
+
+// 消息入队
+bool WebSocketSession::enqueue(SharedMessage message, std::string key, bool binary) {
+    bool conflate = backpressure_options_.policy == OverflowPolicy::ConflateByEntity && !key.empty();
+    if (conflate) {
+        // 队列中已有该实体的消息时原地替换为最新消息，队列长度不变
+        auto it = pending_keys_.find(key);
+        if (it != pending_keys_.end()) {
+            auto& entry = write_queue_[it->second - queue_head_seq_];
+            queued_bytes_ = queued_bytes_ - entry.payload->size() + message->size();
+            entry.payload = std::move(message);
+            entry.binary = binary;
+            ++conflated_count_;
+            return true;
+        }
+        pending_keys_.emplace(key, queue_head_seq_ + write_queue_.size());
+    } else {
+        key.clear();
+    }
+
+    // 将消息添加到队列（只增加引用计数）
+    queued_bytes_ += message->size();
+    write_queue_.push_back({std::move(message), std::move(key), binary});
+
+    // 超出队列上限时按策略丢弃；持续溢出的会话直接断开
+    if (enforceLimits()) {
+        std::cerr << "WebSocket session " << id_ << " (" << remote_endpoint_
+                  << ") cannot keep up, disconnecting" << std::endl;
+        is_open_ = false;
+        net::post(ws_.get_executor(),
+            beast::bind_front_handler(&WebSocketSession::disconnect, shared_from_this()));
+        return false;
+    }
+    return true;
+}
+
+// 开始发送快照
+void WebSocketSession::startSync(std::vector<SyncChunk> chunks, SyncFilter filter,
+                                 std::chrono::milliseconds interval) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!is_open_) {
+            return;
+        }
+
+        setSyncing(true);
+        sync_started_ = true;
+        sync_chunks_.assign(std::make_move_iterator(chunks.begin()), std::make_move_iterator(chunks.end()));
+        sync_filter_ = std::move(filter);
+        sync_interval_ = interval;
+        sync_next_chunk_at_ = std::chrono::steady_clock::time_point();
+
+        // 正在写时，写循环在队列清空后接着发送快照
+        if (writing_) {
+            return;
+        }
+        writing_ = true;
+    }
+
+    net::post(ws_.get_executor(),
+        beast::bind_front_handler(&WebSocketSession::startWrite, shared_from_this()));
+}
+
+// 同步期间暂存增量更新
+void WebSocketSession::holdForSync(SharedMessage message, std::string key, bool binary, uint64_t seq) {
+    if (key.empty()) {
+        held_batches_.push_back({std::move(message), binary, seq});
+        if (held_batches_.size() > backpressure_options_.max_queue_messages) {
+            held_batches_.pop_front();
+            ++dropped_count_;
+        }
+        return;
+    }
+
+    // 同一实体只保留序号最大的一条（广播可能乱序到达）
+    HeldMessage& held = held_updates_[key];
+    if (held.payload) {
+        if (seq <= held.seq) {
+            return;
+        }
+        ++conflated_count_;
+    }
+    held = {std::move(message), binary, seq};
+}
+
+// 快照发送完毕
+void WebSocketSession::finishSync() {
+    setSyncing(false);
+    sync_started_ = false;
+
+    // 按序号顺序释放暂存的更新，丢弃快照中已包含的部分
+    std::vector<std::pair<std::string, HeldMessage>> held;
+    held.reserve(held_updates_.size() + held_batches_.size());
+    for (auto& entry : held_batches_) {
+        held.emplace_back(std::string(), std::move(entry));
+    }
+    for (auto& entry : held_updates_) {
+        held.emplace_back(entry.first, std::move(entry.second));
+    }
+    held_batches_.clear();
+    held_updates_.clear();
+
+    std::sort(held.begin(), held.end(), [](const auto& a, const auto& b) {
+        return a.second.seq < b.second.seq;
+    });
+    for (auto& entry : held) {
+        if (coveredBySync(entry.first, entry.second.seq)) {
+            continue;
+        }
+        if (!enqueue(std::move(entry.second.payload), std::move(entry.first), entry.second.binary)) {
+            return;
+        }
+    }
+}
+
+// 切换同步状态
+void WebSocketSession::setSyncing(bool syncing) {
+    if (syncing_ == syncing) {
+        return;
+    }
+    syncing_ = syncing;
+    if (syncing_sessions_) {
+        if (syncing) {
+            ++*syncing_sessions_;
+        } else {
+            --*syncing_sessions_;
+        }
+    }
+}
+
+// 增量更新是否已包含在快照中
+bool WebSocketSession::coveredBySync(const std::string& key, uint64_t seq) {
+    if (seq <= sync_filter_.watermark) {
+        return true;
+    }
+    if (!sync_filter_.delivered.empty() && !key.empty()) {
+        auto it = sync_filter_.delivered.find(key);
+        if (it != sync_filter_.delivered.end()) {
+            if (seq <= it->second) {
+                return true;
+            }
+            // 之后该实体的更新都比快照新，不再需要记录
+            sync_filter_.delivered.erase(it);
+        }
+    }
+    return false;
+}
+
+// 弹出队首消息
+SharedMessage WebSocketSession::popFront() {
+    QueuedMessage& entry = write_queue_.front();
+    if (!entry.key.empty()) {
+        auto it = pending_keys_.find(entry.key);
+        if (it != pending_keys_.end() && it->second == queue_head_seq_) {
+            pending_keys_.erase(it);
+        }
+    }
+
+    SharedMessage payload = std::move(entry.payload);
+    queued_bytes_ -= payload->size();
+    write_queue_.pop_front();
+    ++queue_head_seq_;
+    return payload;
+}
+
+// 按背压配置裁剪队列
+bool WebSocketSession::enforceLimits() {
+    const auto& limits = backpressure_options_;
+    if (write_queue_.size() <= limits.max_queue_messages && queued_bytes_ <= limits.max_queue_bytes) {
+        overflow_since_ = std::chrono::steady_clock::time_point();
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (overflow_since_ == std::chrono::steady_clock::time_point()) {
+        overflow_since_ = now;
+    }
+
+    // 丢弃最旧的消息直到满足上限
+    while (!write_queue_.empty() &&
+           (write_queue_.size() > limits.max_queue_messages || queued_bytes_ > limits.max_queue_bytes)) {
+        popFront();
+        ++dropped_count_;
+    }
+
+    return now - overflow_since_ > limits.stall_timeout;
+}
+
+// 主动断开会话
+void WebSocketSession::disconnect() {
+    is_open_ = false;
+
+    // 直接关闭底层套接字：慢消费者无法完成关闭握手，挂起的读写会以错误结束
+    beast::error_code ec;
+    beast::get_lowest_layer(ws_).socket().close(ec);
+}
+
+// 获取写队列统计
+SessionQueueStats WebSocketSession::getQueueStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SessionQueueStats stats;
+    stats.session_id = id_;
+    stats.remote_endpoint = remote_endpoint_;
+    stats.queue_depth = write_queue_.size();
+    stats.queued_bytes = queued_bytes_;
+    stats.dropped = dropped_count_;
+    stats.conflated = conflated_count_;
+    return stats;
+}
+
+// 开始一轮写操作
+void WebSocketSession::startWrite() {
+    if (batch_options_.enabled && batch_options_.max_delay.count() > 0) {
+        bool below_limit;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            below_limit = queued_bytes_ < batch_options_.max_batch_bytes;
+        }
+
+        // 积压未达上限时等待一段时间，让更多消息合并到同一帧
+        if (below_limit) {
+            waiting_flush_ = true;
+            flush_timer_.expires_after(batch_options_.max_delay);
+            flush_timer_.async_wait(
+                [self = shared_from_this()](beast::error_code) {
+                    self->waiting_flush_ = false;
+                    self->doWrite();
+                });
+            return;
+        }
+    }
+
     doWrite();
 }
 
 // 处理消息队列
 void WebSocketSession::doWrite() {
-    // 设置写入标志
-    writing_ = true;
-    
-    std::string message;
+    in_flight_.clear();
+    write_buffers_.clear();
     {
         std::lock_guard<std::mutex> lock(mutex_);
+
+        // 同步快照：队列清空后才放入下一块，每次只有一块在发送，发送速度跟随客户端的接收速度
+        if (write_queue_.empty() && sync_started_) {
+            if (sync_chunks_.empty()) {
+                finishSync();
+            } else {
+                auto now = std::chrono::steady_clock::now();
+                if (now < sync_next_chunk_at_ && is_open_) {
+                    // 按间隔发送：等待下一块的发送时间（写操作仍视为进行中）
+                    sync_timer_.expires_at(sync_next_chunk_at_);
+                    sync_timer_.async_wait(
+                        [self = shared_from_this()](beast::error_code) {
+                            self->doWrite();
+                        });
+                    return;
+                }
+                SyncChunk chunk = std::move(sync_chunks_.front());
+                sync_chunks_.pop_front();
+                queued_bytes_ += chunk.payload->size();
+                write_queue_.push_back({std::move(chunk.payload), std::string(), chunk.binary});
+                sync_next_chunk_at_ = now + sync_interval_;
+            }
+        }
+
         if (write_queue_.empty()) {
             writing_ = false;
             return;
         }
-        // 使用std::move来避免不必要的复制，并确保原始字符串被清空
-        message = std::move(write_queue_.front());
-        write_queue_.pop();
+
+        // 未启用写合并时一次只发送一条消息；
+        // 启用时取出积压的消息，直到达到单帧字节上限（至少取一条）
+        // 文本帧和二进制帧不能合并到同一帧
+        in_flight_binary_ = write_queue_.front().binary;
+        size_t batch_bytes = 0;
+        do {
+            in_flight_.push_back(popFront());
+            batch_bytes += in_flight_.back()->size();
+        } while (batch_options_.enabled && !write_queue_.empty() &&
+                 write_queue_.front().binary == in_flight_binary_ &&
+                 batch_bytes + write_queue_.front().payload->size() <= batch_options_.max_batch_bytes);
     }
     
     // 确保WebSocket连接处于开放状态
@@ -123,15 +516,38 @@ void WebSocketSession::doWrite() {
         return;
     }
     
+    // 组装缓冲区序列：单条消息直接发送，多条二进制消息首尾相接，
+    // 多条 JSON 消息拼成一个扁平的 JSON 数组（聚集写，不复制内容）：
+    // 数组消息只取其元素，合并帧始终只有一层，前端只需展开一层
+    if (in_flight_.size() == 1 || in_flight_binary_) {
+        for (const auto& message : in_flight_) {
+            write_buffers_.push_back(net::buffer(*message));
+        }
+    } else {
+        write_buffers_.reserve(in_flight_.size() * 2 + 1);
+        write_buffers_.push_back(net::buffer(kArrayOpen, 1));
+        bool first = true;
+        for (const auto& message : in_flight_) {
+            net::const_buffer elements = arrayElements(*message);
+            if (elements.size() == 0) {
+                continue;
+            }
+            if (!first) {
+                write_buffers_.push_back(net::buffer(kArraySeparator, 1));
+            }
+            write_buffers_.push_back(elements);
+            first = false;
+        }
+        write_buffers_.push_back(net::buffer(kArrayClose, 1));
+    }
+    
     try {
-        // 创建一个共享指针来存储消息，确保在异步操作期间消息不会被销毁
-        auto msg_ptr = std::make_shared<std::string>(std::move(message));
-        
-        // 发送消息到客户端
+        // in_flight_ 持有共享消息的引用，确保在异步操作期间消息不会被销毁
+        ws_.binary(in_flight_binary_);
         ws_.async_write(
-            net::buffer(*msg_ptr),
+            write_buffers_,
             beast::bind_front_handler(
-                [self = shared_from_this(), msg_ptr](beast::error_code ec, std::size_t bytes_transferred) {
+                [self = shared_from_this()](beast::error_code ec, std::size_t bytes_transferred) {
                     if (ec) {
                         std::cerr << "WebSocket write error: " << ec.message() << std::endl;
                         self->writing_ = false;
@@ -178,6 +594,28 @@ void WebSocketSession::doRead() {
             }));
 }
 
+// 通知连接已关闭
+void WebSocketSession::notifyClosed() {
+    if (closed_notified_.exchange(true)) {
+        return;
+    }
+
+    // 同步中关闭的会话不再计入同步会话；之后的 startSync 因会话已关闭直接返回
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_open_ = false;
+        setSyncing(false);
+    }
+
+    if (connection_handler_) {
+        try {
+            connection_handler_(shared_from_this(), false);
+        } catch (const std::exception& e) {
+            std::cerr << "Error in connection handler: " << e.what() << std::endl;
+        }
+    }
+}
+
 // 处理关闭
 void WebSocketSession::onClose(beast::error_code ec) {
     // 标记会话已关闭
@@ -196,8 +634,12 @@ void WebSocketSession::onClose(beast::error_code ec) {
     {
         std::lock_guard<std::mutex> lock(mutex_);
         // 清空消息队列
-        std::queue<std::string> empty;
-        std::swap(write_queue_, empty);
+        write_queue_.clear();
+        pending_keys_.clear();
+        queued_bytes_ = 0;
+        sync_chunks_.clear();
+        held_updates_.clear();
+        held_batches_.clear();
     }
     
     // 只在连接仍然打开时尝试关闭
@@ -211,41 +653,42 @@ void WebSocketSession::onClose(beast::error_code ec) {
             std::cerr << "Exception in WebSocketSession::onClose: " << e.what() << std::endl;
         }
     }
+
+    // 通知连接已关闭
+    notifyClosed();
 }
 
 // WebSocket 服务器构造函数
-WebSocketServer::WebSocketServer(const std::string& address, unsigned short port, int threads)
+WebSocketServer::WebSocketServer(const std::string& address, unsigned short port, int threads,
+                                 const IoModelOptions& io_model)
     : address_(address), port_(port), num_threads_(threads),
-      ioc_(threads), acceptor_(net::make_strand(ioc_)), running_(false) {
+      ioc_(threads), acceptor_(net::make_strand(ioc_)), io_model_(io_model), running_(false) {
     
-    beast::error_code ec;
-
-    // 打开接收器
     tcp::endpoint endpoint(net::ip::make_address(address), port);
-    acceptor_.open(endpoint.protocol(), ec);
-    if (ec) {
-        std::cerr << "Error opening acceptor: " << ec.message() << std::endl;
-        return;
-    }
 
-    // 允许地址重用
-    acceptor_.set_option(net::socket_base::reuse_address(true), ec);
-    if (ec) {
-        std::cerr << "Error setting reuse_address: " << ec.message() << std::endl;
-        return;
-    }
+    if (io_model_.model == IoModel::PerThread) {
+        io_pool_ = std::make_unique<IoContextPool>(static_cast<size_t>(std::max(threads, 1)));
 
-    // 绑定到端口
-    acceptor_.bind(endpoint, ec);
-    if (ec) {
-        std::cerr << "Error binding to " << address << ":" << port << ": " << ec.message() << std::endl;
-        return;
+        if (io_model_.accept_mode == AcceptMode::ReusePort) {
+            if (!isReusePortSupported()) {
+                std::cerr << "SO_REUSEPORT not supported, falling back to round-robin accept" << std::endl;
+                io_model_.accept_mode = AcceptMode::RoundRobin;
+            } else {
+                // 每个 io_context 一个监听套接字
+                for (size_t i = 0; i < io_pool_->size(); ++i) {
+                    auto acceptor = std::make_unique<tcp::acceptor>(io_pool_->getIoContext(i));
+                    if (!openAcceptor(*acceptor, endpoint, true)) {
+                        reuse_port_acceptors_.clear();
+                        return;
+                    }
+                    reuse_port_acceptors_.push_back(std::move(acceptor));
+                }
+            }
+        }
     }
 
-    // 开始监听
-    acceptor_.listen(net::socket_base::max_listen_connections, ec);
-    if (ec) {
-        std::cerr << "Error listening: " << ec.message() << std::endl;
+    // 打开接收器
+    if (reuse_port_acceptors_.empty() && !openAcceptor(acceptor_, endpoint, false)) {
         return;
     }
 
@@ -262,15 +705,35 @@ void WebSocketServer::run() {
     if (running_) return;
     running_ = true;
 
+    if (io_pool_) {
+        // 每线程一个 io_context：会话的读写和定时器都在所属线程上执行
+        io_pool_->run();
+
+        if (!reuse_port_acceptors_.empty()) {
+            for (size_t i = 0; i < reuse_port_acceptors_.size(); ++i) {
+                doAccept(*reuse_port_acceptors_[i], &io_pool_->getIoContext(i));
+            }
+        } else {
+            // 单个接收器在独立线程上运行，按轮询分配连接
+            doAccept(acceptor_, nullptr);
+            thread_pool_ = std::make_unique<ThreadPool>(1);
+            thread_pool_->post([this] { ioc_.run(); });
+        }
+
+        std::cout << "WebSocket server running with " << io_pool_->size() << " io_context threads ("
+                  << (reuse_port_acceptors_.empty() ? "round-robin" : "reuseport") << " accept)" << std::endl;
+        return;
+    }
+
     // 开始接受连接
-    doAccept();
+    doAccept(acceptor_, nullptr);
 
     // 初始化线程池
     thread_pool_ = std::make_unique<ThreadPool>(num_threads_);
 
     // 启动IO上下文在所有线程中
     for (int i = 0; i < num_threads_; ++i) {
-        thread_pool_->enqueue([this] { ioc_.run(); });
+        thread_pool_->post([this] { ioc_.run(); });
     }
 
     std::cout << "WebSocket server running with " << num_threads_ << " threads" << std::endl;
@@ -284,6 +747,9 @@ void WebSocketServer::stop() {
     // 停止接收器
     beast::error_code ec;
     acceptor_.close(ec);
+    for (auto& acceptor : reuse_port_acceptors_) {
+        acceptor->close(ec);
+    }
 
     // 关闭所有会话
     {
@@ -293,6 +759,9 @@ void WebSocketServer::stop() {
 
     // 停止 IO 上下文
     ioc_.stop();
+    if (io_pool_) {
+        io_pool_->stop();
+    }
 
     // 销毁线程池
     thread_pool_.reset();
@@ -312,16 +781,23 @@ void WebSocketServer::setConnectionHandler(WebSocketConnectionHandler handler) {
 
 // 广播消息给所有客户端
 void WebSocketServer::broadcast(const std::string& message) {
-    // 创建消息的副本，确保在多线程环境中安全
-    std::string message_copy = message;
-    
+    broadcast(std::make_shared<const std::string>(message));
+}
+
+// 广播消息给所有客户端（接管消息内容）
+void WebSocketServer::broadcast(std::string&& message) {
+    broadcast(std::make_shared<const std::string>(std::move(message)));
+}
+
+// 广播共享消息给所有客户端
+void WebSocketServer::broadcast(const SharedMessage& message, const std::string& key) {
     // 创建会话集合的快照，在锁内复制指针但在锁外发送消息
     std::vector<std::shared_ptr<WebSocketSession>> session_snapshot;
     {
         std::lock_guard<std::mutex> lock(sessions_mutex_);
         session_snapshot.reserve(sessions_.size());
-        for (const auto& session : sessions_) {
-            session_snapshot.push_back(session);
+        for (const auto& entry : sessions_) {
+            session_snapshot.push_back(entry.second);
         }
     }
     
@@ -329,8 +805,57 @@ void WebSocketServer::broadcast(const std::string& message) {
     for (const auto& session : session_snapshot) {
         try {
             if (session && session->getStream().is_open()) {
-                // 为每个会话传递消息的副本
-                session->send(message_copy);
+                // 所有会话共享同一份消息缓冲区
+                session->send(message, key);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error broadcasting message: " << e.what() << std::endl;
+        }
+    }
+}
+
+// 广播位置更新
+void WebSocketServer::broadcastAt(const SharedMessage& message, double longitude, double latitude,
+                                  const std::string& key) {
+    broadcastAt(message, nullptr, longitude, latitude, key);
+}
+
+// 广播位置更新的两种编码
+void WebSocketServer::broadcastAt(const SharedMessage& json_message, const SharedMessage& binary_message,
+                                  double longitude, double latitude, const std::string& key,
+                                  uint64_t seq) {
+    // 查询视域包含该位置的会话
+    std::vector<uint64_t> matched_ids;
+    subscriptions_.query(longitude, latitude, matched_ids);
+
+    std::vector<std::shared_ptr<WebSocketSession>> session_snapshot;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        session_snapshot.reserve(sessions_.size());
+
+        // 未设置视域的会话接收全部更新
+        for (const auto& entry : sessions_) {
+            if (!entry.second->hasViewport()) {
+                session_snapshot.push_back(entry.second);
+            }
+        }
+        for (uint64_t id : matched_ids) {
+            auto it = sessions_.find(id);
+            if (it != sessions_.end()) {
+                session_snapshot.push_back(it->second);
+            }
+        }
+    }
+
+    for (const auto& session : session_snapshot) {
+        try {
+            if (!session->getStream().is_open()) {
+                continue;
+            }
+            if (binary_message && session->getWireFormat() == WireFormat::Binary) {
+                session->send(binary_message, key, true, seq);
+            } else {
+                session->send(json_message, key, false, seq);
             }
         } catch (const std::exception& e) {
             std::cerr << "Error broadcasting message: " << e.what() << std::endl;
@@ -338,25 +863,159 @@ void WebSocketServer::broadcast(const std::string& message) {
     }
 }
 
+// 批量广播位置更新
+void WebSocketServer::broadcastBatch(const SharedMessage& json_batch, const SharedMessage& binary_batch,
+                                     const std::vector<BroadcastItem>& items, uint64_t batch_seq) {
+    // 视域会话ID -> 视域内的更新下标
+    std::unordered_map<uint64_t, std::vector<size_t>> matched_items;
+    if (subscriptions_.size() > 0) {
+        std::vector<uint64_t> matched_ids;
+        for (size_t i = 0; i < items.size(); ++i) {
+            matched_ids.clear();
+            subscriptions_.query(items[i].longitude, items[i].latitude, matched_ids);
+            for (uint64_t id : matched_ids) {
+                matched_items[id].push_back(i);
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<WebSocketSession>> full_sessions;
+    std::vector<std::pair<std::shared_ptr<WebSocketSession>, const std::vector<size_t>*>> viewport_sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        full_sessions.reserve(sessions_.size());
+        for (const auto& entry : sessions_) {
+            if (!entry.second->hasViewport()) {
+                full_sessions.push_back(entry.second);
+            }
+        }
+        for (const auto& match : matched_items) {
+            auto it = sessions_.find(match.first);
+            if (it != sessions_.end()) {
+                viewport_sessions.emplace_back(it->second, &match.second);
+            }
+        }
+    }
+
+    // 未设置视域的会话：整批一条消息
+    for (const auto& session : full_sessions) {
+        try {
+            if (!session->getStream().is_open()) {
+                continue;
+            }
+            bool binary = binary_batch && session->getWireFormat() == WireFormat::Binary;
+
+            // 正在同步快照的会话逐条暂存，切换时按实体去重
+            if (session->isSyncing() && !items.empty()) {
+                for (const BroadcastItem& item : items) {
+                    if (binary && item.binary_message) {
+                        session->send(item.binary_message, item.key, true, item.seq);
+                    } else if (item.json_message) {
+                        session->send(item.json_message, item.key, false, item.seq);
+                    }
+                }
+                continue;
+            }
+
+            if (binary) {
+                session->send(binary_batch, std::string(), true, batch_seq);
+            } else {
+                session->send(json_batch, std::string(), false, batch_seq);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error broadcasting batch: " << e.what() << std::endl;
+        }
+    }
+
+    // 设置视域的会话：逐条发送视域内的更新，按实体ID参与背压合并
+    for (const auto& entry : viewport_sessions) {
+        const auto& session = entry.first;
+        try {
+            if (!session->getStream().is_open()) {
+                continue;
+            }
+            bool binary = session->getWireFormat() == WireFormat::Binary;
+            for (size_t index : *entry.second) {
+                const BroadcastItem& item = items[index];
+                if (binary && item.binary_message) {
+                    session->send(item.binary_message, item.key, true, item.seq);
+                } else if (item.json_message) {
+                    session->send(item.json_message, item.key, false, item.seq);
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error broadcasting batch: " << e.what() << std::endl;
+        }
+    }
+}
+
+// 设置会话的视域订阅
+void WebSocketServer::subscribeViewport(const std::shared_ptr<WebSocketSession>& session,
+                                        const GeoBounds& bounds) {
+    if (!session) {
+        return;
+    }
+    subscriptions_.subscribe(session->getId(), bounds);
+    session->setHasViewport(true);
+}
+
+// 取消会话的视域订阅
+void WebSocketServer::unsubscribeViewport(const std::shared_ptr<WebSocketSession>& session) {
+    if (!session) {
+        return;
+    }
+    session->setHasViewport(false);
+    subscriptions_.unsubscribe(session->getId());
+}
+
+// 获取所有会话的写队列统计
+std::vector<SessionQueueStats> WebSocketServer::getSessionQueueStats() {
+    std::vector<std::shared_ptr<WebSocketSession>> session_snapshot;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        session_snapshot.reserve(sessions_.size());
+        for (const auto& entry : sessions_) {
+            session_snapshot.push_back(entry.second);
+        }
+    }
+
+    std::vector<SessionQueueStats> stats;
+    stats.reserve(session_snapshot.size());
+    for (const auto& session : session_snapshot) {
+        stats.push_back(session->getQueueStats());
+    }
+    return stats;
+}
+
 // 向特定会话发送消息
 void WebSocketServer::sendTo(const std::shared_ptr<WebSocketSession>& session, const std::string& message) {
     if (session) {
         try {
-            // 创建消息的副本，确保在多线程环境中安全
-            std::string message_copy = message;
-            session->send(message_copy);
+            session->send(message);
         } catch (const std::exception& e) {
             std::cerr << "Error sending message to specific session: " << e.what() << std::endl;
         }
     }
 }
 
+// 选择新连接所在的执行器
+net::any_io_executor WebSocketServer::sessionExecutor(net::io_context* pinned_context) {
+    if (pinned_context) {
+        return pinned_context->get_executor();
+    }
+    if (io_pool_) {
+        // 单线程运行的 io_context 不需要 strand
+        return io_pool_->getNextIoContext().get_executor();
+    }
+    return net::make_strand(ioc_);
+}
+
 // 接受新连接
-void WebSocketServer::doAccept() {
-    acceptor_.async_accept(
-        net::make_strand(ioc_),
+void WebSocketServer::doAccept(tcp::acceptor& acceptor, net::io_context* pinned_context) {
+    acceptor.async_accept(
+        sessionExecutor(pinned_context),
         beast::bind_front_handler(
-            [this](beast::error_code ec, tcp::socket socket) {
+            [this, &acceptor, pinned_context](beast::error_code ec, tcp::socket socket) {
                 if (!ec) {
                     // 创建新的 WebSocket 会话
                     auto session = std::make_shared<WebSocketSession>(
@@ -372,14 +1031,24 @@ void WebSocketServer::doAccept() {
                         },
                         [this](const std::shared_ptr<WebSocketSession>& session, bool connected) {
                             try {
+                                bool binary = session->getWireFormat() == WireFormat::Binary;
                                 if (connected) {
-                                    // 这里不需要做任何事情，会话已经在下方添加到了sessions_集合
+                                    // 握手完成后才加入会话集合，避免向未完成握手的会话广播
+                                    std::lock_guard<std::mutex> lock(sessions_mutex_);
+                                    sessions_.emplace(session->getId(), session);
+                                    if (binary) {
+                                        ++binary_sessions_;
+                                    }
                                 } else {
-                                    // 断开连接时从集合中移除会话
+                                    // 断开连接时从集合和视域索引中移除会话
+                                    subscriptions_.unsubscribe(session->getId());
                                     std::lock_guard<std::mutex> lock(sessions_mutex_);
-                                    auto it = sessions_.find(session);
-                                    if (it != sessions_.end()) {
-                                        sessions_.erase(it);
+                                    if (sessions_.erase(session->getId()) == 0) {
+                                        // 握手未完成的会话不通知上层
+                                        return;
+                                    }
+                                    if (binary) {
+                                        --binary_sessions_;
                                     }
                                 }
 
@@ -389,22 +1058,15 @@ void WebSocketServer::doAccept() {
                             } catch (const std::exception& e) {
                                 std::cerr << "Error in connection handler: " << e.what() << std::endl;
                             }
-                        });
-
-                    // 将会话添加到集合中
-                    {
-                        std::lock_guard<std::mutex> lock(sessions_mutex_);
-                        sessions_.insert(session);
-                    }
+                        },
+                        session_options_,
+                        &syncing_sessions_);
 
-                    // 启动会话
+                    // 启动会话（握手完成后由连接处理器加入会话集合）
                     try {
                         session->run();
                     } catch (const std::exception& e) {
                         std::cerr << "Error starting WebSocket session: " << e.what() << std::endl;
-                        // 如果启动失败，从集合中移除会话
-                        std::lock_guard<std::mutex> lock(sessions_mutex_);
-                        sessions_.erase(session);
                     }
                 } else {
                     std::cerr << "Accept error: " << ec.message() << std::endl;
@@ -412,7 +1074,7 @@ void WebSocketServer::doAccept() {
 
                 // 如果服务器仍在运行，继续接受连接
                 if (running_) {
-                    doAccept();
+                    doAccept(acceptor, pinned_context);
                 }
             }));
 }
@@ -0,0 +1,185 @@
+// HTTP 响应压缩基准测试
+//
+// 构造与 GET /tracks 相同格式的 JSON 响应体（100 到 10000 条航迹），对比压缩级别 1/6/9 的
+// 压缩率、单次压缩耗时和吞吐量，并按不同链路带宽估算传输时间，衡量带宽与 CPU 的取舍。
+// 同时对比两种压缩上下文用法的耗时与每次压缩的堆分配次数：
+//   fresh  - 每次压缩新建 deflate_stream 和输出缓冲区（约 256KB 内部缓冲区每次重新分配）
+//   reused - compressResponse 使用的线程局部上下文和输出缓冲区
+
+#include "http_compression.h"
+
+#include <boost/beast/zlib/deflate_stream.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 全局分配计数
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+using namespace cesium_server;
+namespace zlib = boost::beast::zlib;
+
+// 生成 GET /tracks 格式的响应体
+static std::string makeTracksBody(size_t count) {
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<double> lon(73.0, 135.0);
+	std::uniform_real_distribution<double> lat(18.0, 53.0);
+	std::uniform_real_distribution<double> alt(0.0, 12000.0);
+	std::uniform_real_distribution<double> heading(0.0, 360.0);
+
+	std::ostringstream ss;
+	ss << std::setprecision(10);
+	ss << "{\"status\":\"ok\",\"count\":" << count << ",\"tracks\":[";
+	for (size_t i = 0; i < count; ++i) {
+		if (i > 0) {
+			ss << ",";
+		}
+		ss << "{\"id\":\"entity-" << i << "\",\"longitude\":" << lon(rng)
+		   << ",\"latitude\":" << lat(rng) << ",\"altitude\":" << alt(rng)
+		   << ",\"heading\":" << heading(rng) << ",\"speed\":" << (i % 300)
+		   << ",\"timestamp\":" << (1700000000000LL + static_cast<long long>(i)) << "}";
+	}
+	ss << "]}";
+	return ss.str();
+}
+
+// 每次新建压缩上下文和输出缓冲区，输出与 compress() 相同的 gzip 格式
+static size_t compressFresh(int level, const std::string& input) {
+	static const char header[10] = {0x1f, static_cast<char>(0x8b), 0x08, 0, 0, 0, 0, 0, 0, static_cast<char>(0xff)};
+
+	zlib::deflate_stream stream;
+	stream.reset(level, 15, 8, zlib::Strategy::normal);
+	std::string out(header, sizeof(header));
+	out.resize(sizeof(header) + stream.upper_bound(input.size()) + 8);
+
+	zlib::z_params zs;
+	zs.next_in = input.data();
+	zs.avail_in = input.size();
+	zs.next_out = &out[sizeof(header)];
+	zs.avail_out = out.size() - sizeof(header) - 8;
+	boost::beast::error_code ec;
+	stream.write(zs, zlib::Flush::finish, ec);
+
+	size_t offset = sizeof(header) + zs.total_out;
+	uint32_t crc = crc32(0, reinterpret_cast<const unsigned char*>(input.data()), input.size());
+	uint32_t isize = static_cast<uint32_t>(input.size());
+	out.resize(offset + 8);
+	for (int i = 0; i < 4; ++i) {
+		out[offset + i] = static_cast<char>((crc >> (8 * i)) & 0xFF);
+		out[offset + 4 + i] = static_cast<char>((isize >> (8 * i)) & 0xFF);
+	}
+	return out.size();
+}
+
+struct Result {
+	double micros = 0;          // 每次压缩耗时（微秒）
+	double allocations = 0;     // 每次压缩的堆分配次数
+	size_t output_size = 0;
+};
+
+template<class F>
+static Result measure(size_t iterations, F&& compress_once) {
+	compress_once();    // 预热（线程局部上下文在第一次调用时分配）
+
+	Result result;
+	size_t allocations_before = g_allocations.load();
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < iterations; ++i) {
+		result.output_size = compress_once();
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	result.micros = std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+	result.allocations = static_cast<double>(g_allocations.load() - allocations_before) / iterations;
+	return result;
+}
+
+int main() {
+	const size_t track_counts[] = {100, 1000, 10000};
+	const int levels[] = {1, 6, 9};
+	const double links_mbps[] = {10, 100, 1000};
+
+	std::cout << std::fixed << std::setprecision(2);
+
+	for (size_t tracks : track_counts) {
+		std::string body = makeTracksBody(tracks);
+		size_t iterations = tracks >= 10000 ? 20 : (tracks >= 1000 ? 200 : 2000);
+
+		std::cout << "\n/tracks with " << tracks << " tracks, body " << body.size() << " bytes" << std::endl;
+		std::cout << std::left << std::setw(7) << "level"
+		          << std::right << std::setw(12) << "gzip bytes"
+		          << std::setw(8) << "ratio"
+		          << std::setw(12) << "fresh us"
+		          << std::setw(12) << "reused us"
+		          << std::setw(14) << "fresh allocs"
+		          << std::setw(15) << "reused allocs"
+		          << std::setw(10) << "MB/s";
+		for (double mbps : links_mbps) {
+			std::cout << std::setw(12) << ("ms@" + std::to_string(static_cast<int>(mbps)) + "M");
+		}
+		std::cout << std::endl;
+
+		// 不压缩的基线：只有传输时间
+		std::cout << std::left << std::setw(7) << "none"
+		          << std::right << std::setw(12) << body.size()
+		          << std::setw(8) << 1.0
+		          << std::setw(12) << "-" << std::setw(12) << "-"
+		          << std::setw(14) << "-" << std::setw(15) << "-" << std::setw(10) << "-";
+		for (double mbps : links_mbps) {
+			std::cout << std::setw(12) << body.size() * 8.0 / (mbps * 1000.0);
+		}
+		std::cout << std::endl;
+
+		for (int level : levels) {
+			Result fresh = measure(iterations, [&] { return compressFresh(level, body); });
+
+			std::string out;
+			Result reused = measure(iterations, [&] {
+				compress(ContentCoding::Gzip, level, body.data(), body.size(), out);
+				return out.size();
+			});
+
+			double ratio = static_cast<double>(body.size()) / reused.output_size;
+			double throughput = body.size() / reused.micros;    // 字节/微秒 = MB/s
+
+			std::cout << std::left << std::setw(7) << level
+			          << std::right << std::setw(12) << reused.output_size
+			          << std::setw(8) << ratio
+			          << std::setw(12) << fresh.micros
+			          << std::setw(12) << reused.micros
+			          << std::setw(14) << fresh.allocations
+			          << std::setw(15) << reused.allocations
+			          << std::setw(10) << throughput;
+			// 压缩耗时 + 压缩后的传输时间
+			for (double mbps : links_mbps) {
+				std::cout << std::setw(12) << reused.micros / 1000.0 + reused.output_size * 8.0 / (mbps * 1000.0);
+			}
+			std::cout << std::endl;
+		}
+	}
+
+	return 0;
+}
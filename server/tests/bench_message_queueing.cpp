@@ -0,0 +1,118 @@
+// 消息排队策略微基准测试
+//
+// 对比把同一条消息放入多个真实 WebSocketSession 写队列的两种方式：send(const std::string&)
+// 为每个会话复制一份消息（广播改为共享缓冲区之前的做法），send(SharedMessage) 让所有会话
+// 引用同一个 shared_ptr<const std::string>。统计每次“广播”的堆分配次数与耗时。
+//
+// 会话建立在未连接的套接字上，io_context 不运行：消息只进入会话的写队列，不会写出，
+// 也不经过 WebSocketServer 的会话表和视域索引。消息不带实体ID，不触发按实体合并。
+// 结果反映入队路径本身的开销，不代表包括网络写出在内的端到端开销。
+
+#include "websocket_server.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace cesium_server;
+
+// 全局分配计数
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+// 构造一条典型的坐标更新消息
+std::string makeMessage() {
+	return "{\"type\":\"coordinates_update\",\"id\":\"entity-1024\",\"longitude\":116.39123456,"
+		"\"latitude\":39.90734567,\"altitude\":52.5,\"heading\":271.25,\"timestamp\":1700000000000000000,"
+		"\"shipName\":\"test-ship-1024\",\"source\":\"udp\"}";
+}
+
+struct Result {
+	double allocations_per_broadcast;
+	double microseconds_per_broadcast;
+};
+
+template <typename Broadcast>
+Result run(size_t session_count, size_t broadcasts, Broadcast broadcast) {
+	// io_context 最后析构：会话的套接字和投递到其上的 startWrite 都引用它
+	net::io_context ioc;
+
+	// 队列上限留足余量，测量期间不丢弃消息
+	WebSocketSessionOptions options;
+	options.backpressure.max_queue_messages = broadcasts + 16;
+	options.backpressure.max_queue_bytes = (broadcasts + 16) * 1024;
+
+	std::vector<std::shared_ptr<WebSocketSession>> sessions;
+	for (size_t i = 0; i < session_count; ++i) {
+		sessions.push_back(std::make_shared<WebSocketSession>(tcp::socket(ioc), nullptr, nullptr, options));
+	}
+
+	// 预热：第一条消息会投递 startWrite，之后会话处于写出中，后续消息只入队
+	broadcast(sessions, makeMessage());
+
+	size_t allocations = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < broadcasts; ++i) {
+		std::string message = makeMessage();
+		size_t before = g_allocations.load(std::memory_order_relaxed);
+		broadcast(sessions, std::move(message));
+		allocations += g_allocations.load(std::memory_order_relaxed) - before;
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+
+	return {
+		static_cast<double>(allocations) / broadcasts,
+		std::chrono::duration<double, std::micro>(elapsed).count() / broadcasts
+	};
+}
+
+int main(int argc, char* argv[]) {
+	size_t broadcasts = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+	const size_t session_counts[] = {1, 100, 2000};
+
+	std::cout << "sessions  copying(allocs/us)      shared(allocs/us)" << std::endl;
+	for (size_t session_count : session_counts) {
+		// 每个会话一份副本：send(const std::string&) 内部为每个会话 make_shared 一次
+		Result copying = run(session_count, broadcasts,
+			[](std::vector<std::shared_ptr<WebSocketSession>>& sessions, std::string message) {
+				for (const auto& session : sessions) {
+					session->send(message);
+				}
+			});
+
+		// 共享缓冲区：序列化结果移动进一个 shared_ptr，所有会话只增加引用计数
+		Result shared = run(session_count, broadcasts,
+			[](std::vector<std::shared_ptr<WebSocketSession>>& sessions, std::string message) {
+				auto shared_message = std::make_shared<const std::string>(std::move(message));
+				for (const auto& session : sessions) {
+					session->send(shared_message);
+				}
+			});
+
+		std::cout << session_count << "\t  "
+			<< copying.allocations_per_broadcast << " / " << copying.microseconds_per_broadcast << "\t\t"
+			<< shared.allocations_per_broadcast << " / " << shared.microseconds_per_broadcast << std::endl;
+	}
+
+	return 0;
+}
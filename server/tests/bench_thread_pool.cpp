@@ -0,0 +1,200 @@
+// 线程池任务吞吐量基准测试
+//
+// 对比旧实现（单一队列 + 单一互斥锁，每个任务 packaged_task + shared_ptr + std::function）
+// 与工作窃取线程池的 enqueue / post，线程数从 1 到 64。
+// 两种负载：
+//   flat   - 外部线程直接提交全部任务
+//   nested - 外部提交少量父任务，每个父任务在工作线程内再提交子任务
+
+#include "thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cesium_server;
+
+// 旧版线程池（单一队列）
+class LegacyThreadPool {
+public:
+	explicit LegacyThreadPool(size_t threads) : stop_(false) {
+		for (size_t i = 0; i < threads; ++i) {
+			workers_.emplace_back([this] {
+				while (true) {
+					std::function<void()> task;
+					{
+						std::unique_lock<std::mutex> lock(queue_mutex_);
+						condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+						if (stop_ && tasks_.empty()) {
+							return;
+						}
+						task = std::move(tasks_.front());
+						tasks_.pop();
+					}
+					task();
+				}
+			});
+		}
+	}
+
+	template<class F>
+	std::future<void> enqueue(F&& f) {
+		auto task = std::make_shared<std::packaged_task<void()>>(std::forward<F>(f));
+		std::future<void> res = task->get_future();
+		{
+			std::unique_lock<std::mutex> lock(queue_mutex_);
+			tasks_.emplace([task]() { (*task)(); });
+		}
+		condition_.notify_one();
+		return res;
+	}
+
+	~LegacyThreadPool() {
+		{
+			std::unique_lock<std::mutex> lock(queue_mutex_);
+			stop_ = true;
+		}
+		condition_.notify_all();
+		for (auto& worker : workers_) {
+			worker.join();
+		}
+	}
+
+private:
+	std::vector<std::thread> workers_;
+	std::queue<std::function<void()>> tasks_;
+	std::mutex queue_mutex_;
+	std::condition_variable condition_;
+	bool stop_;
+};
+
+constexpr size_t kTotalTasks = 400000;
+constexpr size_t kParentTasks = 400;
+constexpr size_t kChildrenPerParent = kTotalTasks / kParentTasks;
+
+// 模拟少量计算
+inline void spinWork(std::atomic<size_t>& done) {
+	volatile unsigned value = 0;
+	for (unsigned i = 0; i < 64; ++i) {
+		value = value + i;
+	}
+	done.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 等待全部任务完成
+void waitFor(const std::atomic<size_t>& done, size_t expected) {
+	while (done.load(std::memory_order_relaxed) < expected) {
+		std::this_thread::yield();
+	}
+}
+
+// 运行一次测试并返回每秒任务数
+template<typename Submit>
+double measure(size_t expected, std::atomic<size_t>& done, Submit&& submit) {
+	done.store(0);
+	auto start = std::chrono::steady_clock::now();
+	submit();
+	waitFor(done, expected);
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	return expected / seconds;
+}
+
+void printRow(const std::string& name, size_t threads, double legacy, double enqueue, double post) {
+	std::cout << std::left << std::setw(8) << name
+	          << std::right << std::setw(8) << threads
+	          << std::setw(14) << legacy / 1e6
+	          << std::setw(14) << enqueue / 1e6
+	          << std::setw(14) << post / 1e6
+	          << std::setw(10) << post / legacy << "x" << std::endl;
+}
+
+int main() {
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "tasks: " << kTotalTasks << " (Mtasks/s)" << std::endl;
+	std::cout << std::left << std::setw(8) << "load"
+	          << std::right << std::setw(8) << "threads"
+	          << std::setw(14) << "legacy"
+	          << std::setw(14) << "enqueue"
+	          << std::setw(14) << "post"
+	          << std::setw(11) << "speedup" << std::endl;
+
+	const size_t thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+	std::atomic<size_t> done{0};
+
+	for (size_t threads : thread_counts) {
+		double legacy, enqueue, post;
+
+		// flat：外部线程提交所有任务
+		{
+			LegacyThreadPool pool(threads);
+			legacy = measure(kTotalTasks, done, [&] {
+				for (size_t i = 0; i < kTotalTasks; ++i) {
+					pool.enqueue([&done] { spinWork(done); });
+				}
+			});
+		}
+		{
+			ThreadPool pool(threads);
+			enqueue = measure(kTotalTasks, done, [&] {
+				for (size_t i = 0; i < kTotalTasks; ++i) {
+					pool.enqueue([&done] { spinWork(done); });
+				}
+			});
+			post = measure(kTotalTasks, done, [&] {
+				for (size_t i = 0; i < kTotalTasks; ++i) {
+					pool.post([&done] { spinWork(done); });
+				}
+			});
+		}
+		printRow("flat", threads, legacy, enqueue, post);
+
+		// nested：父任务在工作线程内提交子任务
+		{
+			LegacyThreadPool pool(threads);
+			legacy = measure(kTotalTasks, done, [&] {
+				for (size_t p = 0; p < kParentTasks; ++p) {
+					pool.enqueue([&pool, &done] {
+						for (size_t c = 0; c < kChildrenPerParent; ++c) {
+							pool.enqueue([&done] { spinWork(done); });
+						}
+					});
+				}
+			});
+		}
+		{
+			ThreadPool pool(threads);
+			enqueue = measure(kTotalTasks, done, [&] {
+				for (size_t p = 0; p < kParentTasks; ++p) {
+					pool.enqueue([&pool, &done] {
+						for (size_t c = 0; c < kChildrenPerParent; ++c) {
+							pool.enqueue([&done] { spinWork(done); });
+						}
+					});
+				}
+			});
+			post = measure(kTotalTasks, done, [&] {
+				for (size_t p = 0; p < kParentTasks; ++p) {
+					pool.post([&pool, &done] {
+						for (size_t c = 0; c < kChildrenPerParent; ++c) {
+							pool.post([&done] { spinWork(done); });
+						}
+					});
+				}
+			});
+		}
+		printRow("nested", threads, legacy, enqueue, post);
+	}
+
+	return 0;
+}
@@ -0,0 +1,192 @@
+// HTTP 吞吐量负载测试
+//
+// 用多个并发客户端请求同一路径（默认 /coordinates），对比三种方式的每秒请求数：
+//   close      - 每个请求新建 TCP 连接（Connection: close）
+//   keep-alive - 每个客户端复用一个连接，逐个请求
+//   pipelined  - 每个客户端复用一个连接，一次发送 depth 个请求后再依次读取响应
+//
+// 用法：load_test_http [host] [port] [clients] [requests_per_client] [path] [depth]
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+struct LoadTestConfig {
+	std::string host = "127.0.0.1";
+	std::string port = "3000";
+	size_t clients = 8;
+	size_t requests_per_client = 2000;
+	std::string path = "/coordinates";
+	size_t depth = 8;
+};
+
+enum class Mode {
+	Close,
+	KeepAlive,
+	Pipelined
+};
+
+const char* modeName(Mode mode) {
+	switch (mode) {
+	case Mode::Close:
+		return "close";
+	case Mode::KeepAlive:
+		return "keep-alive";
+	case Mode::Pipelined:
+		return "pipelined";
+	}
+	return "";
+}
+
+http::request<http::empty_body> makeRequest(const LoadTestConfig& config, bool keep_alive) {
+	http::request<http::empty_body> req{http::verb::get, config.path, 11};
+	req.set(http::field::host, config.host);
+	req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+	req.keep_alive(keep_alive);
+	return req;
+}
+
+// 单个客户端：返回成功完成的请求数
+size_t runClient(const LoadTestConfig& config, Mode mode, std::atomic<size_t>& errors) {
+	net::io_context ioc;
+	tcp::resolver resolver(ioc);
+	auto endpoints = resolver.resolve(config.host, config.port);
+
+	size_t completed = 0;
+	beast::flat_buffer buffer;
+
+	try {
+		if (mode == Mode::Close) {
+			auto req = makeRequest(config, false);
+			for (size_t i = 0; i < config.requests_per_client; ++i) {
+				beast::tcp_stream stream(ioc);
+				stream.connect(endpoints);
+				http::write(stream, req);
+
+				http::response<http::string_body> res;
+				http::read(stream, buffer, res);
+				if (res.result() == http::status::ok) {
+					++completed;
+				} else {
+					++errors;
+				}
+
+				beast::error_code ec;
+				stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+			}
+			return completed;
+		}
+
+		beast::tcp_stream stream(ioc);
+		stream.connect(endpoints);
+		stream.socket().set_option(tcp::no_delay(true));
+		auto req = makeRequest(config, true);
+		size_t depth = mode == Mode::Pipelined ? std::max<size_t>(config.depth, 1) : 1;
+
+		size_t sent = 0;
+		while (sent < config.requests_per_client) {
+			size_t batch = std::min(depth, config.requests_per_client - sent);
+
+			// 流水线：先连续发送一批请求，再按顺序读取响应
+			for (size_t i = 0; i < batch; ++i) {
+				http::write(stream, req);
+			}
+			for (size_t i = 0; i < batch; ++i) {
+				http::response<http::string_body> res;
+				http::read(stream, buffer, res);
+				if (res.result() == http::status::ok) {
+					++completed;
+				} else {
+					++errors;
+				}
+				if (!res.keep_alive()) {
+					// 服务器达到单连接请求上限后关闭连接，重新连接继续
+					beast::error_code ec;
+					stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+					stream.close();
+					stream.connect(endpoints);
+					stream.socket().set_option(tcp::no_delay(true));
+					buffer.clear();
+					batch = i + 1;
+					break;
+				}
+			}
+			sent += batch;
+		}
+
+		beast::error_code ec;
+		stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+	} catch (const std::exception& e) {
+		std::cerr << modeName(mode) << " client error: " << e.what() << std::endl;
+		++errors;
+	}
+
+	return completed;
+}
+
+void runMode(const LoadTestConfig& config, Mode mode) {
+	std::atomic<size_t> completed{0};
+	std::atomic<size_t> errors{0};
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> clients;
+	for (size_t i = 0; i < config.clients; ++i) {
+		clients.emplace_back([&] {
+			completed += runClient(config, mode, errors);
+		});
+	}
+	for (auto& client : clients) {
+		client.join();
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+	std::cout << std::left << std::setw(12) << modeName(mode)
+	          << std::right << std::setw(10) << completed.load()
+	          << std::setw(8) << errors.load()
+	          << std::setw(12) << std::fixed << std::setprecision(1) << completed.load() / seconds
+	          << std::setw(12) << std::setprecision(3) << seconds * 1000.0 * config.clients / std::max<size_t>(completed.load(), 1)
+	          << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	LoadTestConfig config;
+	if (argc > 1) config.host = argv[1];
+	if (argc > 2) config.port = argv[2];
+	if (argc > 3) config.clients = std::strtoul(argv[3], nullptr, 10);
+	if (argc > 4) config.requests_per_client = std::strtoul(argv[4], nullptr, 10);
+	if (argc > 5) config.path = argv[5];
+	if (argc > 6) config.depth = std::strtoul(argv[6], nullptr, 10);
+
+	std::cout << "GET http://" << config.host << ":" << config.port << config.path
+	          << "  clients=" << config.clients
+	          << " requests/client=" << config.requests_per_client
+	          << " depth=" << config.depth << std::endl;
+	std::cout << std::left << std::setw(12) << "mode"
+	          << std::right << std::setw(10) << "ok"
+	          << std::setw(8) << "errors"
+	          << std::setw(12) << "req/s"
+	          << std::setw(12) << "ms/req" << std::endl;
+
+	runMode(config, Mode::Close);
+	runMode(config, Mode::KeepAlive);
+	runMode(config, Mode::Pipelined);
+
+	return 0;
+}
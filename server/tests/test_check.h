@@ -0,0 +1,47 @@
+#pragma once
+
+// 单元测试共用的检查宏和航迹构造函数
+//
+// 测试不依赖测试框架：CHECK 失败时打印条件和位置并计数，main 以 testResult 的返回值退出，
+// ctest 按退出码判断成败。
+
+#include "track_store.h"
+
+#include <iostream>
+#include <string>
+
+namespace cesium_server {
+namespace test {
+
+// 失败的检查数
+inline int failures = 0;
+
+// 输出结果并返回进程退出码
+inline int testResult(const char* suite) {
+	if (failures > 0) {
+		std::cout << failures << " check(s) failed" << std::endl;
+		return 1;
+	}
+	std::cout << "All " << suite << " tests passed" << std::endl;
+	return 0;
+}
+
+// 只有 ID 和位置的航迹
+inline Track makeTrack(const std::string& id, double longitude = 0.0, double latitude = 0.0) {
+	Track track;
+	track.id = id;
+	track.longitude = longitude;
+	track.latitude = latitude;
+	return track;
+}
+
+} // namespace test
+} // namespace cesium_server
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			std::cout << "  FAILED: " << #cond << " (" << __FILE__ << ":" << __LINE__ << ")" << std::endl; \
+			++::cesium_server::test::failures; \
+		} \
+	} while (0)
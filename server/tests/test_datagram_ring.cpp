@@ -0,0 +1,179 @@
+// DatagramRing 单元测试
+//
+// 覆盖容量取整和过大数据报的拒绝、队列满时入队失败、认领与部分释放（已认领未释放的槽位不会被覆盖）、
+// 多轮回绕后的内容与发送者/数据源编号，以及多个生产者并发入队时每个生产者的数据报按序出队且不丢不重。
+
+#include "datagram_ring.h"
+#include "test_check.h"
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cesium_server;
+namespace net = boost::asio;
+using udp = boost::asio::ip::udp;
+
+static udp::endpoint endpoint(unsigned short port) {
+	return udp::endpoint(net::ip::make_address("10.0.0.1"), port);
+}
+
+static bool push(DatagramRing& ring, const std::string& text, unsigned short port = 1000, size_t feed = 0) {
+	return ring.tryPush(text.data(), text.size(), endpoint(port), feed);
+}
+
+static std::string claimed(const DatagramRing& ring, size_t i) {
+	return std::string(ring.data(i), ring.size(i));
+}
+
+// Capacity is rounded up to a power of two; datagrams larger than a slot are rejected
+static void testCapacity() {
+	std::cout << "capacity" << std::endl;
+	CHECK(DatagramRing(5, 16).capacity() == 8);
+	CHECK(DatagramRing(8, 16).capacity() == 8);
+	CHECK(DatagramRing(0, 16).capacity() == 2);
+
+	DatagramRing ring(4, 8);
+	CHECK(ring.slotSize() == 8);
+	CHECK(push(ring, "12345678"));
+	CHECK(!push(ring, "123456789"));
+	CHECK(ring.size() == 1);
+}
+
+// A full ring rejects pushes until slots are released, not merely claimed
+static void testFull() {
+	std::cout << "full ring" << std::endl;
+	DatagramRing ring(4, 16);
+	CHECK(ring.empty());
+	for (int i = 0; i < 4; ++i) {
+		CHECK(push(ring, "d" + std::to_string(i)));
+	}
+	CHECK(!push(ring, "d4"));
+	CHECK(ring.size() == 4);
+	CHECK(!ring.empty());
+
+	// Claimed slots are still referenced by the consumer and stay occupied
+	CHECK(ring.claim(2) == 2);
+	CHECK(!push(ring, "d4"));
+	CHECK(claimed(ring, 0) == "d0");
+	CHECK(claimed(ring, 1) == "d1");
+
+	// Partial release frees exactly the released slots
+	ring.release(1);
+	CHECK(ring.size() == 3);
+	CHECK(push(ring, "d4"));
+	CHECK(!push(ring, "d5"));
+	CHECK(claimed(ring, 0) == "d1");
+	ring.release(1);
+
+	CHECK(ring.claim(10) == 3);
+	CHECK(claimed(ring, 0) == "d2");
+	CHECK(claimed(ring, 2) == "d4");
+	ring.release(3);
+	CHECK(ring.empty());
+	CHECK(ring.size() == 0);
+	CHECK(ring.claim(10) == 0);
+}
+
+// Many laps around the ring keep contents, senders and feeds intact
+static void testWrap() {
+	std::cout << "wrap around" << std::endl;
+	DatagramRing ring(4, 32);
+	size_t next_push = 0;
+	size_t next_pop = 0;
+	bool all_match = true;
+	for (int lap = 0; lap < 100; ++lap) {
+		// Uneven batch sizes so claims straddle the end of the buffer
+		size_t batch = 1 + lap % 4;
+		for (size_t i = 0; i < batch; ++i) {
+			unsigned short port = static_cast<unsigned short>(2000 + next_push % 1000);
+			all_match = push(ring, "datagram-" + std::to_string(next_push), port, next_push % 3) && all_match;
+			++next_push;
+		}
+		size_t count = ring.claim(batch);
+		all_match = all_match && count == batch;
+		for (size_t i = 0; i < count; ++i, ++next_pop) {
+			all_match = all_match && claimed(ring, i) == "datagram-" + std::to_string(next_pop) &&
+				ring.sender(i) == endpoint(static_cast<unsigned short>(2000 + next_pop % 1000)) &&
+				ring.feed(i) == next_pop % 3;
+		}
+		ring.release(count);
+	}
+	CHECK(all_match);
+	CHECK(next_pop == next_push);
+	CHECK(ring.empty());
+}
+
+// Concurrent producers: every accepted datagram comes out once, in per-producer order
+static void testConcurrentProducers() {
+	std::cout << "concurrent producers" << std::endl;
+	const size_t kProducers = 4;
+	const uint32_t kPerProducer = 20000;
+	DatagramRing ring(64, 16);
+
+	std::atomic<size_t> accepted{0};
+	std::atomic<size_t> done{0};
+	std::vector<std::thread> producers;
+	for (size_t p = 0; p < kProducers; ++p) {
+		producers.emplace_back([&, p]() {
+			char data[8];
+			for (uint32_t i = 0; i < kPerProducer; ++i) {
+				std::memcpy(data, &i, sizeof(i));
+				// Retry a few times, then drop like the receive thread does
+				for (int attempt = 0; attempt < 100; ++attempt) {
+					if (ring.tryPush(data, sizeof(i), endpoint(static_cast<unsigned short>(p)), p)) {
+						accepted.fetch_add(1, std::memory_order_relaxed);
+						break;
+					}
+					std::this_thread::yield();
+				}
+			}
+			done.fetch_add(1, std::memory_order_release);
+		});
+	}
+
+	std::vector<int64_t> last(kProducers, -1);
+	size_t received = 0;
+	bool ordered = true;
+	for (;;) {
+		bool finished = done.load(std::memory_order_acquire) == kProducers;
+		size_t count = ring.claim(16);
+		for (size_t i = 0; i < count; ++i) {
+			uint32_t value = 0;
+			std::memcpy(&value, ring.data(i), sizeof(value));
+			size_t p = ring.feed(i);
+			ordered = ordered && ring.size(i) == sizeof(value) && p < kProducers &&
+				ring.sender(i).port() == p && static_cast<int64_t>(value) > last[p];
+			if (p < kProducers) {
+				last[p] = value;
+			}
+		}
+		ring.release(count);
+		received += count;
+		if (count == 0) {
+			if (finished) {
+				break;
+			}
+			std::this_thread::yield();
+		}
+	}
+	for (auto& producer : producers) {
+		producer.join();
+	}
+
+	CHECK(ordered);
+	CHECK(received == accepted.load());
+	CHECK(ring.empty());
+}
+
+int main() {
+	testCapacity();
+	testFull();
+	testWrap();
+	testConcurrentProducers();
+
+	return test::testResult("datagram ring");
+}
@@ -0,0 +1,201 @@
+// HTTP 持久连接期限测试
+//
+// 在回环地址上启动 HttpServer，客户端缩小接收缓冲区并延迟读取，让大响应的写出持续超过空闲超时，检查：
+//   - 持久连接上第二个大响应（路由响应和静态文件）不会被空闲超时或第一个请求留下的期限中断
+//   - 响应写完后空闲超时仍然关闭连接
+//   - 客户端一直不读取时写超时关闭连接
+
+#include "http_server.h"
+#include "test_check.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace cesium_server;
+namespace fs = std::filesystem;
+
+// 大于回环连接上两端内核缓冲区之和，写出必须等待客户端读取
+static const size_t kLargeBody = 32 * 1024 * 1024;
+
+// Synchronous-looking client whose reads have a deadline
+class TestClient {
+public:
+	explicit TestClient(unsigned short port) : socket_(ioc_) {
+		socket_.open(tcp::v4());
+		// Small receive window so the server blocks on the large response
+		socket_.set_option(net::socket_base::receive_buffer_size(64 * 1024));
+		socket_.connect(tcp::endpoint(net::ip::make_address("127.0.0.1"), port));
+	}
+
+	void get(const std::string& target) {
+		http::request<http::empty_body> req{http::verb::get, target, 11};
+		req.set(http::field::host, "127.0.0.1");
+		req.keep_alive(true);
+		http::write(socket_, req);
+	}
+
+	// Read one response; returns the error (beast::error::timeout if the deadline passed)
+	beast::error_code read(http::response<http::string_body>& res, std::chrono::milliseconds timeout) {
+		http::response_parser<http::string_body> parser;
+		parser.body_limit(kLargeBody * 2);
+		beast::error_code result = beast::error::timeout;
+		bool done = false;
+		http::async_read(socket_, buffer_, parser, [&](beast::error_code ec, std::size_t) {
+			result = ec;
+			done = true;
+		});
+		ioc_.restart();
+		ioc_.run_for(timeout);
+		if (!done) {
+			beast::error_code ignored;
+			socket_.cancel(ignored);
+			ioc_.restart();
+			ioc_.run();
+			result = beast::error::timeout;
+		}
+		if (!result) {
+			res = parser.release();
+		}
+		return result;
+	}
+
+private:
+	net::io_context ioc_;
+	tcp::socket socket_;
+	beast::flat_buffer buffer_;
+};
+
+// Server with a small and a large route, optionally serving a large static file
+class TestServer {
+public:
+	TestServer(unsigned short port, const KeepAliveOptions& keep_alive, const std::string& static_root = "")
+		: server_("127.0.0.1", port, 1) {
+		server_.setKeepAliveOptions(keep_alive);
+		server_.addRoute(http::verb::get, "/small", [](const http::request<http::string_body>& req, const RouteParams&) {
+			http::response<http::string_body> res{http::status::ok, req.version()};
+			res.body() = "ok";
+			res.prepare_payload();
+			return res;
+		});
+		server_.addRoute(http::verb::get, "/large", [](const http::request<http::string_body>& req, const RouteParams&) {
+			http::response<http::string_body> res{http::status::ok, req.version()};
+			res.body().assign(kLargeBody, 'x');
+			res.prepare_payload();
+			return res;
+		});
+		if (!static_root.empty()) {
+			StaticFileOptions options;
+			options.root = static_root;
+			server_.setStaticFiles(options);
+		}
+		server_.run();
+	}
+
+	~TestServer() {
+		server_.stop();
+	}
+
+private:
+	HttpServer server_;
+};
+
+static KeepAliveOptions keepAlive(int idle_seconds, int write_seconds, size_t pipeline_limit = 8) {
+	KeepAliveOptions options;
+	options.idle_timeout = std::chrono::seconds(idle_seconds);
+	options.write_timeout = std::chrono::seconds(write_seconds);
+	options.pipeline_limit = pipeline_limit;
+	return options;
+}
+
+// Small request, then a large response read only after the idle timeout has passed
+static void readSlowSecondResponse(unsigned short port, const std::string& target, size_t expected_size) {
+	TestClient client(port);
+	http::response<http::string_body> res;
+
+	client.get("/small");
+	CHECK(!client.read(res, std::chrono::seconds(5)));
+	CHECK(res.body() == "ok");
+
+	client.get(target);
+	std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+	beast::error_code ec = client.read(res, std::chrono::seconds(20));
+	if (ec) {
+		std::cout << "  second response: " << ec.message() << std::endl;
+	}
+	CHECK(!ec);
+	CHECK(res.result() == http::status::ok);
+	CHECK(res.body().size() == expected_size);
+
+	// The idle timeout starts once the response is written, and still closes the connection
+	ec = client.read(res, std::chrono::seconds(5));
+	CHECK(ec == http::error::end_of_stream);
+}
+
+// A large route response on a keep-alive connection outlives the idle timeout
+static void testSlowResponse() {
+	std::cout << "slow second response" << std::endl;
+	TestServer server(19320, keepAlive(1, 30));
+	readSlowSecondResponse(19320, "/large", kLargeBody);
+}
+
+// With a pipeline limit of 1 the next read starts after the write; the next write still gets a fresh deadline
+static void testWriteDeadlineAfterIdleRead() {
+	std::cout << "write deadline after idle read" << std::endl;
+	TestServer server(19321, keepAlive(1, 30, 1));
+	readSlowSecondResponse(19321, "/large", kLargeBody);
+}
+
+// A large static file sent with sendfile outlives the idle timeout too
+static void testSlowFileResponse(const std::string& root) {
+	std::cout << "slow static file response" << std::endl;
+	TestServer server(19322, keepAlive(1, 30), root);
+	readSlowSecondResponse(19322, "/large.bin", kLargeBody);
+}
+
+// A client that stops reading is disconnected after the write timeout
+static void testWriteTimeout(const std::string& root) {
+	std::cout << "write timeout" << std::endl;
+	TestServer server(19323, keepAlive(30, 1), root);
+	const char* targets[] = {"/large", "/large.bin"};
+	for (const char* target : targets) {
+		TestClient client(19323);
+		client.get(target);
+		std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+		http::response<http::string_body> res;
+		beast::error_code ec = client.read(res, std::chrono::seconds(20));
+		if (!ec) {
+			std::cout << "  " << target << " was written completely" << std::endl;
+		}
+		CHECK(ec);
+	}
+}
+
+int main() {
+	fs::path root = fs::temp_directory_path() / "cesium_http_keep_alive_test";
+	try {
+		fs::create_directories(root);
+		{
+			std::ofstream file(root / "large.bin", std::ios::binary);
+			std::string chunk(1024 * 1024, 'f');
+			for (size_t i = 0; i < kLargeBody / chunk.size(); ++i) {
+				file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+			}
+		}
+
+		testSlowResponse();
+		testWriteDeadlineAfterIdleRead();
+		testSlowFileResponse(root.string());
+		testWriteTimeout(root.string());
+	} catch (const std::exception& e) {
+		std::cout << "Error occurred during testing: " << e.what() << std::endl;
+		fs::remove_all(root);
+		return 1;
+	}
+
+	fs::remove_all(root);
+	return test::testResult("HTTP keep-alive");
+}
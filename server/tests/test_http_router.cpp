@@ -0,0 +1,210 @@
+// HttpRouter 单元测试
+//
+// 覆盖静态路由、参数 {name}、通配符 * 和 {name*} 的匹配，静态 > 参数 > 通配符的优先级，
+// 静态分支失败后回退到参数分支，方法不匹配时返回允许的方法列表，以及非法模式的拒绝。
+
+#include "http_router.h"
+#include "test_check.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace cesium_server;
+
+// Handler whose response body names the route it was registered for
+static RouteHandler named(const std::string& name) {
+	return [name](const http::request<http::string_body>&, const RouteParams&) {
+		http::response<http::string_body> res{http::status::ok, 11};
+		res.body() = name;
+		return res;
+	};
+}
+
+// Match and return the name of the matched route, or "" when nothing matched
+// Parameters are views into path, so callers pass string literals that outlive params
+static std::string route(const HttpRouter& router, http::verb method, std::string_view path,
+	RouteParams& params, const std::string** allow = nullptr) {
+	const RouteHandler* handler = router.match(method, path, params, allow);
+	if (!handler) {
+		return "";
+	}
+	http::request<http::string_body> req{method, std::string(path), 11};
+	return (*handler)(req, params).body();
+}
+
+static void addRoutes(HttpRouter& router) {
+	router.add(http::verb::get, "/tracks", named("list"));
+	router.add(http::verb::get, "/tracks/{id}", named("get"));
+	router.add(http::verb::delete_, "/tracks/{id}", named("delete"));
+	router.add(http::verb::post, "/tracks/batch", named("batch"));
+	router.add(http::verb::get, "/tracks/{id}/history/{day}", named("history"));
+	router.add(http::verb::get, "/team", named("team"));
+	router.add(http::verb::get, "/static/*", named("static"));
+	router.add(http::verb::get, "/files/{path*}", named("files"));
+	router.add(http::verb::get, "/files/readme", named("readme"));
+	router.add(http::verb::unknown, "/echo", named("echo"));
+}
+
+// Static routes, including prefixes shared through node splits
+static void testStatic() {
+	std::cout << "static routes" << std::endl;
+	HttpRouter router;
+	addRoutes(router);
+	RouteParams params;
+
+	CHECK(router.size() == 10);
+	CHECK(route(router, http::verb::get, "/tracks", params) == "list");
+	CHECK(params.size() == 0);
+	CHECK(route(router, http::verb::get, "/team", params) == "team");
+	CHECK(route(router, http::verb::get, "/te", params).empty());
+	CHECK(route(router, http::verb::get, "/teams", params).empty());
+	CHECK(route(router, http::verb::get, "/", params).empty());
+
+	// Any-method routes accept every supported method
+	CHECK(route(router, http::verb::get, "/echo", params) == "echo");
+	CHECK(route(router, http::verb::put, "/echo", params) == "echo");
+}
+
+// Parameters capture exactly one non-empty segment
+static void testParams() {
+	std::cout << "parameters" << std::endl;
+	HttpRouter router;
+	addRoutes(router);
+	RouteParams params;
+
+	CHECK(route(router, http::verb::get, "/tracks/ship-1", params) == "get");
+	CHECK(params.size() == 1);
+	CHECK(params.get("id") == "ship-1");
+	CHECK(params.get("missing").empty());
+	CHECK(params.path() == "/tracks/ship-1");
+
+	CHECK(route(router, http::verb::get, "/tracks/ship-1/history/2024-01-01", params) == "history");
+	CHECK(params.size() == 2);
+	CHECK(params.get("id") == "ship-1");
+	CHECK(params.get("day") == "2024-01-01");
+
+	CHECK(route(router, http::verb::delete_, "/tracks/ship-2", params) == "delete");
+	CHECK(params.get("id") == "ship-2");
+
+	// Empty segments and extra segments do not match
+	CHECK(route(router, http::verb::get, "/tracks/", params).empty());
+	CHECK(route(router, http::verb::get, "/tracks/ship-1/other", params).empty());
+	CHECK(params.size() == 0);
+}
+
+// Wildcards take the rest of the path, including an empty rest
+static void testWildcards() {
+	std::cout << "wildcards" << std::endl;
+	HttpRouter router;
+	addRoutes(router);
+	RouteParams params;
+
+	CHECK(route(router, http::verb::get, "/static/js/app.js", params) == "static");
+	CHECK(params.size() == 1);
+	CHECK(params.get("") == "js/app.js");
+	CHECK(route(router, http::verb::get, "/static/", params) == "static");
+	CHECK(params.get("").empty());
+
+	CHECK(route(router, http::verb::get, "/files/a/b/c.txt", params) == "files");
+	CHECK(params.get("path") == "a/b/c.txt");
+
+	// Static beats wildcard, but only for the exact path
+	CHECK(route(router, http::verb::get, "/files/readme", params) == "readme");
+	CHECK(route(router, http::verb::get, "/files/readme.md", params) == "files");
+	CHECK(params.get("path") == "readme.md");
+}
+
+// A static branch that fails (wrong method or dead end) falls back to parameters
+static void testBacktracking() {
+	std::cout << "backtracking" << std::endl;
+	HttpRouter router;
+	addRoutes(router);
+	RouteParams params;
+
+	// /tracks/batch only has POST: GET falls back to /tracks/{id}
+	CHECK(route(router, http::verb::post, "/tracks/batch", params) == "batch");
+	CHECK(params.size() == 0);
+	CHECK(route(router, http::verb::get, "/tracks/batch", params) == "get");
+	CHECK(params.get("id") == "batch");
+
+	// "batchy" shares the static prefix but is a different segment
+	CHECK(route(router, http::verb::get, "/tracks/batchy", params) == "get");
+	CHECK(params.get("id") == "batchy");
+
+	// Parameters captured on a failed branch are discarded
+	CHECK(route(router, http::verb::get, "/tracks/batch/history/d1", params) == "history");
+	CHECK(params.size() == 2);
+	CHECK(params.get("id") == "batch");
+	CHECK(params.get("day") == "d1");
+}
+
+// Known path with the wrong method reports the allowed methods
+static void testMethodNotAllowed() {
+	std::cout << "method not allowed" << std::endl;
+	HttpRouter router;
+	addRoutes(router);
+	RouteParams params;
+
+	const std::string* allow = nullptr;
+	CHECK(route(router, http::verb::put, "/tracks/ship-1", params, &allow).empty());
+	CHECK(allow != nullptr);
+	if (allow) {
+		CHECK(*allow == "GET, DELETE");
+	}
+
+	allow = nullptr;
+	CHECK(route(router, http::verb::get, "/unknown", params, &allow).empty());
+	CHECK(allow == nullptr);
+}
+
+// Invalid patterns and duplicates are rejected
+static void testInvalidPatterns() {
+	std::cout << "invalid patterns" << std::endl;
+	const char* invalid[] = {
+		"", "tracks", "/tracks/{}", "/tracks/{id", "/static/*/more", "/tracks/{id}x"
+	};
+	for (const char* pattern : invalid) {
+		HttpRouter router;
+		bool thrown = false;
+		try {
+			router.add(http::verb::get, pattern, named("x"));
+		} catch (const std::invalid_argument&) {
+			thrown = true;
+		}
+		if (!thrown) {
+			std::cout << "  pattern accepted: " << pattern << std::endl;
+		}
+		CHECK(thrown);
+	}
+
+	HttpRouter router;
+	addRoutes(router);
+	bool duplicate = false;
+	try {
+		router.add(http::verb::get, "/tracks/{id}", named("again"));
+	} catch (const std::invalid_argument&) {
+		duplicate = true;
+	}
+	CHECK(duplicate);
+
+	bool conflicting = false;
+	try {
+		router.add(http::verb::put, "/tracks/{name}", named("conflict"));
+	} catch (const std::invalid_argument&) {
+		conflicting = true;
+	}
+	CHECK(conflicting);
+}
+
+int main() {
+	testStatic();
+	testParams();
+	testWildcards();
+	testBacktracking();
+	testMethodNotAllowed();
+	testInvalidPatterns();
+
+	return test::testResult("HTTP router");
+}
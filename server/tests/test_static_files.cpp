@@ -0,0 +1,313 @@
+// StaticFileHandler 单元测试
+//
+// 在临时目录中准备文件和预压缩版本，直接调用 serve 检查：
+//   - 越出根目录的路径（..、百分号编码的 ..、反斜杠、NUL）被拒绝
+//   - 区间请求：普通、后缀、开放结尾、越界（416）、多区间、If-Range
+//   - 按 Accept-Encoding 选择 .br/.gz 版本，以及 If-None-Match 命中时的 304
+
+#include "static_files.h"
+#include "test_check.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace cesium_server;
+namespace fs = std::filesystem;
+
+static void writeFile(const fs::path& path, const std::string& content) {
+	fs::create_directories(path.parent_path());
+	std::ofstream file(path, std::ios::binary);
+	file << content;
+}
+
+// GET (or the given method) request for the target
+static http::request<http::string_body> request(const std::string& target,
+	http::verb method = http::verb::get) {
+	http::request<http::string_body> req{method, target, 11};
+	req.set(http::field::host, "localhost");
+	return req;
+}
+
+// serve() on a fresh response; returns false when the handler declines the request
+static bool serve(StaticFileHandler& handler, const http::request<http::string_body>& req, FileResponse& res) {
+	res = FileResponse();
+	return handler.serve(req, res);
+}
+
+static std::string header(const FileResponse& res, http::field field) {
+	return std::string(res.header[field]);
+}
+
+// Paths that escape the root are declined, even when the target file exists
+static void testTraversal(StaticFileHandler& handler) {
+	std::cout << "path traversal" << std::endl;
+	FileResponse res;
+
+	// The file the traversal attempts point at really exists one level above the root
+	const char* rejected[] = {
+		"/../secret.txt",
+		"/assets/../../secret.txt",
+		"/assets/..",
+		"/%2e%2e/secret.txt",
+		"/%2E%2e/secret.txt",
+		"/assets/%2e%2e%2f%2e%2e/secret.txt",
+		"/..\\secret.txt",
+		"/..%5csecret.txt",
+		"/%5c..%5csecret.txt",
+		"/app.js%00.png",
+		"/app.js%00",
+		"/%",
+		"/%2",
+		"/%zz.txt",
+		"secret.txt",
+	};
+	for (const char* target : rejected) {
+		bool served = serve(handler, request(target), res);
+		if (served) {
+			std::cout << "  served " << target << " as " << res.path << std::endl;
+		}
+		CHECK(!served);
+	}
+
+	// ".." only counts as a whole path segment; the query string is not part of the path
+	CHECK(serve(handler, request("/..data.txt"), res));
+	CHECK(res.path.find("..data.txt") != std::string::npos);
+	CHECK(serve(handler, request("/app.js?next=/../secret.txt"), res));
+	CHECK(res.header.result() == http::status::ok);
+	CHECK(serve(handler, request("/%61pp.js"), res));
+	CHECK(res.path.size() > 7 && res.path.compare(res.path.size() - 7, 7, "/app.js") == 0);
+}
+
+// Single ranges are answered with 206 and the file section; bad ones with 416 or the whole file
+static void testRanges(StaticFileHandler& handler) {
+	std::cout << "ranges" << std::endl;
+	FileResponse res;
+	auto ranged = [&](const std::string& range, const std::string& if_range = "") {
+		auto req = request("/data.bin");
+		req.set(http::field::range, range);
+		if (!if_range.empty()) {
+			req.set(http::field::if_range, if_range);
+		}
+		CHECK(serve(handler, req, res));
+		return res.header.result();
+	};
+
+	// data.bin is 100 bytes
+	CHECK(ranged("bytes=10-19") == http::status::partial_content);
+	CHECK(res.offset == 10 && res.length == 10);
+	CHECK(header(res, http::field::content_range) == "bytes 10-19/100");
+	CHECK(res.header.has_content_length() && res.header[http::field::content_length] == "10");
+	CHECK(!res.path.empty());
+
+	// Suffix: the last n bytes, all of them when n exceeds the size
+	CHECK(ranged("bytes=-30") == http::status::partial_content);
+	CHECK(res.offset == 70 && res.length == 30);
+	CHECK(header(res, http::field::content_range) == "bytes 70-99/100");
+	CHECK(ranged("bytes=-500") == http::status::partial_content);
+	CHECK(res.offset == 0 && res.length == 100);
+
+	// Open-ended and past-the-end last byte are clamped to the file
+	CHECK(ranged("bytes=95-") == http::status::partial_content);
+	CHECK(res.offset == 95 && res.length == 5);
+	CHECK(header(res, http::field::content_range) == "bytes 95-99/100");
+	CHECK(ranged("bytes=50-1000") == http::status::partial_content);
+	CHECK(res.offset == 50 && res.length == 50);
+	CHECK(ranged("bytes=99-99") == http::status::partial_content);
+	CHECK(res.offset == 99 && res.length == 1);
+
+	// Out of range: 416 with the size and no body
+	CHECK(ranged("bytes=100-") == http::status::range_not_satisfiable);
+	CHECK(header(res, http::field::content_range) == "bytes */100");
+	CHECK(res.path.empty() && res.length == 0);
+	CHECK(res.header[http::field::content_length] == "0");
+	CHECK(ranged("bytes=500-600") == http::status::range_not_satisfiable);
+	CHECK(ranged("bytes=-0") == http::status::range_not_satisfiable);
+
+	// Malformed, reversed and multi-range requests get the whole file
+	const char* whole[] = {"bytes=20-10", "bytes=a-b", "items=0-10", "bytes=0-1,5-6", "bytes=", "bytes=5"};
+	for (const char* range : whole) {
+		CHECK(ranged(range) == http::status::ok);
+		CHECK(res.offset == 0 && res.length == 100);
+		CHECK(!res.header.count(http::field::content_range));
+	}
+
+	// If-Range: the range applies only while the ETag still matches
+	CHECK(serve(handler, request("/data.bin"), res));
+	std::string etag = header(res, http::field::etag);
+	CHECK(!etag.empty());
+	CHECK(ranged("bytes=0-9", etag) == http::status::partial_content);
+	CHECK(res.length == 10);
+	CHECK(ranged("bytes=0-9", "\"stale\"") == http::status::ok);
+	CHECK(res.length == 100);
+	CHECK(ranged("bytes=500-", "\"stale\"") == http::status::ok);
+
+	// Range applies to GET only; HEAD reports the whole file without a body to send
+	auto head = request("/data.bin", http::verb::head);
+	head.set(http::field::range, "bytes=0-9");
+	CHECK(serve(handler, head, res));
+	CHECK(res.header.result() == http::status::ok);
+	CHECK(res.header[http::field::content_length] == "100");
+	CHECK(res.path.empty());
+}
+
+// .br is preferred over .gz when both are acceptable; ranges always use the original file
+static void testVariants(StaticFileHandler& handler) {
+	std::cout << "precompressed variants" << std::endl;
+	FileResponse res;
+	auto get = [&](const std::string& target, const std::string& accept_encoding) {
+		auto req = request(target);
+		if (!accept_encoding.empty()) {
+			req.set(http::field::accept_encoding, accept_encoding);
+		}
+		CHECK(serve(handler, req, res));
+		return header(res, http::field::content_encoding);
+	};
+	auto endsWith = [](const std::string& text, const std::string& suffix) {
+		return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+	};
+
+	CHECK(get("/app.js", "") == "");
+	CHECK(endsWith(res.path, "/app.js"));
+	CHECK(res.length == 40);
+	CHECK(header(res, http::field::vary) == "Accept-Encoding");
+	CHECK(header(res, http::field::content_type) == "text/javascript; charset=utf-8");
+	std::string identity_etag = header(res, http::field::etag);
+
+	CHECK(get("/app.js", "gzip, deflate, br") == "br");
+	CHECK(endsWith(res.path, "/app.js.br"));
+	CHECK(res.length == 10);
+	CHECK(header(res, http::field::content_type) == "text/javascript; charset=utf-8");
+	std::string br_etag = header(res, http::field::etag);
+	CHECK(br_etag != identity_etag);
+
+	CHECK(get("/app.js", "gzip") == "gzip");
+	CHECK(endsWith(res.path, "/app.js.gz"));
+	CHECK(res.length == 20);
+	CHECK(header(res, http::field::etag) != br_etag);
+
+	CHECK(get("/app.js", "br;q=0, gzip;q=0.5") == "gzip");
+	CHECK(get("/app.js", "BR") == "br");
+	CHECK(get("/app.js", "br;q=0, gzip;q=0") == "");
+	CHECK(res.length == 40);
+	CHECK(get("/app.js", "identity") == "");
+
+	// Only a .gz variant exists
+	CHECK(get("/style.css", "gzip, br") == "gzip");
+	CHECK(endsWith(res.path, "/style.css.gz"));
+
+	// No variants: no Content-Encoding and no Vary
+	CHECK(get("/data.bin", "gzip, br") == "");
+	CHECK(!res.header.count(http::field::vary));
+	CHECK(res.length == 100);
+
+	// Ranges are served from the original file
+	auto ranged = request("/app.js");
+	ranged.set(http::field::accept_encoding, "br");
+	ranged.set(http::field::range, "bytes=0-4");
+	CHECK(serve(handler, ranged, res));
+	CHECK(res.header.result() == http::status::partial_content);
+	CHECK(!res.header.count(http::field::content_encoding));
+	CHECK(endsWith(res.path, "/app.js"));
+	CHECK(header(res, http::field::content_range) == "bytes 0-4/40");
+}
+
+// If-None-Match matching the ETag of the selected representation gives 304 without a body
+static void testNotModified(StaticFileHandler& handler) {
+	std::cout << "not modified" << std::endl;
+	FileResponse res;
+	auto conditional = [&](const std::string& if_none_match, const std::string& accept_encoding) {
+		auto req = request("/app.js");
+		req.set(http::field::if_none_match, if_none_match);
+		if (!accept_encoding.empty()) {
+			req.set(http::field::accept_encoding, accept_encoding);
+		}
+		CHECK(serve(handler, req, res));
+		return res.header.result();
+	};
+
+	CHECK(serve(handler, request("/app.js"), res));
+	std::string identity_etag = header(res, http::field::etag);
+	auto br = request("/app.js");
+	br.set(http::field::accept_encoding, "br");
+	CHECK(serve(handler, br, res));
+	std::string br_etag = header(res, http::field::etag);
+
+	CHECK(conditional(identity_etag, "") == http::status::not_modified);
+	CHECK(res.path.empty() && res.length == 0);
+	CHECK(!res.header.count(http::field::content_type));
+	CHECK(header(res, http::field::etag) == identity_etag);
+
+	CHECK(conditional(br_etag, "br") == http::status::not_modified);
+	CHECK(header(res, http::field::content_encoding) == "br");
+	CHECK(conditional("\"other\", " + br_etag, "br") == http::status::not_modified);
+	CHECK(conditional("W/" + identity_etag, "") == http::status::not_modified);
+	CHECK(conditional("*", "") == http::status::not_modified);
+
+	// The ETag of another representation does not match
+	CHECK(conditional(identity_etag, "br") == http::status::ok);
+	CHECK(!res.path.empty());
+	CHECK(conditional(br_etag, "") == http::status::ok);
+	CHECK(conditional("\"stale\"", "") == http::status::ok);
+
+	// ETags are derived from size and modification time, so a fresh handler computes the same one
+	StaticFileOptions options;
+	options.root = handler.root();
+	StaticFileHandler fresh(options);
+	CHECK(serve(fresh, request("/app.js"), res));
+	CHECK(header(res, http::field::etag) == identity_etag);
+}
+
+// Directories, the SPA fallback and missing files
+static void testLookup(StaticFileHandler& handler) {
+	std::cout << "lookup" << std::endl;
+	FileResponse res;
+	CHECK(serve(handler, request("/"), res));
+	CHECK(res.path.find("index.html") != std::string::npos);
+	CHECK(serve(handler, request("/tracks/view"), res));
+	CHECK(res.path.find("index.html") != std::string::npos);
+	CHECK(!serve(handler, request("/missing.js"), res));
+	CHECK(!serve(handler, request("/app.js", http::verb::post), res));
+
+	CHECK(serve(handler, request("/assets/chunk.js"), res));
+	CHECK(header(res, http::field::cache_control) == "public, max-age=31536000, immutable");
+	CHECK(serve(handler, request("/app.js"), res));
+	CHECK(header(res, http::field::cache_control) == "no-cache");
+}
+
+int main() {
+	fs::path base = fs::temp_directory_path() / "cesium_static_files_test";
+	fs::path root = base / "public";
+	try {
+		fs::remove_all(base);
+		writeFile(base / "secret.txt", "secret");
+		writeFile(root / "index.html", "<html></html>");
+		writeFile(root / "app.js", std::string(40, 'a'));
+		writeFile(root / "app.js.br", std::string(10, 'b'));
+		writeFile(root / "app.js.gz", std::string(20, 'g'));
+		writeFile(root / "style.css", std::string(30, 'c'));
+		writeFile(root / "style.css.gz", std::string(15, 'g'));
+		writeFile(root / "data.bin", std::string(100, 'd'));
+		writeFile(root / "..data.txt", "dots");
+		writeFile(root / "assets" / "chunk.js", "chunk");
+
+		StaticFileOptions options;
+		options.root = root.string() + "/";
+		options.metadata_ttl = std::chrono::milliseconds(0);
+		StaticFileHandler handler(options);
+
+		testTraversal(handler);
+		testRanges(handler);
+		testVariants(handler);
+		testNotModified(handler);
+		testLookup(handler);
+	} catch (const std::exception& e) {
+		std::cout << "Error occurred during testing: " << e.what() << std::endl;
+		fs::remove_all(base);
+		return 1;
+	}
+
+	fs::remove_all(base);
+	return test::testResult("static file");
+}
@@ -0,0 +1,153 @@
+// SubscriptionIndex 单元测试
+//
+// 覆盖普通视域和跨越 180° 经线的视域（包括东西边界落在同一网格列的情况）、范围边界和极点、
+// 重新订阅与取消订阅，并用随机视域和随机点与 GeoBounds::contains 逐一对照。
+
+#include "subscription_index.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace cesium_server;
+
+static GeoBounds box(double west, double south, double east, double north) {
+	GeoBounds bounds;
+	bounds.west = west;
+	bounds.south = south;
+	bounds.east = east;
+	bounds.north = north;
+	return bounds;
+}
+
+// Sorted session ids whose viewport contains the point
+static std::vector<uint64_t> query(const SubscriptionIndex& index, double longitude, double latitude) {
+	std::vector<uint64_t> out;
+	index.query(longitude, latitude, out);
+	std::sort(out.begin(), out.end());
+	return out;
+}
+
+using Ids = std::vector<uint64_t>;
+
+// Ordinary boxes, including edges that fall on cell boundaries
+static void testPlainBoxes() {
+	std::cout << "plain boxes" << std::endl;
+	SubscriptionIndex index(10.0);
+	index.subscribe(1, box(100.0, 20.0, 130.0, 40.0));
+	index.subscribe(2, box(125.0, 35.0, 140.0, 50.0));
+	index.subscribe(3, GeoBounds());
+	CHECK(index.size() == 3);
+
+	CHECK(query(index, 110.0, 30.0) == Ids({1, 3}));
+	CHECK(query(index, 128.0, 38.0) == Ids({1, 2, 3}));
+	CHECK(query(index, 135.0, 45.0) == Ids({2, 3}));
+	CHECK(query(index, 100.0, 20.0) == Ids({1, 3}));
+	CHECK(query(index, 130.0, 40.0) == Ids({1, 2, 3}));
+	CHECK(query(index, 99.9, 30.0) == Ids({3}));
+	CHECK(query(index, -60.0, -30.0) == Ids({3}));
+
+	// The whole-globe box covers the outermost cells
+	CHECK(query(index, 180.0, 90.0) == Ids({3}));
+	CHECK(query(index, -180.0, -90.0) == Ids({3}));
+}
+
+// Boxes crossing the antimeridian
+static void testAntimeridian() {
+	std::cout << "antimeridian" << std::endl;
+	SubscriptionIndex index(10.0);
+	index.subscribe(1, box(170.0, -10.0, -170.0, 10.0));
+	// West and east edges land in the same column: the box spans almost the whole globe
+	index.subscribe(2, box(175.0, -10.0, 172.0, 10.0));
+	// Adjacent columns: both segments together cover the whole row
+	index.subscribe(3, box(-165.0, -10.0, -171.0, 10.0));
+
+	CHECK(query(index, 175.0, 0.0) == Ids({1, 2, 3}));
+	CHECK(query(index, -175.0, 0.0) == Ids({1, 2, 3}));
+	CHECK(query(index, 180.0, 0.0) == Ids({1, 2, 3}));
+	CHECK(query(index, -180.0, 0.0) == Ids({1, 2, 3}));
+	CHECK(query(index, 0.0, 0.0) == Ids({2, 3}));
+	CHECK(query(index, -90.0, 5.0) == Ids({2, 3}));
+	CHECK(query(index, 173.5, 0.0) == Ids({1, 3}));
+	CHECK(query(index, -168.0, 0.0) == Ids({2}));
+	CHECK(query(index, 0.0, 20.0).empty());
+
+	// Unsubscribing clears every cell the box was indexed in
+	index.unsubscribe(2);
+	index.unsubscribe(3);
+	CHECK(query(index, 0.0, 0.0).empty());
+	CHECK(query(index, 175.0, 0.0) == Ids({1}));
+	index.unsubscribe(1);
+	CHECK(index.size() == 0);
+	CHECK(query(index, 175.0, 0.0).empty());
+}
+
+// Re-subscribing replaces the previous box
+static void testResubscribe() {
+	std::cout << "resubscribe" << std::endl;
+	SubscriptionIndex index(10.0);
+	index.subscribe(7, box(175.0, -10.0, 172.0, 10.0));
+	index.subscribe(7, box(10.0, 10.0, 20.0, 20.0));
+	CHECK(index.size() == 1);
+	CHECK(query(index, 0.0, 0.0).empty());
+	CHECK(query(index, 15.0, 15.0) == Ids({7}));
+
+	index.unsubscribe(7);
+	index.unsubscribe(7);
+	CHECK(query(index, 15.0, 15.0).empty());
+}
+
+// Random boxes and points agree with GeoBounds::contains, for several cell sizes
+static void testMatchesContains() {
+	std::cout << "random boxes" << std::endl;
+	std::mt19937 gen(12345);
+	std::uniform_real_distribution<> lon(-180.0, 180.0);
+	std::uniform_real_distribution<> lat(-90.0, 90.0);
+
+	const double cell_sizes[] = {10.0, 7.0, 45.0};
+	for (double cell_size : cell_sizes) {
+		SubscriptionIndex index(cell_size);
+		std::vector<GeoBounds> boxes;
+		for (uint64_t id = 0; id < 200; ++id) {
+			double south = lat(gen);
+			double north = lat(gen);
+			if (south > north) {
+				std::swap(south, north);
+			}
+			// About half the boxes have west > east and cross the antimeridian
+			GeoBounds bounds = box(lon(gen), south, lon(gen), north);
+			boxes.push_back(bounds);
+			index.subscribe(id, bounds);
+		}
+
+		size_t mismatches = 0;
+		for (int i = 0; i < 5000; ++i) {
+			double longitude = lon(gen);
+			double latitude = lat(gen);
+			Ids expected;
+			for (uint64_t id = 0; id < boxes.size(); ++id) {
+				if (boxes[id].contains(longitude, latitude)) {
+					expected.push_back(id);
+				}
+			}
+			if (query(index, longitude, latitude) != expected) {
+				++mismatches;
+			}
+		}
+		if (mismatches > 0) {
+			std::cout << "  cell size " << cell_size << ": " << mismatches << " mismatching points" << std::endl;
+		}
+		CHECK(mismatches == 0);
+	}
+}
+
+int main() {
+	testPlainBoxes();
+	testAntimeridian();
+	testResubscribe();
+	testMatchesContains();
+
+	return test::testResult("subscription index");
+}
@@ -0,0 +1,229 @@
+// ThreadPool 单元测试
+//
+// 覆盖 resize 扩容与缩容、缩容时退出线程把本地队列移交全局队列后任务不丢失、
+// 排队数与活跃数快照不超过已提交的任务数，以及按排队时间水位的自适应扩容和缩容。
+
+#include "thread_pool.h"
+#include "test_check.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace cesium_server;
+using namespace std::chrono_literals;
+
+// Poll until the condition holds or the timeout passes
+template <typename Fn>
+static bool waitFor(Fn&& condition, std::chrono::milliseconds timeout) {
+	auto deadline = std::chrono::steady_clock::now() + timeout;
+	while (!condition()) {
+		if (std::chrono::steady_clock::now() >= deadline) {
+			return false;
+		}
+		std::this_thread::sleep_for(1ms);
+	}
+	return true;
+}
+
+// resize starts threads that really run concurrently, and idle threads retire on shrink
+static void testResize() {
+	std::cout << "resize" << std::endl;
+	ThreadPool pool(2, 16);
+	CHECK(pool.getThreadCount() == 2);
+
+	pool.resize(6);
+	CHECK(pool.getThreadCount() == 6);
+	CHECK(pool.getStats().target_threads == 6);
+
+	// Six tasks that only finish once all six are running at the same time
+	std::atomic<int> running{0};
+	std::atomic<int> finished{0};
+	for (int i = 0; i < 6; ++i) {
+		pool.post([&]() {
+			++running;
+			waitFor([&]() { return running.load() == 6; }, 5000ms);
+			++finished;
+		});
+	}
+	CHECK(waitFor([&]() { return finished.load() == 6; }, 5000ms));
+	CHECK(running.load() == 6);
+
+	pool.resize(2);
+	CHECK(pool.getStats().target_threads == 2);
+	CHECK(waitFor([&]() { return pool.getThreadCount() == 2; }, 5000ms));
+
+	// Requests beyond the capacity are clamped
+	pool.resize(100);
+	CHECK(pool.getThreadCount() == 16);
+	pool.resize(1);
+	CHECK(waitFor([&]() { return pool.getThreadCount() == 1; }, 5000ms));
+
+	std::atomic<int> after{0};
+	for (int i = 0; i < 100; ++i) {
+		pool.post([&]() { ++after; });
+	}
+	CHECK(waitFor([&]() { return after.load() == 100; }, 5000ms));
+}
+
+// Workers retiring with tasks in their local queues hand them over; nothing is lost
+static void testRetireHandoff() {
+	std::cout << "retire handoff" << std::endl;
+	ThreadPool pool(8, 16);
+	const int kOuter = 8;
+	const int kInner = 2000;
+
+	std::atomic<int> executed{0};
+	std::atomic<int> started{0};
+	for (int round = 0; round < 5; ++round) {
+		executed = 0;
+		started = 0;
+		pool.resize(8);
+		// Tasks posted from a worker go to that worker's local queue
+		for (int i = 0; i < kOuter; ++i) {
+			pool.post([&]() {
+				for (int j = 0; j < kInner; ++j) {
+					pool.post([&]() {
+						++executed;
+						if (executed.load(std::memory_order_relaxed) % 256 == 0) {
+							std::this_thread::yield();
+						}
+					});
+				}
+				++started;
+				++executed;
+			});
+		}
+		// Shrink while the local queues are full
+		waitFor([&]() { return started.load() > 0; }, 5000ms);
+		pool.resize(1);
+
+		bool all_done = waitFor([&]() { return executed.load() == kOuter * (kInner + 1); }, 10000ms);
+		if (!all_done) {
+			std::cout << "  round " << round << ": " << executed.load() << " of " << kOuter * (kInner + 1)
+				<< " tasks ran" << std::endl;
+		}
+		CHECK(all_done);
+		CHECK(waitFor([&]() { return pool.getThreadCount() == 1; }, 5000ms));
+	}
+
+	ThreadPoolStats stats = pool.getStats();
+	CHECK(stats.queued_tasks == 0);
+	CHECK(waitFor([&]() { return pool.getStats().active_tasks == 0; }, 1000ms));
+}
+
+// queued + active in one snapshot never exceeds the tasks submitted before it was taken
+static void testStatsSnapshot() {
+	std::cout << "stats snapshot" << std::endl;
+	ThreadPool pool(4, 8);
+	std::atomic<uint64_t> submitted{0};
+	std::atomic<uint64_t> executed{0};
+	std::atomic<bool> producing{true};
+	std::atomic<bool> consistent{true};
+	std::atomic<uint64_t> samples{0};
+
+	std::thread sampler([&]() {
+		while (producing.load()) {
+			// Tasks are counted as submitted before they are pushed, and as executed before they finish:
+			// reading executed before and submitted after the snapshot bounds what it may contain
+			uint64_t done = executed.load();
+			ThreadPoolStats stats = pool.getStats();
+			uint64_t total = submitted.load();
+			if (stats.queued_tasks + stats.active_tasks > total ||
+				stats.queued_tasks + done > total ||
+				stats.active_tasks > 8) {
+				consistent = false;
+			}
+			++samples;
+		}
+	});
+
+	std::vector<std::thread> producers;
+	for (int p = 0; p < 3; ++p) {
+		producers.emplace_back([&]() {
+			for (int i = 0; i < 20000; ++i) {
+				submitted.fetch_add(1);
+				pool.post([&]() {
+					// Local submissions from inside the pool are counted too
+					if (executed.load(std::memory_order_relaxed) % 64 == 0) {
+						submitted.fetch_add(1);
+						pool.post([&]() { executed.fetch_add(1); });
+					}
+					executed.fetch_add(1);
+				});
+			}
+		});
+	}
+	// Resizing during the run exercises the retire handoff under load
+	for (size_t threads : {8, 2, 6, 1, 4}) {
+		pool.resize(threads);
+		std::this_thread::sleep_for(10ms);
+	}
+	for (auto& producer : producers) {
+		producer.join();
+	}
+
+	CHECK(waitFor([&]() { return executed.load() == submitted.load(); }, 10000ms));
+	producing = false;
+	sampler.join();
+
+	CHECK(consistent.load());
+	CHECK(samples.load() > 0);
+	CHECK(waitFor([&]() {
+		ThreadPoolStats stats = pool.getStats();
+		return stats.queued_tasks == 0 && stats.active_tasks == 0;
+	}, 1000ms));
+	CHECK(pool.getStats().completed_tasks == submitted.load());
+}
+
+// Queue wait above the high watermark grows the pool; idle intervals below the low watermark shrink it
+static void testAdaptive() {
+	std::cout << "adaptive watermarks" << std::endl;
+	ThreadPool pool(1, 8);
+	AdaptivePoolOptions options;
+	options.enabled = true;
+	options.min_threads = 1;
+	options.max_threads = 8;
+	options.high_watermark = std::chrono::microseconds(2000);
+	options.low_watermark = std::chrono::microseconds(1000);
+	options.interval = 50ms;
+	options.shrink_after_intervals = 2;
+	pool.setAdaptive(options);
+
+	// Blocking tasks on one thread: queue wait quickly passes the high watermark
+	std::atomic<int> done{0};
+	const int kTasks = 400;
+	for (int i = 0; i < kTasks; ++i) {
+		pool.post([&]() {
+			std::this_thread::sleep_for(2ms);
+			++done;
+		});
+	}
+	CHECK(waitFor([&]() { return pool.getStats().grow_events > 0; }, 5000ms));
+	CHECK(waitFor([&]() { return pool.getThreadCount() > 1; }, 5000ms));
+	size_t peak = pool.getThreadCount();
+	CHECK(peak <= 8);
+	CHECK(waitFor([&]() { return done.load() == kTasks; }, 10000ms));
+
+	// Idle: the pool shrinks back to the minimum, one thread per shrink_after_intervals
+	CHECK(waitFor([&]() { return pool.getThreadCount() == 1; }, 10000ms));
+	ThreadPoolStats stats = pool.getStats();
+	CHECK(stats.shrink_events > 0);
+	CHECK(stats.target_threads == 1);
+
+	// Disabling keeps the current size
+	options.enabled = false;
+	pool.setAdaptive(options);
+	CHECK(pool.getThreadCount() == 1);
+}
+
+int main() {
+	testResize();
+	testRetireHandoff();
+	testStatsSnapshot();
+	testAdaptive();
+
+	return test::testResult("thread pool");
+}
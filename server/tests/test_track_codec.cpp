@@ -0,0 +1,149 @@
+// track_codec 单元测试
+//
+// 覆盖单条/多条航迹的编解码往返（量化精度、静态属性、超过单帧上限时分帧），
+// 以及截断、魔数错误和版本错误的输入被拒绝。
+
+#include "track_codec.h"
+#include "test_check.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cesium_server;
+
+static bool near(double a, double b, double tolerance) {
+	return std::fabs(a - b) <= tolerance;
+}
+
+// Track with every dynamic field set
+static Track makeTrack(const std::string& id) {
+	Track track = test::makeTrack(id, 116.3912345, -39.9073456);
+	track.altitude = 52.5;
+	track.heading = 271.25;
+	track.timestamp = 1700000000123LL;
+	return track;
+}
+
+// Single track round trip, with and without static attributes
+static void testRoundTrip() {
+	std::cout << "round trip" << std::endl;
+
+	Track plain = makeTrack("entity-1");
+	std::vector<Track> decoded;
+	std::string encoded = track_codec::encode(plain);
+	CHECK(track_codec::decode(encoded.data(), encoded.size(), decoded));
+	CHECK(decoded.size() == 1);
+	if (decoded.size() == 1) {
+		const Track& out = decoded[0];
+		CHECK(out.id == "entity-1");
+		CHECK(near(out.longitude, plain.longitude, 1e-7));
+		CHECK(near(out.latitude, plain.latitude, 1e-7));
+		CHECK(near(out.altitude, plain.altitude, 1e-3));
+		CHECK(near(out.heading, plain.heading, 0.01));
+		CHECK(out.timestamp == plain.timestamp);
+		CHECK(out.ship_name.empty());
+		CHECK(out.attr == -1);
+	}
+
+	Track named = makeTrack("entity-2");
+	named.ship_name = "Alpha";
+	named.ship_number = "A-001";
+	named.country = "CN";
+	named.ship_type = "cargo";
+	named.attr = 2;
+	// Headings are normalized into [0, 360)
+	named.heading = -90.0;
+
+	decoded.clear();
+	encoded = track_codec::encode(named);
+	CHECK(track_codec::decode(encoded.data(), encoded.size(), decoded));
+	CHECK(decoded.size() == 1);
+	if (decoded.size() == 1) {
+		const Track& out = decoded[0];
+		CHECK(out.ship_name == "Alpha");
+		CHECK(out.ship_number == "A-001");
+		CHECK(out.country == "CN");
+		CHECK(out.ship_type == "cargo");
+		CHECK(out.attr == 2);
+		CHECK(near(out.heading, 270.0, 0.01));
+	}
+}
+
+// Multiple tracks, including more than one frame can hold
+static void testBatchRoundTrip() {
+	std::cout << "batch round trip" << std::endl;
+
+	std::vector<Track> tracks;
+	for (size_t i = 0; i < track_codec::kMaxRecordsPerFrame + 10; ++i) {
+		Track track = makeTrack("e" + std::to_string(i));
+		track.longitude = static_cast<double>(i % 360) - 180.0;
+		if (i % 1000 == 0) {
+			track.ship_name = "ship-" + std::to_string(i);
+		}
+		tracks.push_back(track);
+	}
+
+	std::string encoded = track_codec::encode(tracks);
+	std::vector<Track> decoded;
+	CHECK(track_codec::decode(encoded.data(), encoded.size(), decoded));
+	CHECK(decoded.size() == tracks.size());
+	if (decoded.size() == tracks.size()) {
+		bool all_match = true;
+		for (size_t i = 0; i < tracks.size(); ++i) {
+			all_match = all_match && decoded[i].id == tracks[i].id &&
+				near(decoded[i].longitude, tracks[i].longitude, 1e-7) &&
+				decoded[i].ship_name == tracks[i].ship_name;
+		}
+		CHECK(all_match);
+	}
+
+	// Two concatenated messages decode as one
+	std::string two = track_codec::encode(makeTrack("a")) + track_codec::encode(makeTrack("b"));
+	decoded.clear();
+	CHECK(track_codec::decode(two.data(), two.size(), decoded));
+	CHECK(decoded.size() == 2);
+}
+
+// Every truncation of a valid message is rejected, as are bad headers
+static void testRejectsMalformed() {
+	std::cout << "malformed input" << std::endl;
+
+	Track named = makeTrack("entity-3");
+	named.ship_name = "Bravo";
+	named.attr = 1;
+	std::vector<Track> tracks = {makeTrack("entity-1"), named};
+	std::string encoded = track_codec::encode(tracks);
+
+	bool all_rejected = true;
+	for (size_t size = 1; size < encoded.size(); ++size) {
+		std::vector<Track> decoded;
+		if (track_codec::decode(encoded.data(), size, decoded)) {
+			std::cout << "  truncated to " << size << " bytes was accepted" << std::endl;
+			all_rejected = false;
+		}
+	}
+	CHECK(all_rejected);
+
+	std::vector<Track> decoded;
+	std::string bad_magic = encoded;
+	bad_magic[0] = 'X';
+	CHECK(!track_codec::decode(bad_magic.data(), bad_magic.size(), decoded));
+
+	std::string bad_version = encoded;
+	bad_version[2] = static_cast<char>(track_codec::kVersion + 1);
+	CHECK(!track_codec::decode(bad_version.data(), bad_version.size(), decoded));
+
+	// Trailing bytes after the last frame are not a valid frame
+	std::string trailing = encoded + "C";
+	CHECK(!track_codec::decode(trailing.data(), trailing.size(), decoded));
+}
+
+int main() {
+	testRoundTrip();
+	testBatchRoundTrip();
+	testRejectsMalformed();
+
+	return test::testResult("track codec");
+}
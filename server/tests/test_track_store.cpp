@@ -0,0 +1,175 @@
+// TrackStore 单元测试
+//
+// 覆盖单条/批量写入（序号分配、同ID后者生效、静态属性保留、写入后行的返回）、
+// changedSince 增量查询以及 generation 版本号的变化规则。
+
+#include "track_store.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace cesium_server;
+using test::makeTrack;
+
+// Single upsert: insert/update result, sequence numbers and kept static attributes
+static void testUpsert() {
+	std::cout << "upsert" << std::endl;
+	TrackStore store(4);
+
+	Track track = makeTrack("ship-1", 120.0, 30.0);
+	track.ship_name = "Alpha";
+	track.ship_type = "cargo";
+	track.attr = 1;
+
+	uint64_t seq1 = 0;
+	CHECK(store.upsert(track, &seq1));
+	CHECK(seq1 == 1);
+	CHECK(store.size() == 1);
+
+	// A position-only update keeps the stored static attributes
+	Track moved = makeTrack("ship-1", 121.0, 31.0);
+	uint64_t seq2 = 0;
+	Track stored;
+	CHECK(!store.upsert(moved, &seq2, &stored));
+	CHECK(seq2 == 2);
+	CHECK(store.size() == 1);
+	CHECK(stored.longitude == 121.0);
+	CHECK(stored.latitude == 31.0);
+	CHECK(stored.ship_name == "Alpha");
+	CHECK(stored.ship_type == "cargo");
+	CHECK(stored.attr == 1);
+	CHECK(stored.seq == seq2);
+
+	Track out;
+	CHECK(store.get("ship-1", out));
+	CHECK(out.longitude == 121.0);
+	CHECK(out.ship_name == "Alpha");
+	CHECK(!store.get("ship-2", out));
+}
+
+// Batch upsert: inserted count, one sequence per entry, last duplicate wins
+static void testUpsertBatch() {
+	std::cout << "upsertBatch" << std::endl;
+	TrackStore store(4);
+
+	Track named = makeTrack("ship-0", 100.0, 10.0);
+	named.country = "CN";
+	store.upsert(named);
+
+	std::vector<Track> batch;
+	for (int i = 0; i < 20; ++i) {
+		batch.push_back(makeTrack("ship-" + std::to_string(i), 110.0 + i, 20.0));
+	}
+	batch.push_back(makeTrack("ship-3", 150.0, 50.0));
+
+	std::vector<uint64_t> seqs;
+	std::vector<Track> stored;
+	size_t inserted = store.upsertBatch(batch, &seqs, &stored);
+	CHECK(inserted == 19);
+	CHECK(store.size() == 20);
+	CHECK(seqs.size() == batch.size());
+	CHECK(stored.size() == batch.size());
+
+	// Sequence numbers are unique, newer than the single upsert and end at sequence()
+	std::set<uint64_t> unique(seqs.begin(), seqs.end());
+	CHECK(unique.size() == seqs.size());
+	CHECK(*unique.begin() == 2);
+	CHECK(*unique.rbegin() == store.sequence());
+
+	// The later duplicate gets the later sequence number and wins
+	CHECK(seqs[20] > seqs[3]);
+	Track out;
+	CHECK(store.get("ship-3", out));
+	CHECK(out.longitude == 150.0);
+	CHECK(out.seq == seqs[20]);
+
+	// Each returned row is the row right after that entry was written
+	CHECK(stored[3].longitude == 113.0);
+	CHECK(stored[20].longitude == 150.0);
+	CHECK(stored[0].country == "CN");
+
+	// Empty batch is a no-op
+	uint64_t before = store.sequence();
+	CHECK(store.upsertBatch({}, &seqs) == 0);
+	CHECK(store.sequence() == before);
+}
+
+// changedSince returns the current state of tracks updated after a sequence number
+static void testChangedSince() {
+	std::cout << "changedSince" << std::endl;
+	TrackStore store(4);
+
+	for (int i = 0; i < 10; ++i) {
+		store.upsert(makeTrack("ship-" + std::to_string(i), 110.0, 20.0));
+	}
+	uint64_t mark = store.sequence();
+	CHECK(store.changedSince(mark).empty());
+	CHECK(store.changedSince(0).size() == 10);
+
+	store.upsert(makeTrack("ship-2", 111.0, 21.0));
+	store.upsert(makeTrack("ship-7", 112.0, 22.0));
+	store.upsert(makeTrack("ship-2", 113.0, 23.0));
+	store.upsert(makeTrack("ship-new", 114.0, 24.0));
+
+	std::vector<Track> changed = store.changedSince(mark);
+	CHECK(changed.size() == 3);
+	std::sort(changed.begin(), changed.end(), [](const Track& a, const Track& b) { return a.id < b.id; });
+	CHECK(changed[0].id == "ship-2");
+	CHECK(changed[0].longitude == 113.0);
+	CHECK(changed[1].id == "ship-7");
+	CHECK(changed[2].id == "ship-new");
+	for (const Track& track : changed) {
+		CHECK(track.seq > mark);
+	}
+
+	// Removed tracks are no longer reported
+	CHECK(store.remove("ship-7"));
+	CHECK(store.changedSince(mark).size() == 2);
+}
+
+// generation changes on every insert, update and removal, and only then
+static void testGeneration() {
+	std::cout << "generation" << std::endl;
+	TrackStore store(4);
+
+	uint64_t g0 = store.generation();
+	store.upsert(makeTrack("ship-1", 110.0, 20.0));
+	uint64_t g1 = store.generation();
+	CHECK(g1 > g0);
+
+	store.upsert(makeTrack("ship-1", 111.0, 20.0));
+	uint64_t g2 = store.generation();
+	CHECK(g2 > g1);
+
+	store.upsertBatch({makeTrack("ship-2", 110.0, 20.0), makeTrack("ship-3", 110.0, 20.0)});
+	uint64_t g3 = store.generation();
+	CHECK(g3 > g2);
+
+	// Reads do not change the generation
+	Track out;
+	store.get("ship-1", out);
+	store.snapshot();
+	store.changedSince(0);
+	CHECK(store.generation() == g3);
+
+	// Removing a missing track changes nothing
+	CHECK(!store.remove("missing"));
+	CHECK(store.generation() == g3);
+
+	CHECK(store.remove("ship-2"));
+	CHECK(store.generation() > g3);
+	CHECK(store.size() == 2);
+}
+
+int main() {
+	testUpsert();
+	testUpsertBatch();
+	testChangedSince();
+	testGeneration();
+
+	return test::testResult("track store");
+}
@@ -0,0 +1,261 @@
+// UdpFeedDecoder 单元测试
+//
+// 覆盖按序交付、乱序缓冲后按序交付、缺口等待超时（expire）、重复帧、迟到帧、数据源重启、
+// 重排窗口边界（距离达到窗口即不再缓冲）、expire 只处理调用线程处理过的数据源，以及格式错误的帧。
+
+#include "udp_feed.h"
+#include "test_check.h"
+
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cesium_server;
+
+using Clock = std::chrono::steady_clock;
+
+// One-record frame whose track id is the sequence number
+static std::string frame(uint32_t source_id, uint32_t sequence) {
+	Track track;
+	track.id = std::to_string(sequence);
+	return udp_frame::encode(source_id, sequence, {track});
+}
+
+// Feed one frame and return the ids delivered by it, joined with ','
+static std::string feed(UdpFeedDecoder& decoder, uint32_t source_id, uint32_t sequence, Clock::time_point now) {
+	std::string data = frame(source_id, sequence);
+	std::vector<Track> out;
+	decoder.process(data.data(), data.size(), out, now);
+	std::string ids;
+	for (const auto& track : out) {
+		ids += (ids.empty() ? "" : ",") + track.id;
+	}
+	return ids;
+}
+
+static std::string expire(UdpFeedDecoder& decoder, Clock::time_point now) {
+	std::vector<Track> out;
+	decoder.expire(out, now);
+	std::string ids;
+	for (const auto& track : out) {
+		ids += (ids.empty() ? "" : ",") + track.id;
+	}
+	return ids;
+}
+
+static UdpFeedOptions options(uint32_t window, int timeout_ms = 50) {
+	UdpFeedOptions result;
+	result.reorder_window = window;
+	result.reorder_timeout = std::chrono::milliseconds(timeout_ms);
+	return result;
+}
+
+// In-order frames are delivered immediately, per source
+static void testInOrder() {
+	std::cout << "in order" << std::endl;
+	UdpFeedDecoder decoder(options(32));
+	Clock::time_point t = Clock::now();
+
+	CHECK(feed(decoder, 1, 100, t) == "100");
+	CHECK(feed(decoder, 1, 101, t) == "101");
+	CHECK(feed(decoder, 2, 7, t) == "7");
+	CHECK(feed(decoder, 1, 102, t) == "102");
+
+	UdpFeedStats stats = decoder.getStats();
+	CHECK(stats.frames == 4);
+	CHECK(stats.records == 4);
+	CHECK(stats.sources == 2);
+	CHECK(stats.lost == 0);
+	CHECK(stats.pending == 0);
+}
+
+// Frames ahead of a gap are held and released in order once the gap fills
+static void testReorder() {
+	std::cout << "reorder" << std::endl;
+	UdpFeedDecoder decoder(options(32));
+	Clock::time_point t = Clock::now();
+
+	CHECK(feed(decoder, 1, 0, t) == "0");
+	CHECK(feed(decoder, 1, 3, t).empty());
+	CHECK(feed(decoder, 1, 2, t).empty());
+	CHECK(decoder.getStats().pending == 2);
+	CHECK(feed(decoder, 1, 1, t) == "1,2,3");
+
+	UdpFeedStats stats = decoder.getStats();
+	CHECK(stats.reordered == 2);
+	CHECK(stats.lost == 0);
+	CHECK(stats.pending == 0);
+}
+
+// A gap that never fills is skipped by expire() after the timeout, even with no new data
+static void testGapTimeout() {
+	std::cout << "gap timeout" << std::endl;
+	UdpFeedDecoder decoder(options(32, 50));
+	Clock::time_point t = Clock::now();
+
+	CHECK(feed(decoder, 1, 10, t) == "10");
+	CHECK(feed(decoder, 1, 12, t).empty());
+	CHECK(feed(decoder, 1, 13, t + std::chrono::milliseconds(10)).empty());
+	CHECK(feed(decoder, 1, 16, t + std::chrono::milliseconds(20)).empty());
+
+	// Not yet timed out
+	CHECK(expire(decoder, t + std::chrono::milliseconds(49)).empty());
+
+	// First gap times out: 11 lost, 12 and 13 delivered, the wait restarts for the next gap
+	CHECK(expire(decoder, t + std::chrono::milliseconds(50)) == "12,13");
+	UdpFeedStats stats = decoder.getStats();
+	CHECK(stats.lost == 1);
+	CHECK(stats.pending == 1);
+
+	CHECK(expire(decoder, t + std::chrono::milliseconds(99)).empty());
+	CHECK(expire(decoder, t + std::chrono::milliseconds(100)) == "16");
+	stats = decoder.getStats();
+	CHECK(stats.lost == 3);
+	CHECK(stats.pending == 0);
+
+	// A frame for a skipped sequence is late
+	CHECK(feed(decoder, 1, 11, t + std::chrono::milliseconds(101)).empty());
+	CHECK(decoder.getStats().late == 1);
+}
+
+// Already delivered and already buffered frames are duplicates
+static void testDuplicates() {
+	std::cout << "duplicates" << std::endl;
+	UdpFeedDecoder decoder(options(32));
+	Clock::time_point t = Clock::now();
+
+	CHECK(feed(decoder, 1, 0, t) == "0");
+	CHECK(feed(decoder, 1, 1, t) == "1");
+	CHECK(feed(decoder, 1, 1, t).empty());
+	CHECK(feed(decoder, 1, 0, t).empty());
+	CHECK(feed(decoder, 1, 5, t).empty());
+	CHECK(feed(decoder, 1, 5, t).empty());
+
+	UdpFeedStats stats = decoder.getStats();
+	CHECK(stats.duplicates == 3);
+	CHECK(stats.late == 0);
+	CHECK(stats.pending == 1);
+}
+
+// A large step back is a restart; a frame older than the history bitmap is late
+static void testLateAndRestart() {
+	std::cout << "late and restart" << std::endl;
+	UdpFeedDecoder decoder(options(0));
+	Clock::time_point t = Clock::now();
+
+	CHECK(feed(decoder, 1, 100000, t) == "100000");
+	// No reordering: a jump ahead delivers at once and counts the gap as lost
+	CHECK(feed(decoder, 1, 100100, t) == "100100");
+	CHECK(decoder.getStats().lost == 99);
+
+	CHECK(feed(decoder, 1, 100050, t).empty());
+	CHECK(decoder.getStats().late == 1);
+
+	CHECK(feed(decoder, 1, 3, t) == "3");
+	CHECK(feed(decoder, 1, 4, t) == "4");
+	UdpFeedStats stats = decoder.getStats();
+	CHECK(stats.restarts == 1);
+	CHECK(stats.lost == 99);
+
+	// Sequence numbers wrap around without a restart
+	CHECK(feed(decoder, 2, 0xFFFFFFFFu, t) == "4294967295");
+	CHECK(feed(decoder, 2, 0, t) == "0");
+	CHECK(decoder.getStats().restarts == 1);
+}
+
+// Frames at distance >= reorder_window are not buffered, even when the slot count is larger
+static void testWindowBoundary() {
+	std::cout << "window boundary" << std::endl;
+	Clock::time_point t = Clock::now();
+
+	UdpFeedDecoder decoder(options(5));
+	CHECK(feed(decoder, 1, 0, t) == "0");
+	// Distance 4 (expected is 1) is inside a window of 5
+	CHECK(feed(decoder, 1, 5, t).empty());
+	CHECK(decoder.getStats().pending == 1);
+	// Distance 5 is outside: buffered frames are flushed and the gap counted as lost
+	CHECK(feed(decoder, 1, 6, t) == "5,6");
+	UdpFeedStats stats = decoder.getStats();
+	CHECK(stats.lost == 4);
+	CHECK(stats.pending == 0);
+
+	UdpFeedDecoder exact(options(32));
+	CHECK(feed(exact, 1, 0, t) == "0");
+	CHECK(feed(exact, 1, 32, t).empty());
+	CHECK(exact.getStats().pending == 1);
+	CHECK(feed(exact, 1, 33, t) == "32,33");
+	CHECK(exact.getStats().lost == 31);
+}
+
+// expire() only flushes sources last processed on the calling thread
+static void testExpireOwnedSources() {
+	std::cout << "expire owned sources" << std::endl;
+	UdpFeedDecoder decoder(options(32, 50));
+	Clock::time_point t = Clock::now();
+
+	// Source 1 is fed on this thread, source 2 on another one; both hold a frame behind a gap.
+	// The other thread stays alive until the end so its id is not reused by a later thread.
+	CHECK(feed(decoder, 1, 0, t) == "0");
+	CHECK(feed(decoder, 1, 2, t).empty());
+	std::string other;
+	std::promise<void> fed;
+	std::promise<void> done;
+	std::thread worker([&]() {
+		other = feed(decoder, 2, 10, t);
+		other += "|" + feed(decoder, 2, 12, t);
+		fed.set_value();
+		done.get_future().wait();
+	});
+	fed.get_future().wait();
+	CHECK(other == "10|");
+	CHECK(decoder.getStats().pending == 2);
+
+	// Only this thread's source is flushed here
+	CHECK(expire(decoder, t + std::chrono::milliseconds(60)) == "2");
+	CHECK(decoder.getStats().pending == 1);
+
+	// A third thread owns no source and flushes nothing
+	std::thread expirer([&]() { other = expire(decoder, t + std::chrono::milliseconds(60)); });
+	expirer.join();
+	CHECK(other.empty());
+	CHECK(decoder.getStats().pending == 1);
+
+	// A source moves to the thread that processed it last
+	CHECK(feed(decoder, 2, 13, t + std::chrono::milliseconds(20)).empty());
+	CHECK(expire(decoder, t + std::chrono::milliseconds(60)) == "12,13");
+	CHECK(decoder.getStats().pending == 0);
+
+	done.set_value();
+	worker.join();
+}
+
+// Malformed frames are counted and deliver nothing
+static void testInvalid() {
+	std::cout << "invalid frames" << std::endl;
+	UdpFeedDecoder decoder(options(32));
+	std::string data = frame(1, 0);
+	std::vector<Track> out;
+
+	CHECK(!decoder.process(data.data(), data.size() - 1, out));
+	std::string trailing = data + "x";
+	CHECK(!decoder.process(trailing.data(), trailing.size(), out));
+	CHECK(out.empty());
+	CHECK(decoder.getStats().invalid == 2);
+	CHECK(decoder.getStats().frames == 0);
+}
+
+int main() {
+	testInOrder();
+	testReorder();
+	testGapTimeout();
+	testDuplicates();
+	testLateAndRestart();
+	testWindowBoundary();
+	testExpireOwnedSources();
+	testInvalid();
+
+	return test::testResult("UDP feed");
+}
@@ -0,0 +1,158 @@
+// UDP 航迹帧发送测试
+//
+// UdpMulticastServer::sendTracks 发送到回环组播组，普通 UDP 套接字加入同一组接收，检查：
+//   - 每个数据报不超过 max_datagram_size，且恰好是一个完整的帧
+//   - 记录按调用顺序分布在各帧中，帧序号逐帧递增
+//   - 超过上限的单条记录单独成帧
+
+#include "udp_multicast_server.h"
+#include "udp_feed.h"
+#include "test_check.h"
+
+#include <boost/asio.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cesium_server;
+namespace net = boost::asio;
+using udp = boost::asio::ip::udp;
+
+static const char* kGroup = "239.255.43.21";
+static const unsigned short kPort = 19310;
+static const size_t kMaxDatagram = 200;
+
+// Plain multicast receiver
+class TestReceiver {
+public:
+	TestReceiver() : socket_(ioc_) {
+		socket_.open(udp::v4());
+		socket_.set_option(net::socket_base::reuse_address(true));
+		socket_.bind(udp::endpoint(net::ip::address_v4::any(), kPort));
+		socket_.set_option(net::ip::multicast::join_group(net::ip::make_address(kGroup)));
+	}
+
+	// Receive datagrams until count records arrived or the timeout passed
+	std::vector<std::string> receive(size_t records, std::chrono::milliseconds timeout) {
+		std::vector<std::string> datagrams;
+		size_t received = 0;
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		std::vector<char> buffer(65536);
+		while (received < records && std::chrono::steady_clock::now() < deadline) {
+			if (socket_.available() == 0) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+			udp::endpoint sender;
+			size_t size = socket_.receive_from(net::buffer(buffer), sender);
+			datagrams.emplace_back(buffer.data(), size);
+			udp_frame::FrameHeader header;
+			std::vector<Track> tracks;
+			if (udp_frame::decode(buffer.data(), size, header, tracks)) {
+				received += tracks.size();
+			}
+		}
+		return datagrams;
+	}
+
+private:
+	net::io_context ioc_;
+	udp::socket socket_;
+};
+
+static Track makeTrack(size_t index) {
+	return test::makeTrack("track-" + std::to_string(index), 120.0 + index * 0.001, 30.0);
+}
+
+// Records are split across frames at max_datagram_size, in call order
+static void testFrameSplit(UdpMulticastServer& server, TestReceiver& receiver) {
+	std::cout << "frame split" << std::endl;
+
+	std::vector<Track> tracks;
+	for (size_t i = 0; i < 50; ++i) {
+		tracks.push_back(makeTrack(i));
+	}
+	// Two calls feed the same pending frame
+	server.sendTracks(std::vector<Track>(tracks.begin(), tracks.begin() + 20));
+	server.sendTracks(std::vector<Track>(tracks.begin() + 20, tracks.end()));
+
+	std::vector<std::string> datagrams = receiver.receive(tracks.size(), std::chrono::seconds(3));
+	CHECK(datagrams.size() > 1);
+
+	std::vector<Track> decoded;
+	bool all_fit = true;
+	bool all_frames = true;
+	bool sequential = true;
+	uint32_t last_sequence = 0;
+	for (size_t i = 0; i < datagrams.size(); ++i) {
+		const std::string& datagram = datagrams[i];
+		all_fit = all_fit && datagram.size() <= kMaxDatagram;
+		udp_frame::FrameHeader header;
+		size_t before = decoded.size();
+		all_frames = all_frames && udp_frame::decode(datagram.data(), datagram.size(), header, decoded);
+		all_frames = all_frames && header.record_count == decoded.size() - before && header.source_id == 7;
+		if (i > 0) {
+			sequential = sequential && header.sequence == last_sequence + 1;
+		}
+		last_sequence = header.sequence;
+	}
+	CHECK(all_fit);
+	CHECK(all_frames);
+	CHECK(sequential);
+
+	CHECK(decoded.size() == tracks.size());
+	bool in_order = decoded.size() == tracks.size();
+	for (size_t i = 0; in_order && i < decoded.size(); ++i) {
+		in_order = decoded[i].id == tracks[i].id;
+	}
+	CHECK(in_order);
+}
+
+// A record larger than max_datagram_size is sent in a frame of its own
+static void testOversizedRecord(UdpMulticastServer& server, TestReceiver& receiver) {
+	std::cout << "oversized record" << std::endl;
+
+	Track large = makeTrack(1000);
+	large.ship_name = std::string(250, 'n');
+	server.sendTracks({makeTrack(999), large, makeTrack(1001)});
+
+	std::vector<std::string> datagrams = receiver.receive(3, std::chrono::seconds(3));
+	CHECK(datagrams.size() == 3);
+	if (datagrams.size() == 3) {
+		CHECK(datagrams[0].size() <= kMaxDatagram);
+		CHECK(datagrams[1].size() > kMaxDatagram);
+		CHECK(datagrams[2].size() <= kMaxDatagram);
+
+		udp_frame::FrameHeader header;
+		std::vector<Track> decoded;
+		CHECK(udp_frame::decode(datagrams[1].data(), datagrams[1].size(), header, decoded));
+		CHECK(header.record_count == 1);
+		CHECK(decoded.size() == 1 && decoded[0].ship_name == large.ship_name);
+	}
+}
+
+int main() {
+	try {
+		TestReceiver receiver;
+
+		UdpMulticastServer server(kGroup, kPort, "0.0.0.0", 2048);
+		UdpSendOptions send_options;
+		send_options.max_datagram_size = kMaxDatagram;
+		send_options.source_id = 7;
+		server.setSendOptions(send_options);
+		server.run();
+
+		testFrameSplit(server, receiver);
+		testOversizedRecord(server, receiver);
+
+		server.stop();
+	} catch (const std::exception& e) {
+		std::cout << "Error occurred during testing: " << e.what() << std::endl;
+		return 1;
+	}
+
+	return test::testResult("UDP send");
+}
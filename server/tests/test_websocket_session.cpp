@@ -0,0 +1,218 @@
+// WebSocket 会话写路径测试
+//
+// 在回环地址上启动 WebSocketServer，用 Beast 同步客户端接收消息，检查：
+//   - 批量广播（JSON 数组）排在单条更新后面合并发送时，合并帧仍是一层数组
+//   - 快照块逐块发送，同步期间暂存的增量更新按 SyncFilter 去重后与暂存的批量消息合并为一层数组
+//   - 同步会话计数随 startSync、快照发送完毕和同步中关闭增减
+
+#include "websocket_server.h"
+#include "test_check.h"
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cesium_server;
+
+static SharedMessage makeMessage(const std::string& text) {
+	return std::make_shared<const std::string>(text);
+}
+
+// Synchronous test client
+class TestClient {
+public:
+	explicit TestClient(unsigned short port) : ws_(ioc_) {
+		tcp::endpoint endpoint(net::ip::make_address("127.0.0.1"), port);
+		beast::get_lowest_layer(ws_).connect(endpoint);
+		ws_.handshake("127.0.0.1:" + std::to_string(port), "/");
+	}
+
+	~TestClient() {
+		beast::error_code ec;
+		ws_.close(websocket::close_code::normal, ec);
+	}
+
+	// Read one frame
+	std::string read() {
+		beast::flat_buffer buffer;
+		ws_.read(buffer);
+		return beast::buffers_to_string(buffer.data());
+	}
+
+private:
+	net::io_context ioc_;
+	websocket::stream<tcp::socket> ws_;
+};
+
+// Server with write batching and a flush delay long enough to coalesce everything sent within it
+class TestServer {
+public:
+	TestServer(unsigned short port, bool sync_on_connect) : server_("127.0.0.1", port, 1) {
+		WriteBatchOptions batch;
+		batch.enabled = true;
+		batch.max_delay = std::chrono::milliseconds(300);
+		server_.setWriteBatchOptions(batch);
+		server_.setSyncOnConnect(sync_on_connect);
+		server_.setConnectionHandler(
+			[this](const std::shared_ptr<WebSocketSession>& session, bool connected) {
+				if (connected) {
+					connected_.set_value(session);
+				}
+			});
+		server_.run();
+	}
+
+	~TestServer() {
+		server_.stop();
+	}
+
+	// Wait for the first client to connect
+	std::shared_ptr<WebSocketSession> waitForSession() {
+		auto future = connected_.get_future();
+		if (future.wait_for(std::chrono::seconds(5)) != std::future_status::ready) {
+			return nullptr;
+		}
+		return future.get();
+	}
+
+	WebSocketServer& server() { return server_; }
+
+private:
+	WebSocketServer server_;
+	std::promise<std::shared_ptr<WebSocketSession>> connected_;
+};
+
+// A batch broadcast queued behind a single update is spliced into one flat array
+static void testCoalescedBatchIsFlat() {
+	std::cout << "coalesced batch frame" << std::endl;
+	TestServer server(19301, false);
+	TestClient client(19301);
+	std::shared_ptr<WebSocketSession> session = server.waitForSession();
+	CHECK(session != nullptr);
+	if (!session) {
+		return;
+	}
+
+	server.server().broadcast(makeMessage("{\"id\":\"a\"}"), "a");
+	server.server().broadcastBatch(makeMessage("[{\"id\":\"b\"},{\"id\":\"c\"}]"), nullptr, {});
+	server.server().broadcastBatch(makeMessage("[]"), nullptr, {});
+	server.server().broadcast(makeMessage("{\"id\":\"d\"}"), "d");
+
+	const std::string expected = "[{\"id\":\"a\"},{\"id\":\"b\"},{\"id\":\"c\"},{\"id\":\"d\"}]";
+	std::string frame = client.read();
+	if (frame != expected) {
+		std::cout << "  frame: " << frame << std::endl;
+	}
+	CHECK(frame == expected);
+
+	// A batch sent on its own is passed through unchanged
+	server.server().broadcastBatch(makeMessage("[{\"id\":\"e\"},{\"id\":\"f\"}]"), nullptr, {});
+	CHECK(client.read() == "[{\"id\":\"e\"},{\"id\":\"f\"}]");
+}
+
+// Snapshot chunks go out one by one; held updates are deduplicated and released as one flat frame
+static void testSyncDedupeAndFlatRelease() {
+	std::cout << "snapshot sync" << std::endl;
+	TestServer server(19302, true);
+	TestClient client(19302);
+	std::shared_ptr<WebSocketSession> session = server.waitForSession();
+	CHECK(session != nullptr);
+	if (!session) {
+		return;
+	}
+	CHECK(session->isSyncing());
+	CHECK(server.server().getSyncingSessionCount() == 1);
+
+	// Updates arriving while the snapshot is being built are held in the session
+	session->send(makeMessage("{\"id\":\"a\",\"seq\":5}"), "a", false, 5);		// <= watermark: in the snapshot
+	session->send(makeMessage("{\"id\":\"b\",\"seq\":12}"), "b", false, 12);	// snapshot delivered b at 15
+	session->send(makeMessage("{\"id\":\"c\",\"seq\":13}"), "c", false, 13);	// newer than c in the snapshot
+	session->send(makeMessage("{\"id\":\"d\",\"seq\":21}"), "d", false, 21);
+	session->send(makeMessage("{\"id\":\"d\",\"seq\":20}"), "d", false, 20);	// older than the held d
+	session->send(makeMessage("[{\"id\":\"x\"}]"), "", false, 9);					// batch <= watermark
+	session->send(makeMessage("[{\"id\":\"e\"},{\"id\":\"f\"}]"), "", false, 22);
+
+	SyncFilter filter;
+	filter.watermark = 10;
+	filter.delivered["b"] = 15;
+	filter.delivered["c"] = 11;
+	std::vector<SyncChunk> chunks;
+	chunks.push_back({makeMessage("[{\"id\":\"s1\"},{\"id\":\"s2\"}]"), false});
+	chunks.push_back({makeMessage("[{\"id\":\"s3\"}]"), false});
+	session->startSync(std::move(chunks), std::move(filter));
+
+	CHECK(client.read() == "[{\"id\":\"s1\"},{\"id\":\"s2\"}]");
+	CHECK(client.read() == "[{\"id\":\"s3\"}]");
+
+	// Held updates in sequence order, the batch spliced in rather than nested
+	const std::string expected =
+		"[{\"id\":\"c\",\"seq\":13},{\"id\":\"d\",\"seq\":21},{\"id\":\"e\"},{\"id\":\"f\"}]";
+	std::string frame = client.read();
+	if (frame != expected) {
+		std::cout << "  frame: " << frame << std::endl;
+	}
+	CHECK(frame == expected);
+	CHECK(!session->isSyncing());
+	CHECK(server.server().getSyncingSessionCount() == 0);
+
+	// After the switch the filter still drops updates the snapshot already covered
+	session->send(makeMessage("{\"id\":\"b\",\"seq\":14}"), "b", false, 14);
+	session->send(makeMessage("{\"id\":\"b\",\"seq\":16}"), "b", false, 16);
+	CHECK(client.read() == "{\"id\":\"b\",\"seq\":16}");
+}
+
+// The syncing session count follows startSync, and a session closed mid-sync leaves it
+static void testSyncingCountOnClose() {
+	std::cout << "syncing count on close" << std::endl;
+	TestServer server(19303, false);
+	std::shared_ptr<WebSocketSession> session;
+	{
+		TestClient client(19303);
+		session = server.waitForSession();
+		CHECK(session != nullptr);
+		if (!session) {
+			return;
+		}
+		CHECK(server.server().getSyncingSessionCount() == 0);
+
+		// A long chunk interval keeps the session syncing until the client goes away
+		std::vector<SyncChunk> chunks;
+		chunks.push_back({makeMessage("[{\"id\":\"s1\"}]"), false});
+		chunks.push_back({makeMessage("[{\"id\":\"s2\"}]"), false});
+		session->startSync(std::move(chunks), SyncFilter(), std::chrono::milliseconds(60000));
+		CHECK(session->isSyncing());
+		CHECK(server.server().getSyncingSessionCount() == 1);
+		CHECK(client.read() == "[{\"id\":\"s1\"}]");
+	}
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (server.server().getSyncingSessionCount() != 0 && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	CHECK(server.server().getSyncingSessionCount() == 0);
+	CHECK(!session->isSyncing());
+
+	// A closed session cannot start syncing again
+	session->startSync({}, SyncFilter());
+	CHECK(server.server().getSyncingSessionCount() == 0);
+}
+
+int main() {
+	try {
+		testCoalescedBatchIsFlat();
+		testSyncDedupeAndFlatRelease();
+		testSyncingCountOnClose();
+	} catch (const std::exception& e) {
+		std::cout << "Error occurred during testing: " << e.what() << std::endl;
+		return 1;
+	}
+
+	return test::testResult("WebSocket session");
+}